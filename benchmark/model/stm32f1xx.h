@@ -0,0 +1,215 @@
+/**
+ * @file stm32f1xx.h
+ * @brief Host model of the F1 CMSIS registers the STM32 ports touch
+ *
+ * Stands in for the CMSIS device header in benchmark/nrf24l01_port_cycles.cpp
+ * (C++ only). Every register is an object: a load or store costs
+ * model::peripheral_access core cycles and is counted, and the SPI side
+ * follows the F1 reference manual, with one transmit buffer in front of
+ * the shift register, one receive buffer behind it and a byte taking
+ * 8 * model::spi_prescaler core cycles on the wire:
+ *
+ * - DR write: starts shifting at once when the shift register is idle,
+ *   otherwise fills the transmit buffer (TXE low) until the byte before
+ *   ends
+ * - end of a byte: the byte received goes to the receive buffer (RXNE),
+ *   OVR if the one before was not read yet
+ * - BSY: shifting or a byte waiting in the transmit buffer
+ * - DR read then SR read: clears OVR
+ *
+ * The slave shifts out model::miso_first, then counts up, so the bytes
+ * read back show a lost or doubled byte. The core is not modelled: the
+ * code between the accesses costs what the caller charges with
+ * model::cpu(), see the constants below.
+ */
+
+#ifndef NRF24L01_BENCHMARK_MODEL_STM32F1XX_H
+#define NRF24L01_BENCHMARK_MODEL_STM32F1XX_H
+
+#include <stdint.h>
+
+namespace model {
+
+/** @brief Core clock, Hz */
+constexpr uint32_t core_clock = 72000000;
+/** @brief SPI clock divider: 8 gives 9 MHz at 72 MHz, under the 10 MHz of the nRF24L01 */
+constexpr uint32_t spi_prescaler = 8;
+/** @brief Core cycles per byte on the wire */
+constexpr uint32_t byte_cycles = 8 * spi_prescaler;
+/** @brief A load or store over the APB bridge plus the test or branch on it (estimate) */
+constexpr uint32_t peripheral_access = 3;
+/** @brief Buffer load or store and index update around each DR access (estimate) */
+constexpr uint32_t data_access = 2;
+/** @brief Call, push and pop of a small out-of-line function (estimate) */
+constexpr uint32_t call = 6;
+/** @brief First byte the slave shifts out */
+constexpr uint8_t miso_first = 0xa0;
+
+/**
+ * @brief What one run cost
+ */
+struct counters {
+    uint64_t cycles;                       /**< Core cycles */
+    uint32_t accesses;                     /**< Peripheral register accesses */
+    uint64_t spi_idle;                     /**< Cycles the wire stood still between two bytes */
+    uint32_t overruns;                     /**< Bytes received over an unread one */
+    uint32_t lost;                         /**< DR writes with TXE low */
+};
+
+inline counters count;
+
+inline void cpu(uint32_t cycles){ count.cycles += cycles; }
+
+/**
+ * @brief A peripheral register; hooks give the SPI registers their behaviour
+ */
+class reg {
+public:
+    typedef uint32_t (*read_hook)(reg &);
+    typedef void (*write_hook)(reg &, uint32_t);
+
+    uint32_t value = 0;                    /**< Stored value, for registers without hooks */
+    read_hook on_read = nullptr;           /**< Called instead of returning value */
+    write_hook on_write = nullptr;         /**< Called instead of storing value */
+
+    operator uint32_t(){
+      access();
+      return on_read ? on_read(*this) : value;
+    }
+    reg & operator=(uint32_t v){
+      access();
+      if (on_write) on_write(*this, v);
+      else value = v;
+      return *this;
+    }
+    reg & operator|=(uint32_t v){ return *this = (uint32_t)*this | v; }
+    reg & operator&=(uint32_t v){ return *this = (uint32_t)*this & v; }
+
+private:
+    void access(){
+      count.cycles += peripheral_access;
+      count.accesses++;
+    }
+};
+
+} // namespace model
+
+typedef struct { model::reg CR1, CR2, SR, DR; } SPI_TypeDef;
+typedef struct { model::reg CRL, CRH, IDR, ODR, BSRR, BRR; } GPIO_TypeDef;
+typedef struct { model::reg CR1, CNT; } TIM_TypeDef;
+
+#define SPI_CR1_SPE    0x40u
+#define SPI_SR_RXNE    0x01u
+#define SPI_SR_TXE     0x02u
+#define SPI_SR_OVR     0x40u
+#define SPI_SR_BSY     0x80u
+#define TIM_CR1_CEN    0x01u
+
+/** @brief The model registers take 8-bit and 32-bit accesses alike */
+#define NRF24L01_STM32_REG_DR8(spi)   ((spi)->DR)
+
+namespace model {
+
+/**
+ * @brief Shift register and buffers of the one SPI in the model
+ */
+struct spi_state {
+    bool shifting;                         /**< A byte is on the wire */
+    bool tx_full;                          /**< A byte waits in the transmit buffer */
+    bool rx_full;                          /**< RXNE */
+    bool overrun;                          /**< OVR */
+    bool clear_overrun;                    /**< DR was read, an SR read clears OVR */
+    bool started;                          /**< A byte went out since reset() */
+    uint64_t shift_end;                    /**< Cycle the byte on the wire ends */
+    uint64_t last_end;                     /**< Cycle the previous byte ended */
+    uint8_t rx_buffer;                     /**< Receive buffer */
+    uint8_t miso;                          /**< Next byte from the slave */
+};
+
+inline spi_state spi;
+
+inline void spi_start(uint64_t at){
+  if (spi.started && at > spi.last_end) count.spi_idle += at - spi.last_end;
+  spi.started = true;
+  spi.shifting = true;
+  spi.shift_end = at + byte_cycles;
+}
+
+// bytes that ended by now
+inline void spi_advance(){
+  while (spi.shifting && spi.shift_end <= count.cycles){
+    if (spi.rx_full){
+      spi.overrun = true;
+      count.overruns++;
+    }
+    spi.rx_buffer = spi.miso++;
+    spi.rx_full = true;
+    spi.shifting = false;
+    spi.last_end = spi.shift_end;
+    if (spi.tx_full){
+      spi.tx_full = false;
+      spi_start(spi.last_end);
+    }
+  }
+}
+
+inline uint32_t spi_sr_read(reg &){
+  spi_advance();
+  uint32_t sr = (spi.tx_full ? 0 : SPI_SR_TXE) | (spi.rx_full ? SPI_SR_RXNE : 0) |
+                (spi.shifting || spi.tx_full ? SPI_SR_BSY : 0) | (spi.overrun ? SPI_SR_OVR : 0);
+  if (spi.clear_overrun) spi.overrun = false;
+  spi.clear_overrun = false;
+  return sr;
+}
+
+inline uint32_t spi_dr_read(reg &){
+  cpu(data_access);
+  spi_advance();
+  spi.rx_full = false;
+  spi.clear_overrun = true;
+  return spi.rx_buffer;
+}
+
+inline void spi_dr_write(reg &, uint32_t){
+  cpu(data_access);
+  spi_advance();
+  if (!spi.shifting) spi_start(count.cycles);
+  else if (!spi.tx_full) spi.tx_full = true;
+  else count.lost++;
+}
+
+inline GPIO_TypeDef * gpio;
+
+inline void bsrr_write(reg &, uint32_t v){
+  gpio->ODR.value = (gpio->ODR.value | (v & 0xffff)) & ~(v >> 16);
+}
+
+inline uint32_t tim_cnt_read(reg &){ return (uint32_t)(count.cycles / (core_clock / 1000000)); }
+
+inline uint32_t millis(){ return (uint32_t)(count.cycles / (core_clock / 1000)); }
+
+/**
+ * @brief Wire up the hooks of one SPI, GPIO port and timer
+ */
+inline void attach(SPI_TypeDef * s, GPIO_TypeDef * port, TIM_TypeDef * tim){
+  s->CR1.value = SPI_CR1_SPE; // master, enabled by the application
+  s->SR.on_read = spi_sr_read;
+  s->DR.on_read = spi_dr_read;
+  s->DR.on_write = spi_dr_write;
+  gpio = port;
+  gpio->BSRR.on_write = bsrr_write;
+  tim->CNT.on_read = tim_cnt_read;
+}
+
+/**
+ * @brief Start counting a new run with the wire idle
+ */
+inline void reset(){
+  count = counters();
+  spi = spi_state();
+  spi.miso = miso_first;
+}
+
+} // namespace model
+
+#endif //NRF24L01_BENCHMARK_MODEL_STM32F1XX_H
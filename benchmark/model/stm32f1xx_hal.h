@@ -0,0 +1,197 @@
+/**
+ * @file stm32f1xx_hal.h
+ * @brief Host model of the STM32CubeF1 HAL calls the HAL port makes on the SPI path
+ *
+ * HAL_SPI_TransmitReceive(), HAL_GPIO_WritePin() and HAL_GetTick() follow
+ * stm32f1xx_hal_spi.c, stm32f1xx_hal_gpio.c and stm32f1xx_hal.c of
+ * STM32CubeF1 1.8 statement by statement: the same register accesses in
+ * the same order, on the model registers of stm32f1xx.h, so their count
+ * and the SPI timing are those of the real code. The handle bookkeeping
+ * between them is charged with model::cpu() at about one cycle per Thumb-2
+ * instruction it compiles to with -O2; those charges are estimates, noted
+ * next to each statement. The other HAL calls of the port are declared
+ * only.
+ */
+
+#ifndef NRF24L01_BENCHMARK_MODEL_STM32F1XX_HAL_H
+#define NRF24L01_BENCHMARK_MODEL_STM32F1XX_HAL_H
+
+#include "stm32f1xx.h"
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+typedef enum { HAL_UNLOCKED = 0, HAL_LOCKED } HAL_LockTypeDef;
+typedef enum {
+    HAL_SPI_STATE_RESET = 0,
+    HAL_SPI_STATE_READY,
+    HAL_SPI_STATE_BUSY,
+    HAL_SPI_STATE_BUSY_TX,
+    HAL_SPI_STATE_BUSY_RX,
+    HAL_SPI_STATE_BUSY_TX_RX,
+} HAL_SPI_StateTypeDef;
+
+#define SPI_MODE_MASTER          0x104u
+#define SPI_DIRECTION_2LINES     0u
+#define SPI_DATASIZE_8BIT        0u
+#define SPI_DATASIZE_16BIT       0x800u
+#define HAL_MAX_DELAY            0xffffffffu
+
+typedef struct {
+    uint32_t Mode, Direction, DataSize;
+} SPI_InitTypeDef;
+
+typedef struct {
+    SPI_TypeDef * Instance;
+    SPI_InitTypeDef Init;
+    uint8_t * pTxBuffPtr;
+    uint16_t TxXferSize;
+    volatile uint16_t TxXferCount;
+    uint8_t * pRxBuffPtr;
+    uint16_t RxXferSize;
+    volatile uint16_t RxXferCount;
+    void (*RxISR)(void *);
+    void (*TxISR)(void *);
+    HAL_LockTypeDef Lock;
+    volatile HAL_SPI_StateTypeDef State;
+    volatile uint32_t ErrorCode;
+} SPI_HandleTypeDef;
+
+typedef struct {
+    TIM_TypeDef * Instance;
+} TIM_HandleTypeDef;
+
+#define __HAL_TIM_GET_COUNTER(h)   ((h)->Instance->CNT)
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef * GPIOx, uint16_t GPIO_Pin);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef * hspi, uint8_t * pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef * htim);
+void HAL_Delay(uint32_t Delay);
+
+inline uint32_t HAL_GetTick(void){
+  model::cpu(model::call + 2);                          // load uwTick
+  return model::millis();
+}
+
+inline void HAL_GPIO_WritePin(GPIO_TypeDef * GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState){
+  model::cpu(model::call + 2);                          // compare, shift
+  if (PinState != GPIO_PIN_RESET)
+    GPIOx->BSRR = GPIO_Pin;
+  else
+    GPIOx->BSRR = (uint32_t)GPIO_Pin << 16u;
+}
+
+// SPI_EndRxTxTransaction() and the SPI_WaitFlagStateUntilTimeout() it calls, BSY only on F1
+inline HAL_StatusTypeDef SPI_EndRxTxTransaction(SPI_HandleTypeDef * hspi, uint32_t Timeout, uint32_t Tickstart){
+  model::cpu(2 * model::call + 4);                      // both calls, arguments
+  uint32_t tmp_timeout = Timeout - (HAL_GetTick() - Tickstart);
+  uint32_t tmp_tickstart = HAL_GetTick();
+  uint32_t count = tmp_timeout * ((model::core_clock * 32u) >> 20u);
+  model::cpu(6);                                        // SystemCoreClock load, multiply, stack store
+  while ((hspi->Instance->SR & SPI_SR_BSY) != 0){
+    if (Timeout != HAL_MAX_DELAY){
+      model::cpu(2);
+      if (((HAL_GetTick() - tmp_tickstart) >= tmp_timeout) || (tmp_timeout == 0u)) return HAL_TIMEOUT;
+      model::cpu(5);                                    // count is volatile: load, test, decrement, store
+      if (count == 0u) tmp_timeout = 0u;
+      count--;
+    }
+  }
+  return HAL_OK;
+}
+
+inline HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef * hspi, uint8_t * pTxData, uint8_t * pRxData, uint16_t Size, uint32_t Timeout){
+  uint32_t txallowed = 1u;
+  HAL_StatusTypeDef errorcode = HAL_OK;
+  model::cpu(model::call + 6);                          // five arguments, eight registers saved
+
+  model::cpu(4);                                        // __HAL_LOCK
+  if (hspi->Lock == HAL_LOCKED) return HAL_BUSY;
+  hspi->Lock = HAL_LOCKED;
+
+  uint32_t tickstart = HAL_GetTick();
+  HAL_SPI_StateTypeDef tmp_state = hspi->State;
+  uint32_t tmp_mode = hspi->Init.Mode;
+  uint16_t initial_TxXferCount = Size;
+
+  model::cpu(8);                                        // state, mode and direction checks
+  if (!((tmp_state == HAL_SPI_STATE_READY) ||
+        ((tmp_mode == SPI_MODE_MASTER) && (hspi->Init.Direction == SPI_DIRECTION_2LINES) && (tmp_state == HAL_SPI_STATE_BUSY_RX)))){
+    errorcode = HAL_BUSY;
+    goto error;
+  }
+  model::cpu(4);                                        // argument checks
+  if ((pTxData == nullptr) || (pRxData == nullptr) || (Size == 0u)){
+    errorcode = HAL_ERROR;
+    goto error;
+  }
+
+  model::cpu(12);                                       // ten handle fields
+  if (hspi->State != HAL_SPI_STATE_BUSY_RX) hspi->State = HAL_SPI_STATE_BUSY_TX_RX;
+  hspi->ErrorCode = 0;
+  hspi->pRxBuffPtr = pRxData;
+  hspi->RxXferCount = Size;
+  hspi->RxXferSize = Size;
+  hspi->pTxBuffPtr = pTxData;
+  hspi->TxXferCount = Size;
+  hspi->TxXferSize = Size;
+  hspi->RxISR = nullptr;
+  hspi->TxISR = nullptr;
+
+  if ((hspi->Instance->CR1 & SPI_CR1_SPE) != SPI_CR1_SPE) hspi->Instance->CR1 |= SPI_CR1_SPE;
+
+  model::cpu(2);                                        // data size
+  if (hspi->Init.DataSize == SPI_DATASIZE_16BIT) return HAL_ERROR; // not modelled, the port is 8-bit
+
+  model::cpu(3);
+  if (initial_TxXferCount == 0x01u){
+    hspi->Instance->DR = *hspi->pTxBuffPtr;
+    model::cpu(6);                                      // pointer and count in the handle
+    hspi->pTxBuffPtr++;
+    hspi->TxXferCount--;
+  }
+  while ((hspi->TxXferCount > 0u) || (hspi->RxXferCount > 0u)){
+    model::cpu(4);                                      // both counts are volatile
+    if ((hspi->Instance->SR & SPI_SR_TXE) && (hspi->TxXferCount > 0u) && (txallowed == 1u)){
+      model::cpu(2);
+      hspi->Instance->DR = *hspi->pTxBuffPtr;
+      model::cpu(6);
+      hspi->pTxBuffPtr++;
+      hspi->TxXferCount--;
+      txallowed = 0u;
+    }
+    if ((hspi->Instance->SR & SPI_SR_RXNE) && (hspi->RxXferCount > 0u)){
+      model::cpu(2);
+      *hspi->pRxBuffPtr = (uint8_t)hspi->Instance->DR;
+      model::cpu(6);
+      hspi->pRxBuffPtr++;
+      hspi->RxXferCount--;
+      txallowed = 1u;
+    }
+    model::cpu(4);                                      // timeout checks
+    if ((((HAL_GetTick() - tickstart) >= Timeout) && (Timeout != HAL_MAX_DELAY)) || (Timeout == 0u)){
+      errorcode = HAL_TIMEOUT;
+      goto error;
+    }
+  }
+
+  if (SPI_EndRxTxTransaction(hspi, Timeout, tickstart) != HAL_OK){
+    errorcode = HAL_ERROR;
+    goto error;
+  }
+
+  model::cpu(2);
+  if (hspi->Init.Direction == SPI_DIRECTION_2LINES){
+    // __HAL_SPI_CLEAR_OVRFLAG
+    (void)(uint32_t)hspi->Instance->DR;
+    (void)(uint32_t)hspi->Instance->SR;
+  }
+
+error:
+  model::cpu(4 + 6);                                    // state, __HAL_UNLOCK, registers restored
+  hspi->State = HAL_SPI_STATE_READY;
+  hspi->Lock = HAL_UNLOCKED;
+  return errorcode;
+}
+
+#endif //NRF24L01_BENCHMARK_MODEL_STM32F1XX_HAL_H
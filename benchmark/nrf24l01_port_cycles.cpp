@@ -0,0 +1,161 @@
+/**
+ * @file nrf24l01_port_cycles.cpp
+ * @brief Core cycles of the register port against the HAL port, on a peripheral register model
+ *
+ * Compiles the transaction the driver makes for every command (CSN low,
+ * nrf24l01_port_spi_transfer(), CSN high) once with
+ * nrf24l01_port_stm32_reg.h and once with nrf24l01_port_stm32_hal.h, both
+ * against the F1 register model in benchmark/model, and prints for each
+ * frame length:
+ * - core cycles from CSN low to CSN high, and µs at 72 MHz
+ * - peripheral register accesses
+ * - cycles the SPI wire stood still between two bytes
+ * - whether the bytes read back are the ones the slave sent, in order
+ *
+ * The register port runs as it is; the HAL calls are a model of the
+ * STM32CubeF1 code (benchmark/model/stm32f1xx_hal.h). Register accesses
+ * and wire timing are exact for the model, the instruction costs between
+ * them are estimates (model::peripheral_access, model::data_access,
+ * model::call and the charges in the HAL model), so the numbers compare
+ * the two ports, they are not a measurement of a given board.
+ *
+ * Build and run from the repository root:
+ * @code
+ * g++ -O2 -std=c++17 -Ibenchmark/model -Isource benchmark/nrf24l01_port_cycles.cpp -o port_cycles
+ * ./port_cycles
+ * @endcode
+ * Add -DNRF24L01_STM32_REG_PIPELINED=0 for the register port waiting for
+ * every byte.
+ */
+
+#include <cstdio>
+#include "stm32f1xx.h"
+
+namespace {
+
+SPI_TypeDef spi1;
+GPIO_TypeDef gpioa;
+TIM_TypeDef tim2;
+
+struct result {
+    model::counters count;
+    bool data_ok;
+};
+
+} // namespace
+
+// -------- register port --------
+
+#include "nrf24l01_port_stm32_reg.h"
+
+uint32_t nrf24l01_reg_millis(void){ return model::millis(); }
+
+namespace reg_port {
+
+struct device { NRF24L01_PORT_DEVICE_FIELDS };
+
+void transaction(device * device, const uint8_t * tx, uint8_t * rx, uint16_t length){
+  nrf24l01_port_csn_write(device, 0);
+  nrf24l01_port_spi_transfer(device, tx, rx, length);
+  nrf24l01_port_csn_write(device, 1);
+}
+
+} // namespace reg_port
+
+// both ports in one file: drop the register port macros before the HAL ones
+#undef NRF24L01_PORT_DEVICE_FIELDS
+#undef NRF24L01_PORT_DEVICE_SIZE
+#undef nrf24l01_port_spi_transfer
+#undef nrf24l01_port_spi_transmit
+#undef nrf24l01_port_csn_write
+#undef nrf24l01_port_ce_write
+#undef nrf24l01_port_ce_read
+#undef nrf24l01_port_irq_read
+#undef nrf24l01_port_micros
+#undef nrf24l01_port_millis
+#undef nrf24l01_port_delay_ms
+#undef nrf24l01_port_timer_start
+
+// -------- HAL port --------
+
+#include "nrf24l01_port_stm32_hal.h"
+
+namespace hal_port {
+
+struct device { NRF24L01_PORT_DEVICE_FIELDS };
+
+void transaction(device * device, const uint8_t * tx, uint8_t * rx, uint16_t length){
+  nrf24l01_port_csn_write(device, 0);
+  nrf24l01_port_spi_transfer(device, tx, rx, length);
+  nrf24l01_port_csn_write(device, 1);
+}
+
+} // namespace hal_port
+
+namespace {
+
+template <typename Transaction>
+result run(Transaction transaction, uint16_t length){
+  uint8_t tx[33] = {0}, rx[33] = {0};
+  result r;
+  model::reset();
+  transaction(tx, rx, length);
+  r.count = model::count;
+  r.data_ok = model::count.overruns == 0 && model::count.lost == 0;
+  for (uint16_t i = 0; i < length; i++)
+    if (rx[i] != (uint8_t)(model::miso_first + i)) r.data_ok = false;
+  return r;
+}
+
+void print(const char * port, const result & r){
+  std::printf("  %-4s %7llu cycles %6.2f us %4u accesses %6llu idle  %s\n", port,
+              (unsigned long long)r.count.cycles, r.count.cycles * 1e6 / model::core_clock,
+              (unsigned)r.count.accesses, (unsigned long long)r.count.spi_idle, r.data_ok ? "ok" : "BAD DATA");
+}
+
+} // namespace
+
+int main(){
+  model::attach(&spi1, &gpioa, &tim2);
+
+  reg_port::device reg_device = {};
+  reg_device.spi = &spi1;
+  reg_device.ce_port = reg_device.csn_port = reg_device.irq_port = &gpioa;
+  reg_device.timer = &tim2;
+  reg_device.csn_pin = 1 << 9;
+
+  SPI_HandleTypeDef hspi1 = {};
+  hspi1.Instance = &spi1;
+  hspi1.Init.Mode = SPI_MODE_MASTER;
+  hspi1.Init.Direction = SPI_DIRECTION_2LINES;
+  hspi1.Init.DataSize = SPI_DATASIZE_8BIT;
+  hspi1.State = HAL_SPI_STATE_READY;
+  TIM_HandleTypeDef htim2 = {};
+  htim2.Instance = &tim2;
+  hal_port::device hal_device = {};
+  hal_device.spi = &hspi1;
+  hal_device.ce_port = hal_device.csn_port = hal_device.irq_port = &gpioa;
+  hal_device.timer = &htim2;
+  hal_device.csn_pin = 1 << 9;
+
+  static const struct { const char * name; uint16_t length; } frames[] = {
+    {"NOP / FLUSH_TX", 1},
+    {"R_REGISTER, 1 byte", 2},
+    {"W_REGISTER, 5-byte address", 6},
+    {"W_TX_PAYLOAD, 32 bytes", 33},
+  };
+
+  std::printf("SPI at %u MHz, %u cycles per byte on the wire\n", (unsigned)(model::core_clock / model::spi_prescaler / 1000000),
+              (unsigned)model::byte_cycles);
+  int failed = 0;
+  for (const auto & frame : frames){
+    result reg = run([&](const uint8_t * tx, uint8_t * rx, uint16_t length){ reg_port::transaction(&reg_device, tx, rx, length); }, frame.length);
+    result hal = run([&](const uint8_t * tx, uint8_t * rx, uint16_t length){ hal_port::transaction(&hal_device, tx, rx, length); }, frame.length);
+    std::printf("%s (%u bytes, %u cycles on the wire)\n", frame.name, frame.length, (unsigned)(frame.length * model::byte_cycles));
+    print("REG", reg);
+    print("HAL", hal);
+    std::printf("  HAL/REG %.2fx\n", (double)hal.count.cycles / reg.count.cycles);
+    if (!reg.data_ok || !hal.data_ok) failed = 1;
+  }
+  return failed;
+}
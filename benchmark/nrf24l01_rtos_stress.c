@@ -0,0 +1,194 @@
+/**
+ * @file nrf24l01_rtos_stress.c
+ * @brief Stress test of the RTOS layer with POSIX threads on the host port
+ *
+ * One PTX device shared by:
+ * - an ISR thread playing the chip's side: it ends the transmission at the
+ *   TX FIFO head, acknowledged or not at random, puts an ACK payload in the
+ *   RX FIFO for most acknowledged packets, and calls
+ *   nrf24l01_rtos_irq_from_isr() on every falling edge of the IRQ line
+ * - the worker, nrf24l01_rtos_worker() in a loop
+ * - NRF24L01_STRESS_SENDERS threads calling nrf24l01_rtos_send()
+ * - a receiver calling nrf24l01_rtos_receive()
+ *
+ * The ISR thread changes the emulated chip under nrf24l01_rtos_lock(), as
+ * the real chip changes between two SPI transactions, never during one.
+ * At the end it checks that:
+ * - every send returning 0 was acknowledged by the air and every other
+ *   one was not
+ * - the ACK payloads came out in the order they went in, and each one
+ *   injected was either received or counted in rx_dropped
+ * - nothing hung, with an alarm as the watchdog
+ *
+ * It exits non-zero on a failed check and prints the counters and the
+ * send rate. Build and run from the repository root, with
+ * -fsanitize=thread for a data race check:
+ * @code
+ * gcc -O2 -std=c11 -pthread -DNRF24L01_PORT=NRF24L01_PORT_HOST -Isource benchmark/nrf24l01_rtos_stress.c \
+ *     source/nrf24l01.c source/nrf24l01_events.c source/nrf24l01_rtos.c source/nrf24l01_port_host.c -o rtos_stress
+ * ./rtos_stress
+ * @endcode
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "nrf24l01_rtos.h"
+
+#ifndef NRF24L01_STRESS_SENDERS
+#define NRF24L01_STRESS_SENDERS   3
+#endif
+#ifndef NRF24L01_STRESS_SENDS
+#define NRF24L01_STRESS_SENDS     3000
+#endif
+
+enum { outcome_none = 0, outcome_acked, outcome_lost };
+
+static nrf24l01_host_chip chip;
+static nrf24l01_device nrf;
+static nrf24l01_rtos radio;
+
+static atomic_int senders_done, stop;
+static uint8_t outcome[NRF24L01_STRESS_SENDERS][NRF24L01_STRESS_SENDS]; // written by the air, under the lock
+static uint32_t injected;                                                // ACK payloads put in the RX FIFO
+static uint32_t wrong_result[NRF24L01_STRESS_SENDERS], timeouts[NRF24L01_STRESS_SENDERS];
+static uint32_t rx_taken, rx_out_of_order;
+
+static void * isr_thread(void * argument){
+  uint32_t random = 2463534242u, ack_sequence = 0;
+  uint8_t line = 1;
+  const struct timespec pause = {0, 20000}; // about one packet time
+  (void)argument;
+
+  while (!atomic_load(&stop)){
+    nrf24l01_rtos_lock(&radio);
+    // the chip sends only with CE high and halts on a flag it set
+    if (chip.ce && chip.tx_count && !(chip.registers[STATUS] & (TX_DS | MAX_RT))){
+      uint8_t payload[32];
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      uint8_t acked = random % 8 != 0;
+      nrf24l01_host_complete_tx(&chip, payload, acked);
+      uint16_t sequence = payload[1] | payload[2] << 8;
+      if (payload[0] < NRF24L01_STRESS_SENDERS && sequence < NRF24L01_STRESS_SENDS)
+        outcome[payload[0]][sequence] = acked ? outcome_acked : outcome_lost;
+
+      if (acked && random % 4 != 0){
+        uint8_t ack[4] = {ack_sequence, ack_sequence >> 8, ack_sequence >> 16, ack_sequence >> 24};
+        if (nrf24l01_host_receive(&chip, 0, ack, sizeof(ack)) == 0){
+          ack_sequence++;
+          injected++;
+        }
+      }
+    }
+    uint8_t level = nrf24l01_host_irq(&chip);
+    nrf24l01_rtos_unlock(&radio);
+
+    if (line && !level) nrf24l01_rtos_irq_from_isr(&radio);
+    line = level;
+    nanosleep(&pause, NULL);
+  }
+  return NULL;
+}
+
+static void * worker_thread(void * argument){
+  (void)argument;
+  while (!atomic_load(&stop)) nrf24l01_rtos_worker(&radio, 10);
+  return NULL;
+}
+
+static void * sender_thread(void * argument){
+  uint8_t id = (uint8_t)(uintptr_t)argument;
+  uint8_t payload[8] = {id};
+
+  for (uint16_t sequence = 0; sequence < NRF24L01_STRESS_SENDS; sequence++){
+    payload[1] = sequence;
+    payload[2] = sequence >> 8;
+    uint8_t result = nrf24l01_rtos_send(&radio, payload, sizeof(payload), 1000);
+
+    nrf24l01_rtos_lock(&radio);
+    uint8_t air = outcome[id][sequence];
+    nrf24l01_rtos_unlock(&radio);
+    if (air == outcome_none) timeouts[id]++;
+    else if ((result == 0) != (air == outcome_acked)) wrong_result[id]++;
+  }
+  return NULL;
+}
+
+static void * receiver_thread(void * argument){
+  uint8_t data[32], length;
+  int64_t last = -1;
+  (void)argument;
+
+  for (;;){
+    if (nrf24l01_rtos_receive(&radio, data, &length, NULL, 20) != 0){
+      // after the senders, until the queue stays empty for a while
+      if (atomic_load(&senders_done)) break;
+      continue;
+    }
+    int64_t sequence = data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+    if (length != 4 || sequence <= last) rx_out_of_order++;
+    last = sequence;
+    rx_taken++;
+  }
+  atomic_store(&stop, 1);
+  return NULL;
+}
+
+int main(void){
+  alarm(120); // watchdog: a deadlock ends the run with SIGALRM
+
+  nrf24l01_host_chip_reset(&chip);
+  nrf = nrf24l01_get_default_config();
+  nrf.chip = &chip;
+  nrf.power_up = 1;
+  nrf.dynamic_payload_length_enable = 1;
+  nrf.payload_with_ack_enable = 1;
+  nrf.data_pipe[0].nrf24l01_data_pipe_dyn_payload_length_enable = 1;
+  if (nrf24l01_init(&nrf) || nrf24l01_rtos_init(&radio, &nrf)){
+    printf("init failed\n");
+    return 1;
+  }
+
+  pthread_t isr, worker, receiver, sender[NRF24L01_STRESS_SENDERS];
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_create(&isr, NULL, isr_thread, NULL);
+  pthread_create(&worker, NULL, worker_thread, NULL);
+  pthread_create(&receiver, NULL, receiver_thread, NULL);
+  for (uintptr_t i = 0; i < NRF24L01_STRESS_SENDERS; i++) pthread_create(&sender[i], NULL, sender_thread, (void *)i);
+
+  for (int i = 0; i < NRF24L01_STRESS_SENDERS; i++) pthread_join(sender[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  atomic_store(&senders_done, 1);
+  pthread_join(receiver, NULL);
+  pthread_join(worker, NULL);
+  pthread_join(isr, NULL);
+
+  uint32_t wrong = 0, timed_out = 0;
+  for (int i = 0; i < NRF24L01_STRESS_SENDERS; i++){
+    wrong += wrong_result[i];
+    timed_out += timeouts[i];
+  }
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  nrf24l01_rtos_stats * stats = &radio.stats;
+  printf("%d senders x %d sends in %.2f s, %.0f sends/s\n", NRF24L01_STRESS_SENDERS, NRF24L01_STRESS_SENDS, seconds,
+         NRF24L01_STRESS_SENDERS * NRF24L01_STRESS_SENDS / seconds);
+  printf("sent %u failed %u (wrong result %u, timed out %u)\n", (unsigned)stats->sent, (unsigned)stats->send_failed,
+         (unsigned)wrong, (unsigned)timed_out);
+  printf("interrupts %u wakeups %u\n", (unsigned)stats->interrupts, (unsigned)stats->wakeups);
+  printf("ACK payloads injected %u received %u dropped %u taken %u out of order %u\n", (unsigned)injected,
+         (unsigned)stats->received, (unsigned)stats->rx_dropped, (unsigned)rx_taken, (unsigned)rx_out_of_order);
+
+  int failed = wrong != 0 || timed_out != 0 || rx_out_of_order != 0 ||
+               stats->sent + stats->send_failed != NRF24L01_STRESS_SENDERS * NRF24L01_STRESS_SENDS ||
+               stats->received + stats->rx_dropped != injected || rx_taken != stats->received;
+  printf("%s\n", failed ? "FAILED" : "ok");
+  return failed;
+}
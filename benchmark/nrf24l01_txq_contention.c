@@ -0,0 +1,189 @@
+/**
+ * @file nrf24l01_txq_contention.c
+ * @brief Enqueue latency and rejects of the TX queue as producers contend
+ *
+ * For 1, 2, 4 and 8 producer threads, each makes NRF24L01_CONTENTION_ATTEMPTS
+ * nrf24l01_txq_enqueue() calls like a sensor task: bursts of
+ * NRF24L01_CONTENTION_BURST back to back, NRF24L01_CONTENTION_PAUSE_US
+ * apart. One consumer thread runs nrf24l01_txq_service() against the host
+ * port and plays the air, emptying the TX FIFO as fast as it fills. The
+ * more producers, the more their bursts collide in the queue. Per
+ * producer count it prints:
+ * - enqueue latency, mean, median, 99th percentile and worst, in ns; each
+ *   call is timed with CLOCK_MONOTONIC and the cost of a timer read is
+ *   taken off
+ * - rejects, as a share of the attempts (queue full, or a producer
+ *   backing out of a full queue)
+ * - consumer stalls at a slot still being written, and payloads per second
+ *
+ * Every payload carries its producer and a sequence number, and the
+ * consumer checks that it arrives whole and in order per producer; the
+ * run exits non-zero otherwise. With more producers than cores the
+ * worst case includes preemption in the middle of an enqueue. Build and
+ * run from the repository root, with -fsanitize=thread and
+ * -DNRF24L01_CONTENTION_ATTEMPTS=4000 for a data race check:
+ * @code
+ * gcc -O2 -std=c11 -pthread -DNRF24L01_PORT=NRF24L01_PORT_HOST -Isource benchmark/nrf24l01_txq_contention.c \
+ *     source/nrf24l01.c source/nrf24l01_txq.c source/nrf24l01_port_host.c -o txq_contention
+ * ./txq_contention
+ * @endcode
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "nrf24l01_txq.h"
+
+#ifndef NRF24L01_CONTENTION_ATTEMPTS
+#define NRF24L01_CONTENTION_ATTEMPTS   40000
+#endif
+#ifndef NRF24L01_CONTENTION_BURST
+#define NRF24L01_CONTENTION_BURST      8
+#endif
+#ifndef NRF24L01_CONTENTION_PAUSE_US
+#define NRF24L01_CONTENTION_PAUSE_US   50
+#endif
+#define NRF24L01_CONTENTION_MAX_PRODUCERS   8
+
+typedef struct {
+    uint8_t id;
+    uint32_t rejected;
+    uint32_t * latency;                    /**< ns per attempt */
+} producer;
+
+static nrf24l01_host_chip chip;
+static nrf24l01_device nrf;
+static nrf24l01_txq txq;
+static atomic_int go, producers_done;
+static uint32_t timer_overhead;
+
+static uint64_t now_ns(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+static void * producer_thread(void * argument){
+  producer * self = argument;
+  uint8_t payload[32];
+  const struct timespec pause = {0, NRF24L01_CONTENTION_PAUSE_US * 1000L};
+  while (!atomic_load(&go));
+
+  for (uint32_t sequence = 0; sequence < NRF24L01_CONTENTION_ATTEMPTS; sequence++){
+    payload[0] = self->id;
+    for (uint8_t i = 0; i < 4; i++) payload[1 + i] = sequence >> (8 * i);
+    for (uint8_t i = 5; i < sizeof(payload); i++) payload[i] = (uint8_t)(sequence + i + self->id);
+
+    uint64_t start = now_ns();
+    uint8_t result = nrf24l01_txq_enqueue(&txq, payload, sizeof(payload));
+    uint64_t elapsed = now_ns() - start;
+    self->latency[sequence] = elapsed > timer_overhead ? (uint32_t)(elapsed - timer_overhead) : 0;
+    if (result != 0) self->rejected++;
+    if (sequence % NRF24L01_CONTENTION_BURST == NRF24L01_CONTENTION_BURST - 1) nanosleep(&pause, NULL);
+  }
+  return NULL;
+}
+
+typedef struct {
+    uint32_t received, corrupted;
+    int64_t last[NRF24L01_CONTENTION_MAX_PRODUCERS];
+} consumer;
+
+static void * consumer_thread(void * argument){
+  consumer * self = argument;
+  uint8_t payload[32];
+  for (int i = 0; i < NRF24L01_CONTENTION_MAX_PRODUCERS; i++) self->last[i] = -1;
+
+  for (;;){
+    int done = atomic_load(&producers_done);
+    if (nrf24l01_txq_service(&txq) == 0) sched_yield();
+    // the air: every payload in the TX FIFO goes out acknowledged
+    uint8_t length;
+    while ((length = nrf24l01_host_complete_tx(&chip, payload, 1)) != 0){
+      uint8_t id = payload[0];
+      int64_t sequence = payload[1] | payload[2] << 8 | payload[3] << 16 | (uint32_t)payload[4] << 24;
+      uint8_t whole = length == sizeof(payload) && id < NRF24L01_CONTENTION_MAX_PRODUCERS && sequence > self->last[id];
+      for (uint8_t i = 5; whole && i < sizeof(payload); i++) whole = payload[i] == (uint8_t)(sequence + i + id);
+      if (whole) self->last[id] = sequence;
+      else self->corrupted++;
+      self->received++;
+    }
+    // producers finished before this pass and it left nothing behind
+    if (done && atomic_load(&txq.count) == 0) break;
+  }
+  return NULL;
+}
+
+static int compare(const void * a, const void * b){
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int run(int producers){
+  static uint32_t latency[NRF24L01_CONTENTION_MAX_PRODUCERS * NRF24L01_CONTENTION_ATTEMPTS];
+  producer state[NRF24L01_CONTENTION_MAX_PRODUCERS];
+  consumer consumer = {0};
+  pthread_t thread[NRF24L01_CONTENTION_MAX_PRODUCERS], consumer_id;
+
+  nrf24l01_host_chip_reset(&chip);
+  nrf = nrf24l01_get_default_config();
+  nrf.chip = &chip;
+  nrf.power_up = 1;
+  nrf24l01_init(&nrf);
+  nrf24l01_txq_init(&txq, &nrf);
+  atomic_store(&go, 0);
+  atomic_store(&producers_done, 0);
+
+  pthread_create(&consumer_id, NULL, consumer_thread, &consumer);
+  for (int i = 0; i < producers; i++){
+    state[i] = (producer){.id = (uint8_t)i, .latency = &latency[i * NRF24L01_CONTENTION_ATTEMPTS]};
+    pthread_create(&thread[i], NULL, producer_thread, &state[i]);
+  }
+  uint64_t start = now_ns();
+  atomic_store(&go, 1);
+  for (int i = 0; i < producers; i++) pthread_join(thread[i], NULL);
+  atomic_store(&producers_done, 1);
+  pthread_join(consumer_id, NULL);
+  double seconds = (now_ns() - start) / 1e9;
+
+  uint32_t attempts = producers * NRF24L01_CONTENTION_ATTEMPTS, rejected = 0;
+  uint64_t sum = 0;
+  for (int i = 0; i < producers; i++) rejected += state[i].rejected;
+  for (uint32_t i = 0; i < attempts; i++) sum += latency[i];
+  qsort(latency, attempts, sizeof(latency[0]), compare);
+
+  printf("%d  %8.1f %6u %6u %9u   %6.2f%%  %8u  %10.0f\n", producers, (double)sum / attempts, (unsigned)latency[attempts / 2],
+         (unsigned)latency[attempts - attempts / 100], (unsigned)latency[attempts - 1], rejected * 100.0 / attempts,
+         (unsigned)txq.stats.stalls, txq.stats.sent / seconds);
+
+  uint32_t counted = (uint32_t)atomic_load(&txq.stats.rejected);
+  if (consumer.corrupted || consumer.received != attempts - rejected || txq.stats.sent != consumer.received || counted != rejected){
+    printf("   FAILED: received %u of %u, corrupted %u, rejected %u counted %u\n", (unsigned)consumer.received,
+           (unsigned)(attempts - rejected), (unsigned)consumer.corrupted, (unsigned)rejected, (unsigned)counted);
+    return 1;
+  }
+  return 0;
+}
+
+int main(void){
+  // cost of the timer read itself, least of many
+  uint64_t least = UINT64_MAX;
+  for (int i = 0; i < 100000; i++){
+    uint64_t start = now_ns(), elapsed = now_ns() - start;
+    if (elapsed < least) least = elapsed;
+  }
+  timer_overhead = (uint32_t)least;
+
+  printf("%u attempts per producer in bursts of %d every %d us, queue depth %d, %ld cores, timer read %u ns taken off\n",
+         NRF24L01_CONTENTION_ATTEMPTS, NRF24L01_CONTENTION_BURST, NRF24L01_CONTENTION_PAUSE_US, NRF24L01_TXQ_DEPTH,
+         sysconf(_SC_NPROCESSORS_ONLN), (unsigned)timer_overhead);
+  printf("P  mean ns    p50    p99     worst   rejects   stalls   payloads/s\n");
+  int failed = 0;
+  for (int producers = 1; producers <= NRF24L01_CONTENTION_MAX_PRODUCERS; producers *= 2) failed |= run(producers);
+  return failed;
+}
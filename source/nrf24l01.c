@@ -1,15 +1,19 @@
 #include "nrf24l01.h"
-#include "stm32f1xx_hal.h"
+
+#ifndef nrf24l01_port_spi_transmit
+// ports without a transmit-only transfer shift the answer into a scratch buffer
+static uint8_t nrf24l01_spi_transmit_scratch(nrf24l01_device * device, const uint8_t * tx, uint16_t length){
+  uint8_t scratch[NRF24L01_SPI_BUFFER_SIZE];
+  return nrf24l01_port_spi_transfer(device, tx, scratch, length);
+}
+#define nrf24l01_port_spi_transmit(device, tx, length) nrf24l01_spi_transmit_scratch((device), (tx), (length))
+#endif
+
+_Static_assert(sizeof(nrf24l01_device) <= NRF24L01_DEVICE_SIZE_BUDGET, "nrf24l01_device exceeds NRF24L01_DEVICE_SIZE_BUDGET");
+
 nrf24l01_device nrf24l01_get_default_config(){
   nrf24l01_device new_device;
-  new_device.spi = NULL;
-  new_device.irq_port = NULL;
-  new_device.ce_port = NULL;
-  new_device.csn_port = NULL;
-  new_device.irq_pin = 0;
-  new_device.ce_pin = 0;
-  new_device.csn_pin = 0;
-  new_device.timer = NULL;
+  memset(&new_device, 0, sizeof(nrf24l01_device));
   new_device.power_up = 0;
   new_device.primary_rx = 0;
   new_device.dynamic_ack_enable = 0;
@@ -22,69 +26,57 @@ nrf24l01_device nrf24l01_get_default_config(){
   new_device.air_data_rate = nrf24l01_air_data_rate_2mbps;
   new_device.rf_output_power = nrf24l01_rf_output_power_0dbm;
   new_device.setup_lna_gain = 1;
+  new_device.crc_length = nrf24l01_crc_1byte;
 
   /* data pipe 0 */
   new_device.data_pipe[0].nrf24l01_data_pipe_enable = 1;
   new_device.data_pipe[0].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[0].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(5);
   memset(new_device.data_pipe[0].nrf24l01_data_pipe_receive_address, 0xe7, 5 * sizeof(uint8_t));
   new_device.data_pipe[0].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[0].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[0].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
   /* data pipe 1 */
   new_device.data_pipe[1].nrf24l01_data_pipe_enable = 1;
   new_device.data_pipe[1].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[1].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(5);
   memset(new_device.data_pipe[1].nrf24l01_data_pipe_receive_address, 0xc2, 5 * sizeof(uint8_t));
   new_device.data_pipe[1].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[1].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[1].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
   /* data pipe 2 */
   new_device.data_pipe[2].nrf24l01_data_pipe_enable = 0;
   new_device.data_pipe[2].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[2].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(1);
   memset(new_device.data_pipe[2].nrf24l01_data_pipe_receive_address, 0xc3, 1 * sizeof(uint8_t));
   new_device.data_pipe[2].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[2].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[2].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
   /* data pipe 3 */
   new_device.data_pipe[3].nrf24l01_data_pipe_enable = 0;
   new_device.data_pipe[3].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[3].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(1);
   memset(new_device.data_pipe[3].nrf24l01_data_pipe_receive_address, 0xc4, 1 * sizeof(uint8_t));
   new_device.data_pipe[3].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[3].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[3].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
   /* data pipe 4 */
   new_device.data_pipe[4].nrf24l01_data_pipe_enable = 0;
   new_device.data_pipe[4].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[4].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(1);
   memset(new_device.data_pipe[4].nrf24l01_data_pipe_receive_address, 0xc5, 1 * sizeof(uint8_t));
   new_device.data_pipe[4].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[4].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[4].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
   /* data pipe 5 */
   new_device.data_pipe[5].nrf24l01_data_pipe_enable = 0;
   new_device.data_pipe[5].nrf24l01_data_pipe_auto_ack = 1;
-  new_device.data_pipe[5].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(1);
   memset(new_device.data_pipe[5].nrf24l01_data_pipe_receive_address, 0xc6, 1 * sizeof(uint8_t));
   new_device.data_pipe[5].nrf24l01_data_pipe_payload_width = 0;
-  new_device.data_pipe[5].nrf24l01_data_pipe_payload = NULL;
   new_device.data_pipe[5].nrf24l01_data_pipe_dyn_payload_length_enable = 0;
 
-  new_device.transmit_address = malloc(5) ;
   memset(new_device.transmit_address, 0xe7, 5 * sizeof(uint8_t));
   return new_device;
 }
 
 uint8_t nrf24l01_init(nrf24l01_device * device){
   if (device == NULL) return -1; // null pointer
-  HAL_Delay(11);
+  nrf24l01_port_delay_ms(device, 11);
   // power
   if (device->power_up)
     nrf24l01_power_up(device);
@@ -98,6 +90,21 @@ uint8_t nrf24l01_init(nrf24l01_device * device){
     config_register |= PRIM_RX;
   else
     config_register &= ~PRIM_RX;
+
+  // crc length
+  switch (device->crc_length) {
+    case nrf24l01_crc_disabled:
+      CLEAR_BIT(config_register, EN_CRC | CRCO);
+      break;
+    case nrf24l01_crc_2bytes:
+      SET_BIT(config_register, EN_CRC | CRCO);
+      break;
+    case nrf24l01_crc_1byte:
+    default:
+      // default config: 1 byte (chip reset value)
+      SET_BIT(config_register, EN_CRC);
+      CLEAR_BIT(config_register, CRCO);
+  }
   nrf24l01_write_register(device, CONFIG, &config_register, 1);
 
   // address_width
@@ -123,7 +130,7 @@ uint8_t nrf24l01_init(nrf24l01_device * device){
 
   // auto retransmit delay and retransmit count
   uint8_t setup_retr_register = 0;
-  setup_retr_register |= (device->auto_retransmit_delay << 4) | (device->auto_retransmit_count);
+  setup_retr_register |= NRF24L01_FIELD_PREP(ARD, device->auto_retransmit_delay) | NRF24L01_FIELD_PREP(ARC, device->auto_retransmit_count);
   nrf24l01_write_register(device, SETUP_RETR, &setup_retr_register, 1);
 
   // frequency channel
@@ -175,6 +182,16 @@ uint8_t nrf24l01_init(nrf24l01_device * device){
   // write new configuration to rf_setup register
   nrf24l01_write_register(device, RF_SETUP, &rf_setup_register, 1);
 
+  // features
+  uint8_t feature_register = 0;
+  if (device->dynamic_payload_length_enable)
+    SET_BIT(feature_register, EN_DPL);
+  if (device->payload_with_ack_enable)
+    SET_BIT(feature_register, EN_ACK_PAY);
+  if (device->dynamic_ack_enable)
+    SET_BIT(feature_register, EN_DYN_ACK);
+  nrf24l01_write_register(device, FEATURE, &feature_register, 1);
+
   // data pipes
   nrf24l01_init_data_pipe(device, 0);
   nrf24l01_init_data_pipe(device, 1);
@@ -187,12 +204,16 @@ uint8_t nrf24l01_init(nrf24l01_device * device){
   nrf24l01_write_register(device, TX_ADDR, device->transmit_address, device->address_width);
 
   // start timer
-//  SET_BIT(device->timer->Instance->CR1, TIM_CR1_CEN);
-  HAL_TIM_Base_Start(device->timer);
+  nrf24l01_port_timer_start(device);
   return 0;
 }
 
-void nrf24l01_deinit(nrf24l01_device * device);
+void nrf24l01_deinit(nrf24l01_device * device){
+  if (device == NULL) return;
+  nrf24l01_chip_disable(device);
+  nrf24l01_power_down(device);
+  nrf24l01_chip_deselect(device);
+}
 
 uint8_t nrf24l01_init_data_pipe(nrf24l01_device * device, uint8_t pipe_number)
 {
@@ -238,33 +259,179 @@ uint8_t nrf24l01_init_data_pipe(nrf24l01_device * device, uint8_t pipe_number)
 
 }
 
+uint8_t nrf24l01_build_register_image(nrf24l01_device * device, nrf24l01_register_image * image){
+  if (device == NULL || image == NULL) return -1;
+  memset(image, 0, sizeof(nrf24l01_register_image));
+
+  // config
+  if (device->power_up) image->config |= PWR_UP;
+  if (device->primary_rx) image->config |= PRIM_RX;
+  if (device->crc_length == nrf24l01_crc_2bytes) image->config |= EN_CRC | CRCO;
+  else if (device->crc_length != nrf24l01_crc_disabled) image->config |= EN_CRC;
+
+  // data pipes
+  for (uint8_t i = 0; i < 6; i++){
+    nrf24l01_data_pipe * pipe = &device->data_pipe[i];
+    if (pipe->nrf24l01_data_pipe_enable) image->en_rxaddr |= 1 << i;
+    if (pipe->nrf24l01_data_pipe_auto_ack) image->en_aa |= 1 << i;
+    if (pipe->nrf24l01_data_pipe_dyn_payload_length_enable) image->dynpd |= 1 << i;
+    image->rx_pw[i] = pipe->nrf24l01_data_pipe_payload_width;
+    if (i > 1)
+      image->rx_addr_p2_p5[i - 2] = pipe->nrf24l01_data_pipe_receive_address[0];
+  }
+
+  // address width
+  if (device->address_width < nrf24l01_address_width_3bytes || device->address_width > nrf24l01_address_width_5bytes)
+    device->address_width = nrf24l01_address_width_5bytes;
+  image->setup_aw = device->address_width - 2;
+  memcpy(image->rx_addr_p0, device->data_pipe[0].nrf24l01_data_pipe_receive_address, device->address_width);
+  memcpy(image->rx_addr_p1, device->data_pipe[1].nrf24l01_data_pipe_receive_address, device->address_width);
+  memcpy(image->tx_addr, device->transmit_address, device->address_width);
+
+  // retransmission, channel and rf setup
+  image->setup_retr = NRF24L01_FIELD_PREP(ARD, device->auto_retransmit_delay) | NRF24L01_FIELD_PREP(ARC, device->auto_retransmit_count);
+  image->rf_ch = device->frequency_channel > 125 ? 2 : device->frequency_channel;
+  if (device->air_data_rate != nrf24l01_air_data_rate_1mbps) image->rf_setup |= RF_DR;
+  switch (device->rf_output_power) {
+    case nrf24l01_rf_output_power_minus18dbm:
+      break;
+    case nrf24l01_rf_output_power_minus12dbm:
+      image->rf_setup |= RF_PWR0;
+      break;
+    case nrf24l01_rf_output_power_minus6dbm:
+      image->rf_setup |= RF_PWR1;
+      break;
+    default:
+      image->rf_setup |= RF_PWR;
+  }
+  if (device->setup_lna_gain) image->rf_setup |= LNA_HCURR;
+
+  // features
+  if (device->dynamic_payload_length_enable) image->feature |= EN_DPL;
+  if (device->payload_with_ack_enable) image->feature |= EN_ACK_PAY;
+  if (device->dynamic_ack_enable) image->feature |= EN_DYN_ACK;
+
+  return 0;
+}
+
+uint8_t nrf24l01_write_register_image(nrf24l01_device * device, const nrf24l01_register_image * image){
+  if (device == NULL || image == NULL) return -1;
+  uint8_t address_width = NRF24L01_FIELD_GET(AW, image->setup_aw) + 2;
+  uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+  uint8_t value;
+
+  // registers are only writable in standby or power down
+  if (chip_enabled) nrf24l01_chip_disable(device);
+
+  value = image->setup_aw;
+  nrf24l01_write_register(device, SETUP_AW, &value, 1);
+  value = image->en_aa;
+  nrf24l01_write_register(device, EN_AA, &value, 1);
+  value = image->en_rxaddr;
+  nrf24l01_write_register(device, EN_RXADDR, &value, 1);
+  value = image->setup_retr;
+  nrf24l01_write_register(device, SETUP_RETR, &value, 1);
+  value = image->rf_ch;
+  nrf24l01_write_register(device, RF_CH, &value, 1);
+  value = image->rf_setup;
+  nrf24l01_write_register(device, RF_SETUP, &value, 1);
+  nrf24l01_write_register(device, RX_ADDR_P0, (uint8_t *)image->rx_addr_p0, address_width);
+  nrf24l01_write_register(device, RX_ADDR_P1, (uint8_t *)image->rx_addr_p1, address_width);
+  for (uint8_t i = 0; i < 4; i++)
+    nrf24l01_write_register(device, RX_ADDR_P2 + i, (uint8_t *)&image->rx_addr_p2_p5[i], 1);
+  nrf24l01_write_register(device, TX_ADDR, (uint8_t *)image->tx_addr, address_width);
+  for (uint8_t i = 0; i < 6; i++)
+    nrf24l01_write_register(device, RX_PW_P0 + i, (uint8_t *)&image->rx_pw[i], 1);
+  value = image->feature;
+  nrf24l01_write_register(device, FEATURE, &value, 1);
+  value = image->dynpd;
+  nrf24l01_write_register(device, DYNPD, &value, 1);
+  value = image->config;
+  nrf24l01_write_register(device, CONFIG, &value, 1);
+
+  device->power_up = (image->config & PWR_UP) != 0;
+  device->primary_rx = (image->config & PRIM_RX) != 0;
+
+  if (chip_enabled) nrf24l01_chip_enable(device);
+
+  return 0;
+}
+
+uint8_t nrf24l01_load_register_image(nrf24l01_device * device, const nrf24l01_register_image * image){
+  if (device == NULL || image == NULL) return -1;
+  uint8_t address_width = NRF24L01_FIELD_GET(AW, image->setup_aw) + 2;
+  device->address_width = (nrf24l01_address_width)address_width;
+  device->auto_retransmit_delay = (nrf24l01_auto_retransmit_delay)NRF24L01_FIELD_GET(ARD, image->setup_retr);
+  device->auto_retransmit_count = (nrf24l01_auto_retransmit_count)NRF24L01_FIELD_GET(ARC, image->setup_retr);
+  device->frequency_channel = image->rf_ch;
+  device->air_data_rate = (image->rf_setup & RF_DR) ? nrf24l01_air_data_rate_2mbps : nrf24l01_air_data_rate_1mbps;
+  device->rf_output_power = (nrf24l01_rf_output_power)NRF24L01_FIELD_GET(RF_PWR, image->rf_setup);
+  device->setup_lna_gain = image->rf_setup & LNA_HCURR;
+  if (!(image->config & EN_CRC)) device->crc_length = nrf24l01_crc_disabled;
+  else device->crc_length = (image->config & CRCO) ? nrf24l01_crc_2bytes : nrf24l01_crc_1byte;
+  device->dynamic_payload_length_enable = (image->feature & EN_DPL) != 0;
+  device->payload_with_ack_enable = (image->feature & EN_ACK_PAY) != 0;
+  device->dynamic_ack_enable = (image->feature & EN_DYN_ACK) != 0;
+  for (uint8_t i = 0; i < 6; i++){
+    device->data_pipe[i].nrf24l01_data_pipe_enable = (image->en_rxaddr >> i) & 1;
+    device->data_pipe[i].nrf24l01_data_pipe_auto_ack = (image->en_aa >> i) & 1;
+    device->data_pipe[i].nrf24l01_data_pipe_dyn_payload_length_enable = (image->dynpd >> i) & 1;
+    device->data_pipe[i].nrf24l01_data_pipe_payload_width = image->rx_pw[i];
+    if (i > 1)
+      device->data_pipe[i].nrf24l01_data_pipe_receive_address[0] = image->rx_addr_p2_p5[i - 2];
+  }
+  memcpy(device->data_pipe[0].nrf24l01_data_pipe_receive_address, image->rx_addr_p0, address_width);
+  memcpy(device->data_pipe[1].nrf24l01_data_pipe_receive_address, image->rx_addr_p1, address_width);
+  memcpy(device->transmit_address, image->tx_addr, address_width);
+  device->power_up = (image->config & PWR_UP) != 0;
+  device->primary_rx = (image->config & PRIM_RX) != 0;
+  return 0;
+}
+
+uint8_t nrf24l01_init_from_image(nrf24l01_device * device, const nrf24l01_register_image * image){
+  if (device == NULL || image == NULL) return -1;
+  nrf24l01_port_delay_ms(device, 11);
+
+  nrf24l01_write_register_image(device, image);
+  // keep the cached configuration in line with the chip
+  nrf24l01_load_register_image(device, image);
+
+  if (device->power_up)
+    nrf24l01_port_delay_ms(device, 2);
+
+  nrf24l01_port_timer_start(device);
+  return 0;
+}
+
 void nrf24l01_delay(nrf24l01_device * device, uint16_t us){
-  if (device == NULL || device->timer == NULL) return;
-  __HAL_TIM_SET_COUNTER(device->timer, 0) ;
-  while (__HAL_TIM_GET_COUNTER(device->timer) < us);
+  if (device == NULL) return;
+  uint16_t start = nrf24l01_port_micros(device);
+  while ((uint16_t)(nrf24l01_port_micros(device) - start) < us);
 }
 
 inline uint8_t nrf24l01_chip_select(nrf24l01_device * device){
   if (device == NULL) return -1;
-  HAL_GPIO_WritePin(device->csn_port, device->csn_pin, (uint8_t )RESET);
+  nrf24l01_port_csn_write(device, 0);
   return 0;
 }
 
 inline uint8_t nrf24l01_chip_deselect(nrf24l01_device * device){
   if (device == NULL) return -1;
-  HAL_GPIO_WritePin(device->csn_port, device->csn_pin, (uint8_t)SET);
+  nrf24l01_port_csn_write(device, 1);
   return 0;
 }
 
 inline uint8_t nrf24l01_chip_enable(nrf24l01_device * device){
   if (device == NULL) return -1;
-  HAL_GPIO_WritePin(device->ce_port, device->ce_pin, (uint8_t)SET) ;
+  nrf24l01_port_ce_write(device, 1);
+  NRF24L01_OBSERVE(device, nrf24l01_observe_ce, 1);
   return 0;
 }
 
 inline uint8_t nrf24l01_chip_disable(nrf24l01_device * device){
   if (device == NULL) return -1;
-  HAL_GPIO_WritePin(device->ce_port, device->ce_pin, (uint8_t)RESET);
+  nrf24l01_port_ce_write(device, 0);
+  NRF24L01_OBSERVE(device, nrf24l01_observe_ce, 0);
   return 0;
 }
 
@@ -279,7 +446,7 @@ uint8_t nrf24l01_send_command(nrf24l01_device* device, uint8_t command){
 
   /* perform spi transmit */
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, &spi_tx_payload, &spi_rx_payload, 1, 100) ;
+  nrf24l01_port_spi_transfer(device, &spi_tx_payload, &spi_rx_payload, 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload;
@@ -290,77 +457,75 @@ uint8_t nrf24l01_send_command(nrf24l01_device* device, uint8_t command){
 uint8_t nrf24l01_read_register(nrf24l01_device * device, uint8_t reg, uint8_t* data, uint16_t length){
   if (reg > 0x1d) return -1; // invalid register address
   if (data == NULL) return -1; // invalid pointer
+  if (length > 32) return -1; // invalid length
   if (device == NULL) return -1;
 
   uint8_t status_register = 0;
   uint8_t command = reg | R_REGISTER;
 
-  uint8_t* spi_tx_payload = (uint8_t*) malloc(length + 1);
-  uint8_t* spi_rx_payload = (uint8_t*) malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = command;
   memset(spi_tx_payload + 1, 0xff, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length + 1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length + 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
   memcpy(data, spi_rx_payload + 1, length);
 
-  free(spi_rx_payload);
-  free(spi_tx_payload);
 
   return status_register;
 }
 
 uint8_t nrf24l01_write_register(nrf24l01_device * device, uint8_t reg, uint8_t* data, uint16_t length){
   if (reg > 0x1d) return -1; // invalid register address
-  else if (HAL_GPIO_ReadPin(device->ce_port, device->ce_pin)) return -1; // invalid mode
+  else if (nrf24l01_port_ce_read(device)) return -1; // invalid mode
   else if (data == NULL) return  -1; // invalid pointer
+  else if (length > 32) return -1; // invalid length
   else if (device == NULL) return -1;
 
 
   uint8_t status_register = 0 ;
   uint8_t command = reg | W_REGISTER;
 
-  uint8_t* spi_tx_payload =(uint8_t *) malloc(length + 1);
-  uint8_t* spi_rx_payload =(uint8_t *) malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = command;
   memcpy(spi_tx_payload + 1, data, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length + 1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length + 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
+  if (reg == CONFIG && length > 0) NRF24L01_OBSERVE(device, nrf24l01_observe_config, data[0]);
+  if (reg == RF_SETUP && length > 0) NRF24L01_OBSERVE(device, nrf24l01_observe_rf_setup, data[0]);
 
-  free(spi_rx_payload);
-  free(spi_tx_payload);
 
   return status_register;
 }
 
 uint8_t nrf24l01_read_rx_payload(nrf24l01_device * device, uint8_t* data, uint16_t length){
-  uint8_t config_register = 0, status_register = 0;
+  uint8_t status_register = 0;
   if (device == NULL) return -1;
-  nrf24l01_read_register(device, CONFIG, &config_register, 1);
   if (length < 1 || length > 32) return -1; // invalid payload length
   if (data == NULL) return  -1; // invalid pointer
 
-  uint8_t* spi_tx_payload = (uint8_t*)malloc(length + 1);
-  uint8_t* spi_rx_payload = (uint8_t*)malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = R_RX_PAYLOAD;
   memset(spi_tx_payload + 1, 0xff, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length + 1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length + 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
   memcpy(data, spi_rx_payload + 1, length);
+  NRF24L01_OBSERVE(device, nrf24l01_observe_rx_payload, length);
 
-  free(spi_rx_payload);
-  free(spi_tx_payload);
 
   return status_register;
 }
@@ -372,19 +537,56 @@ uint8_t nrf24l01_write_tx_payload(nrf24l01_device * device, uint8_t* data , uint
   if (data == NULL) return  -1; // invalid pointer;
   if (device == NULL) return -1;
 
-  uint8_t* spi_tx_payload = (uint8_t*)malloc(length + 1);
-  uint8_t* spi_rx_payload = (uint8_t*)malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = W_TX_PAYLOAD;
   memcpy(spi_tx_payload + 1, data, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length + 1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length + 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
+  NRF24L01_OBSERVE(device, nrf24l01_observe_tx_payload, length);
 
-  free(spi_tx_payload);
-  free(spi_rx_payload);
+
+  return status_register;
+}
+
+uint8_t nrf24l01_read_rx_frame(nrf24l01_device * device, uint8_t * frame, uint16_t length){
+  if (device == NULL) return -1;
+  if (frame == NULL) return -1; // invalid pointer
+  if (length < 1 || length > 32) return -1; // invalid payload length
+
+  // in place: the command goes out of the headroom byte and STATUS comes back into it,
+  // the chip ignores what is clocked out while it shifts the payload
+  frame[0] = R_RX_PAYLOAD;
+
+  nrf24l01_chip_select(device);
+  nrf24l01_port_spi_transfer(device, frame, frame, length + 1);
+  nrf24l01_chip_deselect(device);
+  NRF24L01_OBSERVE(device, nrf24l01_observe_rx_payload, length);
+
+  return frame[0];
+}
+
+uint8_t nrf24l01_write_tx_frame(nrf24l01_device * device, uint8_t command, const uint8_t * frame, uint16_t length){
+  uint8_t status_register = 0;
+  if (device == NULL) return -1;
+  if (frame == NULL) return -1; // invalid pointer
+  if (length < 1 || length > 32) return -1; // invalid payload length
+  if (command != W_TX_PAYLOAD && command != W_TX_PAYLOAD_NOACK &&
+      !((command & 0xF8) == W_ACK_PAYLOAD && (command & 0x07) <= 5)) return -1; // invalid command
+
+  // command and STATUS stay on the stack, not in the headroom: the frame is
+  // only read, so radios in different contexts may send the same one at once
+  nrf24l01_chip_select(device);
+  nrf24l01_port_spi_transfer(device, &command, &status_register, 1);
+  nrf24l01_port_spi_transmit(device, frame + 1, length);
+  nrf24l01_chip_deselect(device);
+  NRF24L01_OBSERVE(device, command == W_TX_PAYLOAD ? nrf24l01_observe_tx_payload :
+                           command == W_TX_PAYLOAD_NOACK ? nrf24l01_observe_tx_payload_no_ack : nrf24l01_observe_ack_payload,
+                   length);
 
   return status_register;
 }
@@ -428,7 +630,7 @@ uint8_t nrf24l01_activate_extra_features(nrf24l01_device * device){
   uint8_t spi_rx_payload[2];
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, 2, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, 2);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
@@ -445,7 +647,7 @@ uint8_t nrf24l01_read_rx_payload_width(nrf24l01_device * device, uint8_t* data){
   spi_tx_payload[1] = 0xff;
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, 2, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, 2);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
@@ -459,22 +661,22 @@ uint8_t nrf24l01_write_ack_payload(nrf24l01_device * device, uint8_t* data, uint
   if (device == NULL) return -1;
   nrf24l01_read_register(device, CONFIG, &config_register, 1);
 
-  if (!(config_register & PWR_UP && config_register & PRIM_RX && HAL_GPIO_ReadPin(device->ce_port, device->ce_pin))) return -1; // invalid mode
+  if (!(config_register & PWR_UP && config_register & PRIM_RX && nrf24l01_port_ce_read(device))) return -1; // invalid mode
   if (pipe > 5) return -1; // invalid pipe number
+  if (length < 1 || length > 32) return -1; // invalid length
 
-  uint8_t* spi_tx_payload = (uint8_t*)malloc(length + 1);
-  uint8_t* spi_rx_payload = (uint8_t*)malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = W_ACK_PAYLOAD | pipe;
   memcpy(spi_tx_payload + 1, data, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length+1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length+1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
+  NRF24L01_OBSERVE(device, nrf24l01_observe_ack_payload, length);
 
-  free(spi_rx_payload);
-  free(spi_tx_payload);
 
   return status_register;
 }
@@ -484,22 +686,21 @@ uint8_t nrf24l01_write_tx_payload_no_ack(nrf24l01_device * device, uint8_t * dat
   if (device == NULL) return -1;
   nrf24l01_read_register(device, CONFIG, &config_register, 1);
 
-  if (!(config_register & PWR_UP && ~config_register & PRIM_RX && HAL_GPIO_ReadPin(device->ce_port, device->ce_pin))) return -1; // invalid mode
+  if (!(config_register & PWR_UP && ~config_register & PRIM_RX && nrf24l01_port_ce_read(device))) return -1; // invalid mode
   if (length < 1 || length > 32) return -1; // invalid length
 
-  uint8_t* spi_tx_payload = (uint8_t*)malloc(length + 1);
-  uint8_t* spi_rx_payload = (uint8_t*)malloc(length + 1);
+  uint8_t spi_tx_payload[NRF24L01_SPI_BUFFER_SIZE];
+  uint8_t spi_rx_payload[NRF24L01_SPI_BUFFER_SIZE];
   spi_tx_payload[0] = W_TX_PAYLOAD_NOACK;
   memcpy(spi_tx_payload + 1, data, length);
 
   nrf24l01_chip_select(device);
-  HAL_SPI_TransmitReceive(device->spi, spi_tx_payload, spi_rx_payload, length + 1, 100);
+  nrf24l01_port_spi_transfer(device, spi_tx_payload, spi_rx_payload, length + 1);
   nrf24l01_chip_deselect(device);
 
   status_register = spi_rx_payload[0];
+  NRF24L01_OBSERVE(device, nrf24l01_observe_tx_payload_no_ack, length);
 
-  free(spi_tx_payload);
-  free(spi_rx_payload);
 
   return status_register;
 }
@@ -518,7 +719,7 @@ uint8_t nrf24l01_power_up(nrf24l01_device * device){
 
   device->power_up = 1;
 
-  HAL_Delay(2);
+  nrf24l01_port_delay_ms(device, 2);
 
   return status_register;
 }
@@ -615,13 +816,38 @@ uint8_t nrf24l01_dynamic_ack(nrf24l01_device * device, uint8_t enable){
   return status_register;
 }
 
+uint8_t nrf24l01_crc(nrf24l01_device * device, nrf24l01_crc_length crc){
+  uint8_t status_register = 0, config_register = 0;
+  if (device == NULL) return -1;
+  nrf24l01_read_register(device, CONFIG, &config_register, 1);
+
+  switch (crc) {
+    case nrf24l01_crc_disabled:
+      CLEAR_BIT(config_register, EN_CRC | CRCO);
+      break;
+    case nrf24l01_crc_1byte:
+      SET_BIT(config_register, EN_CRC);
+      CLEAR_BIT(config_register, CRCO);
+      break;
+    case nrf24l01_crc_2bytes:
+      SET_BIT(config_register, EN_CRC | CRCO);
+      break;
+    default:
+      return -1; // invalid crc length
+  }
+
+  status_register = nrf24l01_write_register(device, CONFIG, &config_register, 1);
+
+  return status_register;
+}
+
 uint8_t nrf24l01_data_pipe_dynamic_payload_length(nrf24l01_device * device, uint8_t pipe_number, uint8_t enable){
   if (pipe_number > 5) return -1; // invalid pipe number
   uint8_t dynpd_register = 0;
   if (device == NULL) return -1;
   nrf24l01_read_register(device, DYNPD, &dynpd_register, 1);
 
-  device->data_pipe[pipe_number].nrf24l01_data_pipe_dyn_payload_length_enable = enable;
+  device->data_pipe[pipe_number].nrf24l01_data_pipe_dyn_payload_length_enable = enable != 0;
   if (enable){
     SET_BIT(dynpd_register, (1 << pipe_number));
   }
@@ -640,7 +866,7 @@ uint8_t nrf24l01_data_pipe_enable(nrf24l01_device * device, uint8_t pipe_number,
   if (device == NULL) return -1;
   nrf24l01_read_register(device, EN_RXADDR, &en_rxaddr_register, 1);
 
-  device->data_pipe[pipe_number].nrf24l01_data_pipe_enable = enable;
+  device->data_pipe[pipe_number].nrf24l01_data_pipe_enable = enable != 0;
 
   if (enable)
     SET_BIT(en_rxaddr_register, (1<< pipe_number));
@@ -658,7 +884,7 @@ uint8_t nrf24l01_data_pipe_auto_ack(nrf24l01_device * device, uint8_t pipe_numbe
   if (device == NULL) return -1;
   nrf24l01_read_register(device, EN_AA, &en_aa_register, 1);
 
-  device->data_pipe[pipe_number].nrf24l01_data_pipe_auto_ack = enable;
+  device->data_pipe[pipe_number].nrf24l01_data_pipe_auto_ack = enable != 0;
 
   if (enable)
     SET_BIT(en_aa_register, (1<< pipe_number));
@@ -676,19 +902,10 @@ uint8_t nrf24l01_data_pipe_address(nrf24l01_device * device, uint8_t pipe_number
   else if (length > 1 && length != device->address_width) return -1; // invalid address length
   if (device == NULL || address == NULL)  return  -1;
 
-  uint8_t *temp = NULL;
-  if (device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address != NULL){
-    temp = device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address;
-  }
-  // allocate new address array
-  device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address = (uint8_t*)malloc(length);
-  memcpy(device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address, address, length);
+  // address may point into the pipe itself (nrf24l01_init_data_pipe)
+  memmove(device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address, address, length);
   nrf24l01_write_register(device, RX_ADDR_P0 + pipe_number, device->data_pipe[pipe_number].nrf24l01_data_pipe_receive_address, length);
 
-  if (temp != NULL) {
-    free(temp);
-    temp = NULL;
-  }
   return 0;
 }
 
@@ -736,7 +953,7 @@ uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq
   if (device == NULL)  return -1;
   uint8_t status_register = 0, eraser = 0;
 
-  if (HAL_GPIO_ReadPin(NRF24L01_CE_GPIO_Port, NRF24L01_CE_Pin)){
+  if (nrf24l01_port_ce_read(device)){
     /* disable module before clearing inerruput flag */
     nrf24l01_chip_disable(device);
   }
@@ -759,3 +976,21 @@ uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq
 
   return status_register;
 }
+
+
+uint8_t nrf24l01_clear_interrupt_flags(nrf24l01_device * device, uint8_t flags){
+  if (device == NULL)  return -1;
+  uint8_t status_register = 0;
+
+  flags &= RX_DR | TX_DS | MAX_RT;
+  if (flags == 0) return -1; /* nothing to clear */
+
+  if (nrf24l01_port_ce_read(device)){
+    /* disable module before clearing inerruput flags */
+    nrf24l01_chip_disable(device);
+  }
+
+  status_register = nrf24l01_write_register(device, STATUS, &flags, 1);
+
+  return status_register;
+}
@@ -9,7 +9,8 @@
  * transceiver module. It supports all major features including multi-pipe communication,
  * auto-acknowledgment, dynamic payload lengths, and various power/data rate configurations.
  *
- * @note This driver is designed for STM32 microcontrollers using HAL library
+ * @note This driver is designed for STM32 microcontrollers using HAL library.
+ * Other targets plug in through the port layer, see nrf24l01_port.h.
  *
  * @par Example Usage:
  * @code
@@ -17,9 +18,9 @@
  * nrf24l01_device nrf = nrf24l01_get_default_config();
  * nrf.spi = &hspi1;
  * nrf.ce_port = GPIOA;
- * nrf.ce_pin = 8;
+ * nrf.ce_pin = GPIO_PIN_8;
  * nrf.csn_port = GPIOA;
- * nrf.csn_pin = 9;
+ * nrf.csn_pin = GPIO_PIN_9;
  *
  * // Initialize the device
  * if (nrf24l01_init(&nrf) == 0) {
@@ -41,8 +42,11 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include "main.h"
-#include "stm32f1xx_hal.h"
+#include "nrf24l01_port.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /**
  * @defgroup NRF24L01_MACROS Macros and Constants
@@ -53,6 +57,16 @@
 /** @brief Empty data placeholder for uninitialized pointers */
 #define EMPTY_DATA   (uint8_t *)0xFF
 
+#ifndef SET_BIT
+#define SET_BIT(REG, BIT)     ((REG) |= (BIT))
+#endif
+#ifndef CLEAR_BIT
+#define CLEAR_BIT(REG, BIT)   ((REG) &= ~(BIT))
+#endif
+
+/** @brief SPI frame buffer: command byte plus the largest payload */
+#define NRF24L01_SPI_BUFFER_SIZE   33
+
 /** @} */ // End of NRF24L01_MACROS group
 
 /**
@@ -192,8 +206,63 @@
 #define EN_ACK_PAY    0b00000010  /**< Enable Payload with ACK */
 #define EN_DYN_ACK    0b00000001  /**< Enable the W_TX_PAYLOAD_NOACK command */
 
+/* RF_CH and RX_PW_Px register fields (the register names are taken by the addresses) */
+#define RF_CH_FIELD   0b01111111  /**< RF channel frequency */
+#define RX_PW_FIELD   0b00111111  /**< Number of bytes in RX payload */
+
 /** @} */ // End of NRF24L01_BITMASKS group
 
+/**
+ * @defgroup NRF24L01_FIELDS Register Field Access
+ * @brief Read and write multi-bit fields by their mask
+ *
+ * The shift is derived from the mask at compile time, so with a constant
+ * mask NRF24L01_FIELD_GET() is one AND and one shift, and
+ * NRF24L01_FIELD_PREP() one shift and one AND. NRF24L01_FIELD_CONST()
+ * additionally refuses to compile when a constant value does not fit.
+ * @code
+ * uint8_t setup_retr = NRF24L01_FIELD_PREP(ARD, delay) | NRF24L01_FIELD_PREP(ARC, count);
+ * uint8_t lost = NRF24L01_FIELD_GET(PLOS_CNT, observe_tx);
+ * @endcode
+ * @{
+ */
+
+/** @brief Lowest set bit of a field mask */
+#define NRF24L01_FIELD_LSB(mask)              ((mask) & -(mask))
+/** @brief Largest value a field holds */
+#define NRF24L01_FIELD_MAX(mask)              ((mask) / NRF24L01_FIELD_LSB(mask))
+/** @brief Extract a field from a register value */
+#define NRF24L01_FIELD_GET(mask, reg)         ((uint8_t)(((reg) & (mask)) / NRF24L01_FIELD_LSB(mask)))
+/** @brief Shift a value into field position, bits outside the field are dropped */
+#define NRF24L01_FIELD_PREP(mask, value)      ((uint8_t)(((value) * NRF24L01_FIELD_LSB(mask)) & (mask)))
+/** @brief Register value with one field replaced */
+#define NRF24L01_FIELD_SET(mask, reg, value)  ((uint8_t)(((reg) & ~(mask)) | NRF24L01_FIELD_PREP(mask, value)))
+/** @brief NRF24L01_FIELD_PREP() for constants, breaks the build when value does not fit */
+#define NRF24L01_FIELD_CONST(mask, value) \
+    ((uint8_t)(0 * sizeof(char[(value) <= NRF24L01_FIELD_MAX(mask) ? 1 : -1]) + NRF24L01_FIELD_PREP(mask, value)))
+
+/**
+ * @brief STATUS register split into its fields
+ */
+typedef struct{
+    uint8_t pipe;                         /**< RX_P_NO: pipe of the payload at the RX FIFO head, 7 when empty */
+    uint8_t irq;                          /**< RX_DR, TX_DS and MAX_RT as set in STATUS */
+    uint8_t tx_full;                      /**< TX_FULL */
+} nrf24l01_status;
+
+/**
+ * @brief Decode a STATUS value, as returned by every SPI transaction
+ * @param status STATUS register value
+ * @return Pipe number, interrupt flags and TX FIFO full flag
+ */
+static inline nrf24l01_status nrf24l01_status_decode(uint8_t status){
+  nrf24l01_status decoded = {NRF24L01_FIELD_GET(RX_P_NO, status), (uint8_t)(status & (RX_DR | TX_DS | MAX_RT)),
+                             (uint8_t)(status & TX_FULL)};
+  return decoded;
+}
+
+/** @} */ // End of NRF24L01_FIELDS group
+
 /**
  * @defgroup NRF24L01_COMMANDS SPI Commands
  * @brief Command definitions for SPI communication
@@ -292,6 +361,15 @@ typedef enum{
     nrf24l01_auto_retransmit_count_15,            /**< Up to 15 retransmits */
 } nrf24l01_auto_retransmit_count;
 
+/**
+ * @brief CRC length settings
+ */
+typedef enum{
+    nrf24l01_crc_disabled = 0,           /**< No CRC (only allowed with auto-ack off on all pipes) */
+    nrf24l01_crc_1byte,                  /**< 1 byte CRC */
+    nrf24l01_crc_2bytes,                 /**< 2 bytes CRC */
+} nrf24l01_crc_length;
+
 /**
  * @brief Interrupt types
  */
@@ -311,40 +389,109 @@ typedef enum{
 
 /**
  * @brief Data pipe configuration structure
+ *
+ * Pipes 0 and 1 use the whole address, pipes 2 to 5 only the first byte
+ * (the rest is shared with pipe 1). The flags are single bits, like their
+ * EN_RXADDR, EN_AA and DYNPD counterparts.
  */
 typedef struct{
-    uint8_t nrf24l01_data_pipe_enable;                    /**< Enable/disable data pipe */
-    uint8_t nrf24l01_data_pipe_dyn_payload_length_enable; /**< Enable dynamic payload length */
-    uint8_t nrf24l01_data_pipe_auto_ack;                  /**< Enable auto acknowledgment */
-    uint8_t* nrf24l01_data_pipe_receive_address;          /**< Receive address for this pipe */
+    uint8_t nrf24l01_data_pipe_receive_address[5];        /**< Receive address for this pipe, LSB first */
     uint8_t nrf24l01_data_pipe_payload_width;             /**< Static payload width (if dynamic disabled) */
-    uint8_t* nrf24l01_data_pipe_payload;                  /**< Payload data buffer */
+    uint8_t nrf24l01_data_pipe_enable : 1;                /**< Enable/disable data pipe (EN_RXADDR) */
+    uint8_t nrf24l01_data_pipe_auto_ack : 1;              /**< Enable auto acknowledgment (EN_AA) */
+    uint8_t nrf24l01_data_pipe_dyn_payload_length_enable : 1; /**< Enable dynamic payload length (DYNPD) */
 } nrf24l01_data_pipe;
 
 /**
  * @brief Main nRF24L01 device configuration structure
+ *
+ * Fully self-contained: addresses are stored inline and nothing is
+ * allocated, so a device can live in a static, on the stack or in an
+ * array. Enumerated settings are stored in bit-fields sized to their
+ * register field and are read and assigned like the enum itself.
  */
 typedef struct{
-    SPI_HandleTypeDef * spi;                         /**< SPI handle for communication */
-    GPIO_TypeDef *irq_port, *ce_port, *csn_port;    /**< GPIO ports for control pins */
-    uint8_t irq_pin, ce_pin, csn_pin;               /**< GPIO pin numbers */
-    TIM_HandleTypeDef * timer;                       /**< Timer handle for microsecond delays */
-    uint8_t power_up;                                /**< Power state (0=down, 1=up) */
-    uint8_t primary_rx;                              /**< Primary mode (0=TX, 1=RX) */
-    nrf24l01_address_width address_width;            /**< Address width configuration */
-    nrf24l01_auto_retransmit_delay auto_retransmit_delay; /**< Auto retransmit delay */
-    nrf24l01_auto_retransmit_count auto_retransmit_count; /**< Auto retransmit count */
+    NRF24L01_PORT_DEVICE_FIELDS                      /* bus, pins and timer of the selected port */
     uint8_t frequency_channel;                       /**< RF frequency channel (0-125) */
-    nrf24l01_air_data_rate air_data_rate;           /**< Air data rate setting */
-    nrf24l01_rf_output_power rf_output_power;        /**< RF output power level */
-    uint8_t setup_lna_gain;                          /**< LNA gain setting */
+    uint8_t transmit_address[5];                     /**< Transmit address, LSB first */
+    uint8_t address_width : 3;                       /**< Address width configuration (nrf24l01_address_width) */
+    uint8_t rf_output_power : 2;                     /**< RF output power level (nrf24l01_rf_output_power) */
+    uint8_t air_data_rate : 1;                       /**< Air data rate setting (nrf24l01_air_data_rate) */
+    uint8_t crc_length : 2;                          /**< CRC length (nrf24l01_crc_length) */
+    uint8_t auto_retransmit_delay : 4;               /**< Auto retransmit delay (nrf24l01_auto_retransmit_delay) */
+    uint8_t auto_retransmit_count : 4;               /**< Auto retransmit count (nrf24l01_auto_retransmit_count) */
+    uint8_t power_up : 1;                            /**< Power state (0=down, 1=up) */
+    uint8_t primary_rx : 1;                          /**< Primary mode (0=TX, 1=RX) */
+    uint8_t setup_lna_gain : 1;                      /**< LNA gain setting */
+    uint8_t dynamic_payload_length_enable : 1;       /**< Global dynamic payload enable */
+    uint8_t payload_with_ack_enable : 1;             /**< Payload with ACK enable */
+    uint8_t dynamic_ack_enable : 1;                  /**< Dynamic ACK enable */
     nrf24l01_data_pipe data_pipe[6];                 /**< Configuration for all 6 data pipes */
-    uint8_t* transmit_address;                       /**< Transmit address */
-    uint8_t dynamic_payload_length_enable;           /**< Global dynamic payload enable */
-    uint8_t payload_with_ack_enable;                 /**< Payload with ACK enable */
-    uint8_t dynamic_ack_enable;                      /**< Dynamic ACK enable */
 } nrf24l01_device;
 
+/**
+ * @brief Upper bound of sizeof(nrf24l01_device), checked at compile time
+ *
+ * The port fields plus 60 bytes of configuration. With the STM32 HAL port
+ * that is 86 bytes on a 32-bit MCU, where the structure takes 80.
+ */
+#ifndef NRF24L01_DEVICE_SIZE_BUDGET
+#define NRF24L01_DEVICE_SIZE_BUDGET   (NRF24L01_PORT_DEVICE_SIZE + 60)
+#endif
+
+/**
+ * @brief Shadow copy of every writable configuration register
+ *
+ * Holds the values nrf24l01_init() would write, so a configuration can be
+ * stored, compared or streamed to the chip without going through the device
+ * structure.
+ */
+typedef struct{
+    uint8_t config;                                  /**< CONFIG */
+    uint8_t en_aa;                                   /**< EN_AA */
+    uint8_t en_rxaddr;                               /**< EN_RXADDR */
+    uint8_t setup_aw;                                /**< SETUP_AW */
+    uint8_t setup_retr;                              /**< SETUP_RETR */
+    uint8_t rf_ch;                                   /**< RF_CH */
+    uint8_t rf_setup;                                /**< RF_SETUP */
+    uint8_t rx_addr_p0[5];                           /**< RX_ADDR_P0, LSB first */
+    uint8_t rx_addr_p1[5];                           /**< RX_ADDR_P1, LSB first */
+    uint8_t rx_addr_p2_p5[4];                        /**< RX_ADDR_P2 to RX_ADDR_P5 */
+    uint8_t tx_addr[5];                              /**< TX_ADDR, LSB first */
+    uint8_t rx_pw[6];                                /**< RX_PW_P0 to RX_PW_P5 */
+    uint8_t dynpd;                                   /**< DYNPD */
+    uint8_t feature;                                 /**< FEATURE */
+} nrf24l01_register_image;
+
+/**
+ * @brief Events reported to a state observer
+ */
+typedef enum {
+    nrf24l01_observe_ce = 0,              /**< CE driven, value is the level */
+    nrf24l01_observe_config,              /**< CONFIG written, value is the register */
+    nrf24l01_observe_rf_setup,            /**< RF_SETUP written, value is the register */
+    nrf24l01_observe_tx_payload,          /**< Payload written with W_TX_PAYLOAD, value is its length */
+    nrf24l01_observe_tx_payload_no_ack,   /**< Payload written with W_TX_PAYLOAD_NOACK, value is its length */
+    nrf24l01_observe_rx_payload,          /**< Payload read, value is its length */
+    nrf24l01_observe_ack_payload,         /**< Payload written with W_ACK_PAYLOAD (PRX), value is its length */
+} nrf24l01_observe_event;
+
+/**
+ * @brief Optional state observer
+ *
+ * Every state change of the chip passes through the core: CE edges,
+ * CONFIG writes (power up and down, PRX/PTX) and RF_SETUP writes, plus
+ * the payloads moved. Building with -DNRF24L01_OBSERVER=function, e.g.
+ * nrf24l01_energy_observe, has the core report them to that function;
+ * without it the calls compile to nothing.
+ */
+#ifdef NRF24L01_OBSERVER
+void NRF24L01_OBSERVER(nrf24l01_device * device, nrf24l01_observe_event event, uint8_t value);
+#define NRF24L01_OBSERVE(device, event, value)   NRF24L01_OBSERVER((device), (event), (value))
+#else
+#define NRF24L01_OBSERVE(device, event, value)   ((void)0)
+#endif
+
 /** @} */ // End of NRF24L01_STRUCTS group
 
 /**
@@ -370,6 +517,7 @@ typedef struct{
  * - 1 Mbps data rate
  * - 0 dBm output power
  * - Auto retransmit: 250µs delay, 3 retries
+ * - 1-byte CRC (chip reset value)
  */
 nrf24l01_device nrf24l01_get_default_config();
 
@@ -390,7 +538,9 @@ uint8_t nrf24l01_init(nrf24l01_device * device);
  * @brief Deinitialize nRF24L01 device
  * @param device Pointer to device configuration structure
  *
- * Powers down the device and resets control pins to safe states.
+ * Powers down the device and resets control pins to safe states
+ * (CE low, CSN high). The device holds no allocated memory, so the
+ * structure can be reused or discarded afterwards.
  */
 void nrf24l01_deinit(nrf24l01_device * device);
 
@@ -405,6 +555,53 @@ void nrf24l01_deinit(nrf24l01_device * device);
  */
 uint8_t nrf24l01_init_data_pipe(nrf24l01_device * device, uint8_t pipe_number);
 
+/**
+ * @brief Compute the register values for a device configuration
+ * @param device Pointer to device configuration structure
+ * @param image Pointer to register image to fill
+ * @return 0 on success, non-zero on error
+ *
+ * Does not access the chip. Interrupt sources are left unmasked.
+ */
+uint8_t nrf24l01_build_register_image(nrf24l01_device * device, nrf24l01_register_image * image);
+
+/**
+ * @brief Write a complete register image to the chip
+ * @param device Pointer to device configuration structure
+ * @param image Pointer to register image
+ * @return 0 on success, non-zero on error
+ *
+ * Every register is written once without reading it first. CE is held low
+ * during the writes and restored afterwards. The power-up settling time is
+ * not waited for.
+ */
+uint8_t nrf24l01_write_register_image(nrf24l01_device * device, const nrf24l01_register_image * image);
+
+/**
+ * @brief Make the cached configuration of a device follow a register image
+ * @param device Pointer to device configuration structure
+ * @param image Pointer to register image
+ * @return 0 on success, non-zero on error
+ *
+ * Does not access the chip; used after an image that was not built from
+ * the device has been written. Covers every field the image holds,
+ * addresses included, to the address width of the image.
+ */
+uint8_t nrf24l01_load_register_image(nrf24l01_device * device, const nrf24l01_register_image * image);
+
+/**
+ * @brief Initialize nRF24L01 device from a register image
+ * @param device Pointer to device structure with SPI, GPIO and timer set
+ * @param image Pointer to register image, typically a constant in flash
+ * @return 0 on success, non-zero on error
+ *
+ * Replacement for nrf24l01_init() when the configuration is known at build
+ * time (see nrf24l01_static_config.h). Waits for the power on reset, streams
+ * the image and, when it sets PWR_UP, waits for the power-up settling time.
+ * Cached fields of the device structure follow the image.
+ */
+uint8_t nrf24l01_init_from_image(nrf24l01_device * device, const nrf24l01_register_image * image);
+
 /** @} */ // End of NRF24L01_INIT group
 
 /**
@@ -512,6 +709,34 @@ uint8_t nrf24l01_read_rx_payload(nrf24l01_device * device, uint8_t* data, uint16
  */
 uint8_t nrf24l01_write_tx_payload(nrf24l01_device * device, uint8_t* data , uint16_t length);
 
+/**
+ * @brief Read RX payload in place
+ * @param device Pointer to device configuration structure
+ * @param frame Buffer of length + 1 bytes; frame[0] is headroom, the payload lands at frame + 1
+ * @param length Number of payload bytes to read
+ * @return Status register value, also left in frame[0]
+ *
+ * Same transaction as nrf24l01_read_rx_payload() without its two staging
+ * buffers: the one SPI transfer reads and writes the frame itself.
+ */
+uint8_t nrf24l01_read_rx_frame(nrf24l01_device * device, uint8_t * frame, uint16_t length);
+
+/**
+ * @brief Write a payload from a frame with headroom, without copying it
+ * @param device Pointer to device configuration structure
+ * @param command W_TX_PAYLOAD, W_TX_PAYLOAD_NOACK or W_ACK_PAYLOAD | pipe
+ * @param frame Buffer of length + 1 bytes; frame[0] is headroom, the payload starts at frame + 1
+ * @param length Number of payload bytes to write
+ * @return Status register value
+ *
+ * The frame is only read, headroom included, so the same frame can be
+ * written to several radios, also at the same time from different
+ * tasks or interrupt handlers. Unlike nrf24l01_write_ack_payload() and
+ * nrf24l01_write_tx_payload_no_ack() the mode is not read back first:
+ * the caller knows the device is in the right one.
+ */
+uint8_t nrf24l01_write_tx_frame(nrf24l01_device * device, uint8_t command, const uint8_t * frame, uint16_t length);
+
 /**
  * @brief Write ACK payload for specific pipe
  * @param device Pointer to device configuration structure
@@ -708,6 +933,18 @@ uint8_t nrf24l01_payload_with_ack(nrf24l01_device * device, uint8_t enable);
  */
 uint8_t nrf24l01_dynamic_ack(nrf24l01_device * device, uint8_t enable);
 
+/**
+ * @brief Set CRC length
+ * @param device Pointer to device configuration structure
+ * @param crc CRC length
+ * @return Status register value
+ *
+ * Controls the EN_CRC and CRCO bits of the CONFIG register.
+ *
+ * @note The chip forces CRC on while auto-acknowledgment is enabled on any pipe
+ */
+uint8_t nrf24l01_crc(nrf24l01_device * device, nrf24l01_crc_length crc);
+
 /** @} */ // End of NRF24L01_FEATURE_CONTROL group
 
 /**
@@ -813,10 +1050,24 @@ uint8_t nrf24l01_interrupt(nrf24l01_device * device, nrf24l01_irq irq, uint8_t e
  */
 uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq);
 
+/**
+ * @brief Clear several interrupt flags at once
+ * @param device Pointer to device configuration structure
+ * @param flags Any combination of RX_DR, TX_DS and MAX_RT
+ * @return Status register value
+ *
+ * Clears all given flags with a single STATUS write.
+ */
+uint8_t nrf24l01_clear_interrupt_flags(nrf24l01_device * device, uint8_t flags);
+
 /** @} */ // End of NRF24L01_INTERRUPT_CONTROL group
 
 /** @} */ // End of NRF24L01_FUNCTIONS group
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif //NRF24L01_DRIVER_NRF24L01_H
 
 /**
@@ -850,11 +1101,11 @@ uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq
  * // Configure hardware connections
  * nrf.spi = &hspi1;          // SPI handle
  * nrf.ce_port = GPIOA;       // CE pin port
- * nrf.ce_pin = 8;            // CE pin number
+ * nrf.ce_pin = GPIO_PIN_8;   // CE pin
  * nrf.csn_port = GPIOA;      // CSN pin port
- * nrf.csn_pin = 9;           // CSN pin number
+ * nrf.csn_pin = GPIO_PIN_9;  // CSN pin
  * nrf.irq_port = GPIOA;      // IRQ pin port (optional)
- * nrf.irq_pin = 10;          // IRQ pin number (optional)
+ * nrf.irq_pin = GPIO_PIN_10; // IRQ pin (optional)
  * nrf.timer = &htim2;        // Timer for microsecond delays
  *
  * // Initialize the device
@@ -867,7 +1118,7 @@ uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq
  * @code
  * // Configure transmit address
  * uint8_t tx_address[] = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7};
- * nrf.transmit_address = tx_address;
+ * memcpy(nrf.transmit_address, tx_address, 5);
  * nrf24l01_write_register(&nrf, TX_ADDR, nrf.transmit_address, 5);
  *
  * // Configure data pipe 0 for auto-ack (must match TX address)
@@ -912,6 +1163,9 @@ uint8_t nrf24l01_clear_interrupt_flag(nrf24l01_device * device, nrf24l01_irq irq
  * status = nrf24l01_nop(&nrf);
  * }while(1);
  *
+ * // or, without polling, from the IRQ pin: see nrf24l01_events.h
+ * nrf24l01_process(&events);
+ *
  * @endcode
  *
  * @section config_sec Configuration Options
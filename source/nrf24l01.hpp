@@ -0,0 +1,337 @@
+/**
+ * @file nrf24l01.hpp
+ * @brief Header-only C++17 facade over the C driver
+ *
+ * Thin typed layer for C++ firmware, with no extra state and no virtual
+ * calls: members forward to the nrf24l01_* functions and are inlined.
+ * - Radio owns the nrf24l01_device (init on construction, deinit on destruction)
+ * - Span is a pointer and a length, taken wherever the C API wants both
+ * - Packet is a move-only buffer from a static PacketPool, so payloads are
+ *   read from and written to the SPI frame without temporary arrays
+ * - Scoped enums wrap the nrf24l01_* enums with the same values
+ *
+ * No exceptions and no heap: errors are the C return codes.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01::PacketPool<4> pool;
+ *
+ * nrf24l01_device config = nrf24l01_get_default_config();
+ * config.spi = &hspi1;
+ * // ... pins and timer
+ * nrf24l01::Radio radio(config);
+ *
+ * // typed setters only change the configuration, reinit() writes it
+ * radio.air_data_rate(nrf24l01::AirDataRate::mbps_2);
+ * radio.reinit();
+ *
+ * nrf24l01::Packet packet = pool.acquire();
+ * if (packet && radio.read(packet).rx_ready())
+ *     handle(packet.data());         // Span<const uint8_t>, no copy
+ *
+ * const uint8_t hello[] = "hello";
+ * radio.write(hello);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_HPP
+#define NRF24L01_DRIVER_NRF24L01_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include "nrf24l01.h"
+
+namespace nrf24l01 {
+
+/**
+ * @defgroup NRF24L01_CPP C++ Facade
+ * @brief Typed wrappers around the C driver
+ * @{
+ */
+
+/** @brief Largest payload of the chip */
+constexpr std::size_t max_payload = 32;
+
+/** @brief Air data rate, see nrf24l01_air_data_rate */
+enum class AirDataRate : uint8_t {
+    mbps_1 = nrf24l01_air_data_rate_1mbps,
+    mbps_2 = nrf24l01_air_data_rate_2mbps,
+};
+
+/** @brief RF output power, see nrf24l01_rf_output_power */
+enum class OutputPower : uint8_t {
+    minus18dbm = nrf24l01_rf_output_power_minus18dbm,
+    minus12dbm = nrf24l01_rf_output_power_minus12dbm,
+    minus6dbm = nrf24l01_rf_output_power_minus6dbm,
+    dbm0 = nrf24l01_rf_output_power_0dbm,
+};
+
+/** @brief Address width, see nrf24l01_address_width */
+enum class AddressWidth : uint8_t {
+    bytes3 = nrf24l01_address_width_3bytes,
+    bytes4 = nrf24l01_address_width_4bytes,
+    bytes5 = nrf24l01_address_width_5bytes,
+};
+
+/** @brief CRC length, see nrf24l01_crc_length */
+enum class CrcLength : uint8_t {
+    disabled = nrf24l01_crc_disabled,
+    bytes1 = nrf24l01_crc_1byte,
+    bytes2 = nrf24l01_crc_2bytes,
+};
+
+/** @brief Interrupt source, see nrf24l01_irq */
+enum class Irq : uint8_t {
+    rx_data_ready = nrf24l01_irq_rx_data_ready,
+    tx_data_sent = nrf24l01_irq_tx_data_sent,
+    max_retransmits = nrf24l01_maximum_retransmitted,
+};
+
+/** @brief Underlying nrf24l01_* value of a scoped enum */
+template <typename E>
+constexpr std::underlying_type_t<E> to_c(E value) noexcept { return static_cast<std::underlying_type_t<E>>(value); }
+
+/**
+ * @brief Non-owning view of contiguous elements (std::span subset for C++17)
+ */
+template <typename T>
+class Span {
+public:
+    constexpr Span() noexcept = default;
+    constexpr Span(T * data, std::size_t size) noexcept : data_(data), size_(size) {}
+    template <std::size_t N>
+    constexpr Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+    /** @brief Read-only view of a mutable span */
+    template <typename U, typename = std::enable_if_t<std::is_same<const U, T>::value>>
+    constexpr Span(const Span<U> & other) noexcept : data_(other.data()), size_(other.size()) {}
+
+    constexpr T * data() const noexcept { return data_; }
+    constexpr std::size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T * begin() const noexcept { return data_; }
+    constexpr T * end() const noexcept { return data_ + size_; }
+    constexpr T & operator[](std::size_t index) const noexcept { return data_[index]; }
+    /** @brief View of count elements from offset, unchecked like std::span */
+    constexpr Span subspan(std::size_t offset, std::size_t count) const noexcept { return Span(data_ + offset, count); }
+    constexpr Span first(std::size_t count) const noexcept { return Span(data_, count); }
+
+private:
+    T * data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+/**
+ * @brief STATUS register returned by every SPI transaction
+ */
+class Status {
+public:
+    constexpr explicit Status(uint8_t value) noexcept : value_(value) {}
+
+    constexpr uint8_t raw() const noexcept { return value_; }
+    /** @brief 0xFF is both "no chip" on MISO and the C API error code */
+    constexpr bool error() const noexcept { return value_ == 0xFF; }
+    constexpr bool rx_ready() const noexcept { return !error() && (value_ & RX_DR); }
+    constexpr bool tx_sent() const noexcept { return !error() && (value_ & TX_DS); }
+    constexpr bool max_retransmits() const noexcept { return !error() && (value_ & MAX_RT); }
+    constexpr bool tx_full() const noexcept { return !error() && (value_ & TX_FULL); }
+    /** @brief Pipe of the payload at the head of the RX FIFO, 7 when empty */
+    constexpr uint8_t pipe() const noexcept { return NRF24L01_FIELD_GET(RX_P_NO, value_); }
+
+private:
+    uint8_t value_;
+};
+
+/**
+ * @brief Move-only payload buffer borrowed from a PacketPool
+ *
+ * Holds up to 32 bytes and returns its buffer to the pool when destroyed.
+ * An empty Packet (pool exhausted or moved from) converts to false.
+ */
+class Packet {
+public:
+    Packet() noexcept = default;
+    Packet(const Packet &) = delete;
+    Packet & operator=(const Packet &) = delete;
+    Packet(Packet && other) noexcept : used_(other.used_), buffer_(other.buffer_), slot_(other.slot_), length_(other.length_) {
+        other.used_ = nullptr;
+        other.buffer_ = nullptr;
+        other.length_ = 0;
+    }
+    Packet & operator=(Packet && other) noexcept {
+        if (this != &other) {
+            reset();
+            used_ = other.used_;
+            buffer_ = other.buffer_;
+            slot_ = other.slot_;
+            length_ = other.length_;
+            other.used_ = nullptr;
+            other.buffer_ = nullptr;
+            other.length_ = 0;
+        }
+        return *this;
+    }
+    ~Packet() { reset(); }
+
+    explicit operator bool() const noexcept { return buffer_ != nullptr; }
+
+    /** @brief Valid payload bytes */
+    Span<const uint8_t> data() const noexcept { return Span<const uint8_t>(buffer_, length_); }
+    /** @brief Whole buffer, to fill before resize() */
+    Span<uint8_t> buffer() noexcept { return Span<uint8_t>(buffer_, buffer_ ? max_payload : 0); }
+    uint8_t size() const noexcept { return length_; }
+    /** @brief Set the number of valid bytes, clamped to 32 */
+    void resize(uint8_t length) noexcept { length_ = length > max_payload ? max_payload : length; }
+
+    /** @brief Give the buffer back to its pool now */
+    void reset() noexcept {
+        if (used_ != nullptr) *used_ &= ~(1UL << slot_);
+        used_ = nullptr;
+        buffer_ = nullptr;
+        length_ = 0;
+    }
+
+private:
+    template <std::size_t> friend class PacketPool;
+    Packet(uint32_t * used, uint8_t * buffer, uint8_t slot) noexcept : used_(used), buffer_(buffer), slot_(slot) {}
+
+    uint32_t * used_ = nullptr;   // in-use mask of the owning pool
+    uint8_t * buffer_ = nullptr;
+    uint8_t slot_ = 0;
+    uint8_t length_ = 0;
+};
+
+/**
+ * @brief Fixed set of packet buffers in static storage
+ * @tparam N Number of buffers (1-32)
+ *
+ * Not thread safe; acquire and release from one context, or guard them.
+ */
+template <std::size_t N>
+class PacketPool {
+    static_assert(N >= 1 && N <= 32, "PacketPool holds 1 to 32 buffers");
+
+public:
+    PacketPool() noexcept = default;
+    PacketPool(const PacketPool &) = delete;
+    PacketPool & operator=(const PacketPool &) = delete;
+
+    /** @brief Borrow a buffer, empty Packet when all are in use */
+    Packet acquire() noexcept {
+        for (std::size_t i = 0; i < N; i++) {
+            if (!(used_ & (1UL << i))) {
+                used_ |= 1UL << i;
+                return Packet(&used_, buffers_[i], static_cast<uint8_t>(i));
+            }
+        }
+        return Packet();
+    }
+
+    /** @brief Buffers currently free */
+    std::size_t available() const noexcept {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < N; i++)
+            if (!(used_ & (1UL << i))) count++;
+        return count;
+    }
+
+private:
+    uint8_t buffers_[N][max_payload] = {};
+    uint32_t used_ = 0;
+};
+
+/**
+ * @brief RAII owner of one nRF24L01
+ *
+ * Not copyable or movable: interrupt handlers and optional modules keep
+ * pointers to the device.
+ */
+class Radio {
+public:
+    /** @brief Copy the configuration and run nrf24l01_init(), see init_status() */
+    explicit Radio(const nrf24l01_device & config) noexcept : device_(config), init_status_(nrf24l01_init(&device_)) {}
+    ~Radio() { nrf24l01_deinit(&device_); }
+    Radio(const Radio &) = delete;
+    Radio & operator=(const Radio &) = delete;
+
+    /** @brief Return value of nrf24l01_init(), 0 on success */
+    uint8_t init_status() const noexcept { return init_status_; }
+    /** @brief Underlying device for the C API and optional modules */
+    nrf24l01_device * device() noexcept { return &device_; }
+
+    Status write(Span<const uint8_t> payload) noexcept {
+        return Status(nrf24l01_write_tx_payload(&device_, const_cast<uint8_t *>(payload.data()), payload.size()));
+    }
+    Status write(const Packet & packet) noexcept { return write(packet.data()); }
+    Status write_no_ack(Span<const uint8_t> payload) noexcept {
+        return Status(nrf24l01_write_tx_payload_no_ack(&device_, const_cast<uint8_t *>(payload.data()), payload.size()));
+    }
+    Status write_ack(uint8_t pipe, Span<const uint8_t> payload) noexcept {
+        return Status(nrf24l01_write_ack_payload(&device_, const_cast<uint8_t *>(payload.data()), pipe, payload.size()));
+    }
+
+    /** @brief Read a payload of payload.size() bytes straight into payload */
+    Status read(Span<uint8_t> payload) noexcept {
+        return Status(nrf24l01_read_rx_payload(&device_, payload.data(), payload.size()));
+    }
+    /**
+     * @brief Read the next payload into a pool buffer
+     *
+     * With dynamic payload length the width comes from R_RX_PL_WID (a bad
+     * width flushes the RX FIFO), otherwise from the pipe's static width.
+     */
+    Status read(Packet & packet) noexcept {
+        Status status = nop();
+        if (!packet || status.pipe() > 5) return status;
+        uint8_t width = device_.data_pipe[status.pipe()].nrf24l01_data_pipe_payload_width;
+        if (device_.dynamic_payload_length_enable) {
+            nrf24l01_read_rx_payload_width(&device_, &width);
+            if (width < 1 || width > max_payload) return Status(nrf24l01_flush_rx(&device_));
+        }
+        packet.resize(width);
+        return Status(nrf24l01_read_rx_payload(&device_, packet.buffer().data(), width));
+    }
+
+    Status nop() noexcept { return Status(nrf24l01_nop(&device_)); }
+    Status flush_tx() noexcept { return Status(nrf24l01_flush_tx(&device_)); }
+    Status flush_rx() noexcept { return Status(nrf24l01_flush_rx(&device_)); }
+    uint8_t transmit() noexcept { return nrf24l01_transmit(&device_); }
+    uint8_t listen() noexcept { return nrf24l01_listen(&device_); }
+    uint8_t power_up() noexcept { return nrf24l01_power_up(&device_); }
+    uint8_t power_down() noexcept { return nrf24l01_power_down(&device_); }
+
+    /** @brief Pipe 0/1 take a full-width address, pipes 2-5 a single byte */
+    uint8_t pipe_address(uint8_t pipe, Span<const uint8_t> address) noexcept {
+        return nrf24l01_data_pipe_address(&device_, pipe, const_cast<uint8_t *>(address.data()), address.size());
+    }
+    uint8_t crc(CrcLength length) noexcept {
+        return nrf24l01_crc(&device_, static_cast<nrf24l01_crc_length>(to_c(length)));
+    }
+    uint8_t interrupt(Irq irq, bool enable) noexcept {
+        return nrf24l01_interrupt(&device_, static_cast<nrf24l01_irq>(to_c(irq)), enable);
+    }
+    uint8_t clear_interrupts(uint8_t flags = RX_DR | TX_DS | MAX_RT) noexcept {
+        return nrf24l01_clear_interrupt_flags(&device_, flags);
+    }
+
+    /**
+     * @brief Typed configuration of the device structure
+     *
+     * The chip keeps its settings until reinit() runs nrf24l01_init().
+     */
+    void air_data_rate(AirDataRate rate) noexcept { device_.air_data_rate = to_c(rate); }
+    void output_power(OutputPower power) noexcept { device_.rf_output_power = to_c(power); }
+    void address_width(AddressWidth width) noexcept { device_.address_width = to_c(width); }
+    uint8_t reinit() noexcept { return init_status_ = nrf24l01_init(&device_); }
+
+private:
+    nrf24l01_device device_;
+    uint8_t init_status_;
+};
+
+/** @} */ // End of NRF24L01_CPP group
+
+} // namespace nrf24l01
+
+#endif //NRF24L01_DRIVER_NRF24L01_HPP
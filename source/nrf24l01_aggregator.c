@@ -0,0 +1,99 @@
+#include "nrf24l01_aggregator.h"
+
+uint8_t nrf24l01_aggregator_init(nrf24l01_aggregator * aggregator, nrf24l01_device * device,
+                                 uint8_t flush_threshold, uint32_t max_latency){
+  if (aggregator == NULL || device == NULL) return -1;
+  if (flush_threshold < 2 || flush_threshold > 32) return -1; // invalid threshold
+
+  memset(aggregator, 0, sizeof(nrf24l01_aggregator));
+  aggregator->device = device;
+  aggregator->flush_threshold = flush_threshold;
+  aggregator->max_latency = max_latency;
+  return 0;
+}
+
+uint8_t nrf24l01_aggregator_enable_dpl(nrf24l01_device * device, uint8_t pipe_number){
+  if (device == NULL) return -1;
+  if (pipe_number > 5) return -1; // invalid pipe number
+
+  nrf24l01_dynamic_payload_length(device, 1);
+  device->dynamic_payload_length_enable = 1;
+  return nrf24l01_data_pipe_dynamic_payload_length(device, pipe_number, 1);
+}
+
+uint8_t nrf24l01_aggregator_flush(nrf24l01_aggregator * aggregator){
+  if (aggregator == NULL || aggregator->length == 0) return 0;
+  // a payload written into a full FIFO is lost, keep the frame for later
+  if (nrf24l01_nop(aggregator->device) & TX_FULL) return 0;
+
+  nrf24l01_write_tx_payload(aggregator->device, aggregator->frame, aggregator->length);
+  aggregator->length = 0;
+  aggregator->frames++;
+  return 1;
+}
+
+uint8_t nrf24l01_aggregator_send(nrf24l01_aggregator * aggregator, uint8_t * data, uint8_t length){
+  uint8_t flushed = 0;
+  if (aggregator == NULL || data == NULL) return -1;
+  if (length < 1 || length > NRF24L01_AGGREGATOR_MAX_MESSAGE) return -1; // invalid message length
+
+  // message does not fit the current frame
+  if (aggregator->length + 1 + length > 32){
+    flushed += nrf24l01_aggregator_flush(aggregator);
+    if (aggregator->length > 0) return -1; // TX FIFO full
+  }
+
+  if (aggregator->length == 0)
+    aggregator->first_message_tick = nrf24l01_port_millis(aggregator->device);
+
+  aggregator->frame[aggregator->length] = length;
+  memcpy(aggregator->frame + aggregator->length + 1, data, length);
+  aggregator->length += 1 + length;
+  aggregator->messages++;
+
+  if (aggregator->length >= aggregator->flush_threshold)
+    flushed += nrf24l01_aggregator_flush(aggregator);
+
+  return flushed;
+}
+
+uint8_t nrf24l01_aggregator_poll(nrf24l01_aggregator * aggregator){
+  if (aggregator == NULL || aggregator->length == 0) return 0;
+  if (nrf24l01_port_millis(aggregator->device) - aggregator->first_message_tick < aggregator->max_latency) return 0;
+
+  return nrf24l01_aggregator_flush(aggregator);
+}
+
+uint8_t nrf24l01_aggregator_unpack(uint8_t * frame, uint8_t length, nrf24l01_aggregator_handler handler, void * context){
+  uint8_t messages = 0, offset = 0;
+  if (frame == NULL || handler == NULL) return -1;
+
+  while (offset < length){
+    uint8_t message_length = frame[offset];
+    if (message_length == 0) break; // end of frame
+    if (offset + 1 + message_length > length) return -1; // truncated message
+
+    handler(frame + offset + 1, message_length, context);
+    offset += 1 + message_length;
+    messages++;
+  }
+
+  return messages;
+}
+
+uint8_t nrf24l01_aggregator_receive(nrf24l01_device * device, nrf24l01_aggregator_handler handler, void * context){
+  uint8_t width = 0;
+  uint8_t frame[32];
+  if (device == NULL) return -1;
+
+  nrf24l01_read_rx_payload_width(device, &width);
+  if (width < 1 || width > 32){
+    // corrupted width, the datasheet requires the RX FIFO to be flushed
+    nrf24l01_flush_rx(device);
+    return -1;
+  }
+
+  nrf24l01_read_rx_payload(device, frame, width);
+
+  return nrf24l01_aggregator_unpack(frame, width, handler, context);
+}
@@ -0,0 +1,150 @@
+/**
+ * @file nrf24l01_aggregator.h
+ * @brief Small-message aggregation into dynamic-length payloads
+ *
+ * Packs several short application messages into one dynamic-length payload
+ * (up to 32 bytes) so that preamble, address, PCF, CRC and the ACK round trip
+ * are paid once per frame instead of once per message.
+ *
+ * Frame layout, repeated until the end of the payload:
+ * @code
+ * +--------+----------------+--------+----------------+-----
+ * | length | message bytes  | length | message bytes  | ...
+ * +--------+----------------+--------+----------------+-----
+ * @endcode
+ * A length byte of 0 terminates the frame early. A single message can carry
+ * up to 31 bytes.
+ *
+ * A frame is flushed to the TX FIFO when it reaches the size threshold, when
+ * the next message does not fit, or when the oldest message in it has waited
+ * for the configured latency bound.
+ *
+ * @note Both ends must have dynamic payload length enabled on the used pipe,
+ * see nrf24l01_aggregator_enable_dpl().
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_aggregator aggregator;
+ * nrf24l01_aggregator_init(&aggregator, &nrf, 24, 10); // flush at 24 bytes or after 10 ms
+ *
+ * nrf24l01_aggregator_send(&aggregator, reading, 4);
+ * if (nrf24l01_aggregator_poll(&aggregator) > 0)
+ *     nrf24l01_transmit(&nrf);
+ *
+ * // receiver
+ * if (nrf24l01_nop(&nrf) & RX_DR)
+ *     nrf24l01_aggregator_receive(&nrf, on_message, NULL);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_AGGREGATOR_H
+#define NRF24L01_DRIVER_NRF24L01_AGGREGATOR_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_AGGREGATOR Message Aggregation
+ * @brief Length-prefixed packing of small messages into one payload
+ * @{
+ */
+
+/** @brief Largest message that fits a frame (32 bytes minus the length prefix) */
+#define NRF24L01_AGGREGATOR_MAX_MESSAGE   31
+
+/**
+ * @brief Handler called for every unpacked message
+ * @param data Pointer to message bytes (valid during the call only)
+ * @param length Message length
+ * @param context User context passed to the receive function
+ */
+typedef void (*nrf24l01_aggregator_handler)(uint8_t * data, uint8_t length, void * context);
+
+/**
+ * @brief Aggregator instance, one per device
+ */
+typedef struct {
+    nrf24l01_device * device;      /**< Radio used to send frames */
+    uint8_t frame[32];             /**< Frame under construction */
+    uint8_t length;                /**< Bytes used in frame */
+    uint8_t flush_threshold;       /**< Flush as soon as the frame holds this many bytes */
+    uint32_t max_latency;          /**< Longest time (ms) a message may wait in the frame */
+    uint32_t first_message_tick;   /**< Port tick (ms) of the oldest message in the frame */
+    uint32_t messages;             /**< Messages packed since init */
+    uint32_t frames;               /**< Frames written to the TX FIFO since init */
+} nrf24l01_aggregator;
+
+/**
+ * @brief Initialize an aggregator
+ * @param aggregator Pointer to aggregator instance
+ * @param device Pointer to an initialized PTX device
+ * @param flush_threshold Frame size (2-32) that triggers a flush
+ * @param max_latency Latency bound in ms
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_aggregator_init(nrf24l01_aggregator * aggregator, nrf24l01_device * device,
+                                 uint8_t flush_threshold, uint32_t max_latency);
+
+/**
+ * @brief Enable dynamic payload length for aggregated traffic
+ * @param device Pointer to device configuration structure
+ * @param pipe_number Data pipe carrying the frames (0-5)
+ * @return 0 on success, non-zero on error
+ *
+ * Sets EN_DPL in FEATURE and the pipe bit in DYNPD. Auto-acknowledgment must
+ * stay enabled on the pipe, this is a requirement of the chip.
+ */
+uint8_t nrf24l01_aggregator_enable_dpl(nrf24l01_device * device, uint8_t pipe_number);
+
+/**
+ * @brief Append a message to the current frame
+ * @param aggregator Pointer to aggregator instance
+ * @param data Pointer to message bytes
+ * @param length Message length (1-31)
+ * @return Number of frames written to the TX FIFO, 0xFF on error or when the
+ *         message is refused
+ *
+ * The current frame is flushed first if the message does not fit, and again
+ * afterwards if the frame reached the flush threshold. When the message
+ * does not fit and the TX FIFO is full, the frame is kept and the message
+ * refused; send it again once the FIFO has room.
+ */
+uint8_t nrf24l01_aggregator_send(nrf24l01_aggregator * aggregator, uint8_t * data, uint8_t length);
+
+/**
+ * @brief Flush the frame if its oldest message reached the latency bound
+ * @param aggregator Pointer to aggregator instance
+ * @return Number of frames written to the TX FIFO
+ */
+uint8_t nrf24l01_aggregator_poll(nrf24l01_aggregator * aggregator);
+
+/**
+ * @brief Write the current frame to the TX FIFO
+ * @param aggregator Pointer to aggregator instance
+ * @return Number of frames written to the TX FIFO, 0 when it is full and the frame is kept
+ */
+uint8_t nrf24l01_aggregator_flush(nrf24l01_aggregator * aggregator);
+
+/**
+ * @brief Split a received frame into messages
+ * @param frame Pointer to received payload
+ * @param length Payload length
+ * @param handler Function called for every message
+ * @param context User context passed to the handler
+ * @return Number of messages delivered, 0xFF if the frame is malformed
+ *
+ * Messages before a malformed entry are still delivered.
+ */
+uint8_t nrf24l01_aggregator_unpack(uint8_t * frame, uint8_t length, nrf24l01_aggregator_handler handler, void * context);
+
+/**
+ * @brief Read the top RX payload and unpack it
+ * @param device Pointer to device configuration structure
+ * @param handler Function called for every message
+ * @param context User context passed to the handler
+ * @return Number of messages delivered, 0xFF on error
+ */
+uint8_t nrf24l01_aggregator_receive(nrf24l01_device * device, nrf24l01_aggregator_handler handler, void * context);
+
+/** @} */ // End of NRF24L01_AGGREGATOR group
+
+#endif //NRF24L01_DRIVER_NRF24L01_AGGREGATOR_H
@@ -0,0 +1,264 @@
+#include "nrf24l01_bond.h"
+
+_Static_assert(NRF24L01_BOND_REORDER_DEPTH <= 32 && (NRF24L01_BOND_REORDER_DEPTH & (NRF24L01_BOND_REORDER_DEPTH - 1)) == 0,
+               "NRF24L01_BOND_REORDER_DEPTH must be a power of two up to 32");
+
+// STATUS is written with CE low, links keep listening or sending afterwards
+static void nrf24l01_bond_clear(nrf24l01_device * device, uint8_t flags){
+  uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+  nrf24l01_clear_interrupt_flags(device, flags);
+  if (chip_enabled) nrf24l01_chip_enable(device);
+}
+
+static void nrf24l01_bond_health(nrf24l01_bond_link * link, uint8_t delivered){
+  // moving average over roughly the last 8 frames
+  int16_t target = delivered ? 255 : 0;
+  link->health += (target - link->health) / 8;
+}
+
+static int8_t nrf24l01_bond_pick(nrf24l01_bond_tx * tx){
+  int8_t best = -1;
+  for (uint8_t n = 0; n < tx->link_count; n++){
+    uint8_t i = (tx->next_link + n) % tx->link_count;
+    nrf24l01_bond_link * link = &tx->link[i];
+    if (link->down || link->in_flight_count == 3) continue;
+    if (tx->mode == nrf24l01_bond_round_robin) return i;
+    if (best < 0 || link->in_flight_count < tx->link[best].in_flight_count ||
+        (link->in_flight_count == tx->link[best].in_flight_count && link->health > tx->link[best].health))
+      best = i;
+  }
+  return best;
+}
+
+static void nrf24l01_bond_pump(nrf24l01_bond_tx * tx){
+  while (tx->backlog_count){
+    int8_t i = nrf24l01_bond_pick(tx);
+    if (i < 0) return; // every link is full or down
+    nrf24l01_bond_link * link = &tx->link[i];
+    nrf24l01_bond_frame * frame = &tx->backlog[tx->backlog_head];
+
+    nrf24l01_write_tx_payload(link->device, frame->data, frame->length);
+    link->in_flight[link->in_flight_count++] = *frame;
+    tx->next_link = (i + 1) % tx->link_count;
+    tx->backlog_head = (tx->backlog_head + 1) % NRF24L01_BOND_RING_SIZE;
+    tx->backlog_count--;
+  }
+}
+
+// frames of a failed link go in front of the backlog, in their original order
+static void nrf24l01_bond_failover(nrf24l01_bond_tx * tx, nrf24l01_bond_link * link){
+  for (int8_t i = link->in_flight_count - 1; i >= 0; i--){
+    tx->backlog_head = (tx->backlog_head + NRF24L01_BOND_RING_SIZE - 1) % NRF24L01_BOND_RING_SIZE;
+    tx->backlog[tx->backlog_head] = link->in_flight[i];
+    tx->backlog_count++;
+    link->failovers++;
+  }
+  link->in_flight_count = 0;
+}
+
+uint8_t nrf24l01_bond_tx_init(nrf24l01_bond_tx * tx, nrf24l01_bond_mode mode){
+  if (tx == NULL) return -1;
+  if (mode != nrf24l01_bond_round_robin && mode != nrf24l01_bond_load_aware) return -1; // invalid mode
+  memset(tx, 0, sizeof(nrf24l01_bond_tx));
+  tx->mode = mode;
+  return 0;
+}
+
+uint8_t nrf24l01_bond_tx_add_link(nrf24l01_bond_tx * tx, nrf24l01_device * device){
+  if (tx == NULL || device == NULL) return -1;
+  if (tx->link_count == NRF24L01_BOND_MAX_LINKS) return -1; // bond full
+
+  nrf24l01_bond_link * link = &tx->link[tx->link_count];
+  memset(link, 0, sizeof(nrf24l01_bond_link));
+  link->device = device;
+  link->health = 255;
+  nrf24l01_flush_tx(device);
+  nrf24l01_chip_enable(device);
+  return tx->link_count++;
+}
+
+uint8_t nrf24l01_bond_send(nrf24l01_bond_tx * tx, const uint8_t * data, uint8_t length){
+  if (tx == NULL || data == NULL) return -1;
+  if (length < 1 || length > NRF24L01_BOND_PAYLOAD_SIZE) return -1; // invalid payload length
+  if (tx->link_count == 0) return -1; // no link
+  if (tx->backlog_count >= NRF24L01_BOND_BACKLOG) return -1; // backlog full
+
+  nrf24l01_bond_frame * frame = &tx->backlog[(tx->backlog_head + tx->backlog_count) % NRF24L01_BOND_RING_SIZE];
+  frame->data[0] = tx->sequence & 0xFF;
+  frame->data[1] = tx->sequence >> 8;
+  memcpy(frame->data + NRF24L01_BOND_HEADER_SIZE, data, length);
+  frame->length = length + NRF24L01_BOND_HEADER_SIZE;
+  tx->backlog_count++;
+  tx->sequence++;
+
+  nrf24l01_bond_pump(tx);
+  return 0;
+}
+
+uint8_t nrf24l01_bond_tx_service(nrf24l01_bond_tx * tx){
+  uint8_t acknowledged = 0;
+  if (tx == NULL || tx->link_count == 0) return 0;
+  uint32_t now = nrf24l01_port_millis(tx->link[0].device);
+
+  for (uint8_t i = 0; i < tx->link_count; i++){
+    nrf24l01_bond_link * link = &tx->link[i];
+    uint8_t fifo_status_register = 0, completed = 0;
+
+    if (link->down){
+      if (now - link->down_tick < NRF24L01_BOND_PROBE_INTERVAL) continue;
+      link->down = 0; // on probation: one more bad run takes it out again
+      link->health = NRF24L01_BOND_HEALTH_MIN;
+    }
+
+    uint8_t status_register = nrf24l01_nop(link->device);
+    nrf24l01_read_register(link->device, FIFO_STATUS, &fifo_status_register, 1);
+
+    if (status_register & MAX_RT){
+      // the head frame ran out of retries, the chip holds everything behind it
+      link->failed++;
+      nrf24l01_bond_health(link, 0);
+      nrf24l01_flush_tx(link->device);
+      nrf24l01_bond_failover(tx, link);
+      if (link->health < NRF24L01_BOND_HEALTH_MIN){
+        link->down = 1;
+        link->down_tick = now;
+      }
+    }
+    else {
+      // the FIFO does not tell how many frames are left, only empty or full
+      if (fifo_status_register & TX_EMPTY)
+        completed = link->in_flight_count;
+      else if (link->in_flight_count && ((status_register & TX_DS) || (link->in_flight_count == 3 && !(fifo_status_register & FIFO_FULL))))
+        completed = 1;
+
+      link->in_flight_count -= completed;
+      memmove(link->in_flight, link->in_flight + completed, sizeof(nrf24l01_bond_frame) * link->in_flight_count);
+      link->sent += completed;
+      acknowledged += completed;
+      for (uint8_t n = 0; n < completed; n++) nrf24l01_bond_health(link, 1);
+    }
+
+    if (status_register & (TX_DS | MAX_RT)) nrf24l01_bond_clear(link->device, status_register & (TX_DS | MAX_RT));
+  }
+
+  nrf24l01_bond_pump(tx);
+  return acknowledged;
+}
+
+uint8_t nrf24l01_bond_rx_init(nrf24l01_bond_rx * rx){
+  if (rx == NULL) return -1;
+  memset(rx, 0, sizeof(nrf24l01_bond_rx));
+  return 0;
+}
+
+uint8_t nrf24l01_bond_rx_add_link(nrf24l01_bond_rx * rx, nrf24l01_device * device){
+  if (rx == NULL || device == NULL) return -1;
+  if (rx->device_count == NRF24L01_BOND_MAX_LINKS) return -1; // bond full
+  rx->device[rx->device_count] = device;
+  return rx->device_count++;
+}
+
+uint8_t nrf24l01_bond_rx_push(nrf24l01_bond_rx * rx, const uint8_t * frame, uint8_t length){
+  if (rx == NULL || frame == NULL) return -1;
+  if (length <= NRF24L01_BOND_HEADER_SIZE || length > 32) return -1; // invalid frame length
+
+  uint16_t sequence = frame[0] | (uint16_t)frame[1] << 8;
+  int16_t distance = (int16_t)(sequence - rx->next);
+
+  if (!rx->synced || distance < -NRF24L01_BOND_REORDER_DEPTH * 4){
+    // first frame, or the sender restarted its sequence
+    rx->present = 0;
+    rx->gap_open = 0;
+    rx->next = sequence;
+    rx->synced = 1;
+    distance = 0;
+  }
+  if (distance < 0){
+    rx->stats.duplicates++;
+    return -1;
+  }
+
+  while (distance >= NRF24L01_BOND_REORDER_DEPTH){
+    // window full: give up on missing frames, never on received ones
+    if (rx->present & (1UL << (rx->next & (NRF24L01_BOND_REORDER_DEPTH - 1)))){
+      rx->stats.overflows++;
+      return -1;
+    }
+    rx->next++;
+    rx->stats.lost++;
+    distance--;
+  }
+
+  uint8_t slot = sequence & (NRF24L01_BOND_REORDER_DEPTH - 1);
+  if (rx->present & (1UL << slot)){
+    rx->stats.duplicates++;
+    return -1;
+  }
+  memcpy(rx->slot[slot].data, frame, length);
+  rx->slot[slot].length = length;
+  rx->present |= 1UL << slot;
+  if (distance > 0) rx->stats.reordered++;
+  return 0;
+}
+
+uint8_t nrf24l01_bond_rx_poll(nrf24l01_bond_rx * rx){
+  uint8_t frame[32], received = 0;
+  if (rx == NULL) return 0;
+
+  for (uint8_t i = 0; i < rx->device_count; i++){
+    nrf24l01_device * device = rx->device[i];
+    uint8_t status_register = nrf24l01_nop(device);
+    if (!(status_register & RX_DR) && NRF24L01_FIELD_GET(RX_P_NO, status_register) > 5) continue;
+
+    while (NRF24L01_FIELD_GET(RX_P_NO, status_register) <= 5){
+      uint8_t length = 0;
+      nrf24l01_read_rx_payload_width(device, &length);
+      if (length < 1 || length > 32){
+        // corrupted length, the datasheet asks for a flush
+        nrf24l01_flush_rx(device);
+        break;
+      }
+      nrf24l01_read_rx_payload(device, frame, length);
+      nrf24l01_bond_rx_push(rx, frame, length);
+      received++;
+      status_register = nrf24l01_nop(device);
+    }
+    nrf24l01_bond_clear(device, RX_DR);
+  }
+  return received;
+}
+
+uint8_t nrf24l01_bond_read(nrf24l01_bond_rx * rx, uint8_t * data, uint8_t * length){
+  if (rx == NULL || data == NULL || length == NULL) return -1;
+  *length = 0;
+  if (!rx->synced) return -1;
+
+  for (;;){
+    uint8_t slot = rx->next & (NRF24L01_BOND_REORDER_DEPTH - 1);
+    if (rx->present & (1UL << slot)){
+      *length = rx->slot[slot].length - NRF24L01_BOND_HEADER_SIZE;
+      memcpy(data, rx->slot[slot].data + NRF24L01_BOND_HEADER_SIZE, *length);
+      rx->present &= ~(1UL << slot);
+      rx->next++;
+      rx->gap_open = 0;
+      rx->stats.delivered++;
+      return 0;
+    }
+    if (rx->present == 0){
+      rx->gap_open = 0;
+      return -1; // nothing buffered
+    }
+
+    // a later frame is here, the next one is missing
+    if (rx->device_count == 0) return -1; // no clock to time the gap
+    uint32_t now = nrf24l01_port_millis(rx->device[0]);
+    if (!rx->gap_open){
+      rx->gap_open = 1;
+      rx->gap_tick = now;
+    }
+    if (now - rx->gap_tick < NRF24L01_BOND_REORDER_TIMEOUT) return -1;
+    // timer keeps running, the rest of a burst of losses is skipped at once
+    rx->next++;
+    rx->stats.lost++;
+  }
+}
@@ -0,0 +1,253 @@
+/**
+ * @file nrf24l01_bond.h
+ * @brief Link aggregation: one stream striped over several radios on different channels
+ *
+ * The sender owns up to NRF24L01_BOND_MAX_LINKS PTX radios, each tuned to
+ * its own frequency_channel and paired with one PRX radio on the receiver.
+ * Every frame carries a 16-bit sequence number and goes to one link, so
+ * the links transmit in parallel and throughput adds up: with N radios on
+ * clean channels the stream moves N frames per air time slot.
+ *
+ * Links are picked round-robin, or load-aware: the link with the fewest
+ * frames in its TX FIFO, ties going to the healthier one. Each link keeps
+ * a copy of the frames it holds. On MAX_RT the frames are flushed and moved
+ * to the front of the backlog, from where they go out on the other links
+ * (fail over). A link whose delivery ratio falls under NRF24L01_BOND_HEALTH_MIN
+ * is taken out of rotation for NRF24L01_BOND_PROBE_INTERVAL ms and then
+ * tried again.
+ *
+ * The receiver puts frames back in order in a window of
+ * NRF24L01_BOND_REORDER_DEPTH frames. A missing frame holds delivery back
+ * for at most NRF24L01_BOND_REORDER_TIMEOUT ms, then it is counted as lost.
+ * Frames sent twice by a fail over are dropped.
+ *
+ * TX links run with CE held high, the radio sends as soon as a frame is in
+ * its FIFO; every link needs auto acknowledgment, RX links need dynamic
+ * payload length.
+ *
+ * @par Example Usage:
+ * @code
+ * // sender
+ * static nrf24l01_bond_tx tx;
+ * nrf24l01_bond_tx_init(&tx, nrf24l01_bond_load_aware);
+ * for (int i = 0; i < 3; i++) nrf24l01_bond_tx_add_link(&tx, &radio[i]);   // channels 10, 40, 70
+ *
+ * while (frame_ready())
+ *     if (nrf24l01_bond_send(&tx, chunk, NRF24L01_BOND_PAYLOAD_SIZE)) break;   // backlog full
+ * nrf24l01_bond_tx_service(&tx);
+ *
+ * // receiver
+ * static nrf24l01_bond_rx rx;
+ * nrf24l01_bond_rx_init(&rx);
+ * for (int i = 0; i < 3; i++) nrf24l01_bond_rx_add_link(&rx, &radio[i]);
+ *
+ * nrf24l01_bond_rx_poll(&rx);
+ * while (nrf24l01_bond_read(&rx, chunk, &length) == 0)
+ *     store(chunk, length);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_BOND_H
+#define NRF24L01_DRIVER_NRF24L01_BOND_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_BOND Link Aggregation
+ * @brief Striping, resequencing and fail over across several radios
+ * @{
+ */
+
+#ifndef NRF24L01_BOND_MAX_LINKS
+/** @brief Radios in one bond */
+#define NRF24L01_BOND_MAX_LINKS        4
+#endif
+
+#ifndef NRF24L01_BOND_BACKLOG
+/** @brief Frames waiting for a link on the sender */
+#define NRF24L01_BOND_BACKLOG          8
+#endif
+
+#ifndef NRF24L01_BOND_REORDER_DEPTH
+/** @brief Receiver reorder window in frames, power of two up to 32 */
+#define NRF24L01_BOND_REORDER_DEPTH    16
+#endif
+
+#ifndef NRF24L01_BOND_REORDER_TIMEOUT
+/** @brief Time in ms a missing frame may hold back delivery */
+#define NRF24L01_BOND_REORDER_TIMEOUT  20
+#endif
+
+#ifndef NRF24L01_BOND_PROBE_INTERVAL
+/** @brief Time in ms a degraded link stays out of rotation */
+#define NRF24L01_BOND_PROBE_INTERVAL   100
+#endif
+
+#ifndef NRF24L01_BOND_HEALTH_MIN
+/** @brief Delivery ratio (0-255) under which a link is taken out of rotation */
+#define NRF24L01_BOND_HEALTH_MIN       128
+#endif
+
+/** @brief Backlog ring: room for every frame in flight on top of NRF24L01_BOND_BACKLOG, so a fail over never drops */
+#define NRF24L01_BOND_RING_SIZE        (NRF24L01_BOND_BACKLOG + 3 * NRF24L01_BOND_MAX_LINKS)
+
+/** @brief Sequence number in front of every frame, LSB first */
+#define NRF24L01_BOND_HEADER_SIZE      2
+
+/** @brief Largest payload per frame */
+#define NRF24L01_BOND_PAYLOAD_SIZE     (32 - NRF24L01_BOND_HEADER_SIZE)
+
+/**
+ * @brief Link selection on the sender
+ */
+typedef enum {
+    nrf24l01_bond_round_robin = 0,         /**< Links in turn */
+    nrf24l01_bond_load_aware,              /**< Link with the fewest frames in flight */
+} nrf24l01_bond_mode;
+
+/**
+ * @brief One frame as sent over the air, sequence number first
+ */
+typedef struct {
+    uint8_t data[32];                      /**< Header and payload */
+    uint8_t length;                        /**< Frame length */
+} nrf24l01_bond_frame;
+
+/**
+ * @brief Sender side of one radio
+ */
+typedef struct {
+    nrf24l01_device * device;              /**< PTX radio */
+    nrf24l01_bond_frame in_flight[3];      /**< Frames in the TX FIFO, oldest first */
+    uint8_t in_flight_count;               /**< Number of valid entries in in_flight */
+    uint8_t health;                        /**< Moving delivery ratio, 255 = every frame acknowledged */
+    uint8_t down;                          /**< Out of rotation */
+    uint32_t down_tick;                    /**< Port tick (ms) the link went down */
+    uint32_t sent;                         /**< Frames acknowledged */
+    uint32_t failed;                       /**< MAX_RT events */
+    uint32_t failovers;                    /**< Frames moved to other links */
+} nrf24l01_bond_link;
+
+/**
+ * @brief Sender instance
+ */
+typedef struct {
+    nrf24l01_bond_link link[NRF24L01_BOND_MAX_LINKS];      /**< Links */
+    uint8_t link_count;                                     /**< Number of links */
+    uint8_t mode;                                           /**< One of nrf24l01_bond_mode */
+    uint8_t next_link;                                      /**< Round robin position */
+    uint16_t sequence;                                      /**< Sequence number of the next frame */
+    nrf24l01_bond_frame backlog[NRF24L01_BOND_RING_SIZE];  /**< Frames waiting for a link, ring */
+    uint8_t backlog_head;                                   /**< Oldest backlog entry */
+    uint8_t backlog_count;                                  /**< Number of backlog entries */
+} nrf24l01_bond_tx;
+
+/**
+ * @brief Receiver counters
+ */
+typedef struct {
+    uint32_t delivered;                    /**< Frames returned by nrf24l01_bond_read() */
+    uint32_t reordered;                    /**< Frames that arrived ahead of a missing one */
+    uint32_t duplicates;                   /**< Frames already received or already skipped */
+    uint32_t lost;                         /**< Sequence numbers skipped after the timeout */
+    uint32_t overflows;                    /**< Frames dropped because the window was full */
+} nrf24l01_bond_stats;
+
+/**
+ * @brief Receiver instance
+ */
+typedef struct {
+    nrf24l01_device * device[NRF24L01_BOND_MAX_LINKS];         /**< PRX radios */
+    uint8_t device_count;                                       /**< Number of radios */
+    nrf24l01_bond_frame slot[NRF24L01_BOND_REORDER_DEPTH];     /**< Window, indexed by sequence */
+    uint32_t present;                                           /**< Bit per occupied slot */
+    uint16_t next;                                              /**< Next sequence number to deliver */
+    uint8_t synced;                                             /**< next is valid */
+    uint8_t gap_open;                                           /**< Delivery waits for a missing frame */
+    uint32_t gap_tick;                                          /**< Port tick (ms) the wait started */
+    nrf24l01_bond_stats stats;                                  /**< Counters */
+} nrf24l01_bond_rx;
+
+/**
+ * @brief Initialize a sender
+ * @param tx Pointer to sender instance
+ * @param mode Link selection
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_bond_tx_init(nrf24l01_bond_tx * tx, nrf24l01_bond_mode mode);
+
+/**
+ * @brief Add a radio to the sender and raise its CE
+ * @param tx Pointer to sender instance
+ * @param device Pointer to an initialized PTX device with auto acknowledgment
+ * @return Link index, or -1 on error
+ */
+uint8_t nrf24l01_bond_tx_add_link(nrf24l01_bond_tx * tx, nrf24l01_device * device);
+
+/**
+ * @brief Queue one frame for the stream
+ * @param tx Pointer to sender instance
+ * @param data Pointer to payload data
+ * @param length Payload length (1 to NRF24L01_BOND_PAYLOAD_SIZE)
+ * @return 0 on success, non-zero when the backlog is full or on error
+ *
+ * The frame is written to a link at once when one has room, otherwise it
+ * waits in the backlog for nrf24l01_bond_tx_service().
+ */
+uint8_t nrf24l01_bond_send(nrf24l01_bond_tx * tx, const uint8_t * data, uint8_t length);
+
+/**
+ * @brief Account for finished frames, fail over and refill the links
+ * @param tx Pointer to sender instance
+ * @return Number of frames acknowledged since the last call
+ *
+ * Call from the main loop or when any TX radio raises its IRQ.
+ */
+uint8_t nrf24l01_bond_tx_service(nrf24l01_bond_tx * tx);
+
+/**
+ * @brief Initialize a receiver
+ * @param rx Pointer to receiver instance
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_bond_rx_init(nrf24l01_bond_rx * rx);
+
+/**
+ * @brief Add a radio to the receiver
+ * @param rx Pointer to receiver instance
+ * @param device Pointer to a listening PRX device with dynamic payload length
+ * @return Link index, or -1 on error
+ */
+uint8_t nrf24l01_bond_rx_add_link(nrf24l01_bond_rx * rx, nrf24l01_device * device);
+
+/**
+ * @brief Hand a received frame to the reorder window
+ * @param rx Pointer to receiver instance
+ * @param frame Frame as received, sequence number first
+ * @param length Frame length
+ * @return 0 when the frame was stored, non-zero when it was dropped
+ *
+ * nrf24l01_bond_rx_poll() calls it for every payload; call it directly when
+ * the application reads the radios itself.
+ */
+uint8_t nrf24l01_bond_rx_push(nrf24l01_bond_rx * rx, const uint8_t * frame, uint8_t length);
+
+/**
+ * @brief Read every RX FIFO into the reorder window
+ * @param rx Pointer to receiver instance
+ * @return Number of frames read
+ */
+uint8_t nrf24l01_bond_rx_poll(nrf24l01_bond_rx * rx);
+
+/**
+ * @brief Next frame of the stream, in order
+ * @param rx Pointer to receiver instance
+ * @param data Buffer of NRF24L01_BOND_PAYLOAD_SIZE bytes
+ * @param length Receives the payload length
+ * @return 0 when a frame was returned, non-zero when the stream has to wait
+ */
+uint8_t nrf24l01_bond_read(nrf24l01_bond_rx * rx, uint8_t * data, uint8_t * length);
+
+/** @} */ // End of NRF24L01_BOND group
+
+#endif //NRF24L01_DRIVER_NRF24L01_BOND_H
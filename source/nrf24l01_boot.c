@@ -0,0 +1,87 @@
+#include "nrf24l01_boot.h"
+
+uint8_t nrf24l01_boot_start(nrf24l01_boot * boot, nrf24l01_device * device, const nrf24l01_register_image * image, nrf24l01_boot_reset reset){
+  if (boot == NULL || device == NULL) return -1;
+  memset(boot, 0, sizeof(nrf24l01_boot));
+  boot->device = device;
+  boot->reset = reset;
+  if (image != NULL)
+    boot->image = *image;
+  else if (nrf24l01_build_register_image(device, &boot->image))
+    return -1;
+
+  // GPIO and timer only, SPI has to wait for the power on reset
+  nrf24l01_chip_disable(device);
+  nrf24l01_port_timer_start(device);
+  boot->started = nrf24l01_port_millis(device);
+  boot->state = nrf24l01_boot_waiting_por;
+  return 0;
+}
+
+// CE is low
+static void nrf24l01_boot_configure(nrf24l01_boot * boot){
+  nrf24l01_device * device = boot->device;
+  uint8_t config_register = 0, status_register;
+
+  // a chip left powered up by a warm restart has its crystal running
+  if (boot->reset == nrf24l01_boot_warm_restart)
+    nrf24l01_read_register(device, CONFIG, &config_register, 1);
+
+  // whatever the previous firmware left behind
+  status_register = nrf24l01_clear_interrupt_flags(device, RX_DR | TX_DS | MAX_RT);
+  if (status_register & 0x80){
+    boot->state = nrf24l01_boot_failed; // STATUS bit 7 always reads 0
+    return;
+  }
+  nrf24l01_send_command(device, FLUSH_TX);
+  nrf24l01_send_command(device, FLUSH_RX);
+
+  nrf24l01_write_register_image(device, &boot->image);
+  nrf24l01_load_register_image(device, &boot->image);
+
+  if ((boot->image.config & PWR_UP) && !(config_register & PWR_UP)){
+    boot->power_up_started = nrf24l01_port_micros(device);
+    boot->power_up_started_ms = nrf24l01_port_millis(device);
+    boot->state = nrf24l01_boot_powering_up;
+  }
+  else
+    boot->state = nrf24l01_boot_ready;
+}
+
+nrf24l01_boot_state nrf24l01_boot_service(nrf24l01_boot * boot){
+  if (boot == NULL) return nrf24l01_boot_failed;
+  nrf24l01_boot_state previous = boot->state;
+
+  switch (boot->state) {
+    case nrf24l01_boot_waiting_por:
+      // the ms tick may advance right after the start, one more keeps the full time
+      if (boot->reset == nrf24l01_boot_power_on && nrf24l01_port_millis(boot->device) - boot->started <= NRF24L01_BOOT_POR_TIME) break;
+      nrf24l01_boot_configure(boot);
+      if (boot->state != nrf24l01_boot_powering_up) break;
+      // fall through
+    case nrf24l01_boot_powering_up: {
+      uint16_t elapsed = nrf24l01_port_micros(boot->device) - boot->power_up_started;
+      // the ms tick takes over once the 16-bit µs counter may have wrapped
+      uint32_t elapsed_ms = nrf24l01_port_millis(boot->device) - boot->power_up_started_ms;
+      if (elapsed < NRF24L01_POWER_TPD2STBY && elapsed_ms <= NRF24L01_POWER_TPD2STBY / 1000 + 1) break;
+      boot->state = nrf24l01_boot_ready;
+    }
+      break;
+    default:
+      break;
+  }
+
+  if (boot->state == nrf24l01_boot_ready && previous != nrf24l01_boot_ready)
+    boot->boot_time = nrf24l01_port_millis(boot->device) - boot->started;
+  return boot->state;
+}
+
+uint8_t nrf24l01_boot_service_all(nrf24l01_boot * boot, uint8_t count){
+  uint8_t pending = 0;
+  if (boot == NULL) return 0;
+  for (uint8_t i = 0; i < count; i++){
+    nrf24l01_boot_state state = nrf24l01_boot_service(&boot[i]);
+    if (state != nrf24l01_boot_ready && state != nrf24l01_boot_failed) pending++;
+  }
+  return pending;
+}
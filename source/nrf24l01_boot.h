@@ -0,0 +1,124 @@
+/**
+ * @file nrf24l01_boot.h
+ * @brief Non-blocking device bring-up, for several radios at once
+ *
+ * nrf24l01_init() waits 11 ms for the power on reset and 2 ms for the
+ * crystal before the first packet, and configures the chip with a chain of
+ * read-modify-write cycles; with four radios that is more than 50 ms of a
+ * stalled boot. Here the waits run on the port timers instead:
+ * nrf24l01_boot_start() only records the time, and nrf24l01_boot_service(),
+ * called from the boot loop next to the bring-up of other radios and
+ * peripherals, moves each device on when its time has come:
+ *
+ * - waiting for the power on reset (NRF24L01_BOOT_POR_TIME ms)
+ * - configuring: interrupt flags cleared, both FIFOs flushed and the
+ *   register image written, with no register read
+ * - powering up: NRF24L01_POWER_TPD2STBY µs for the crystal when the
+ *   image sets PWR_UP
+ * - ready, or failed when the chip does not answer on SPI
+ *
+ * After a watchdog or software reset the radio kept its supply, so a warm
+ * start skips the power on reset. CONFIG is read once; when the chip is
+ * still powered up the crystal is running and the device is ready right
+ * after the writes, well under a millisecond. A warm start is only valid
+ * when the reset cause shows the supply stayed up.
+ *
+ * The STATUS byte shifted out by the first write tells whether a chip is
+ * there: its bit 7 always reads 0, a floating MISO pulled high does not.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_boot boot[4];
+ * nrf24l01_boot_reset reset = __HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST) ? nrf24l01_boot_warm_restart : nrf24l01_boot_power_on;
+ * for (uint8_t i = 0; i < 4; i++)
+ *   nrf24l01_boot_start(&boot[i], &radio[i], &radio_image, reset);
+ *
+ * while (nrf24l01_boot_service_all(boot, 4) > 0){
+ *   ... bring up sensors, display, file system ...
+ * }
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_BOOT_H
+#define NRF24L01_DRIVER_NRF24L01_BOOT_H
+
+#include "nrf24l01_power.h"
+
+/**
+ * @defgroup NRF24L01_BOOT Asynchronous Bring-Up
+ * @brief Timer-driven power on reset and power up, image written without reads
+ * @{
+ */
+
+#ifndef NRF24L01_BOOT_POR_TIME
+/** @brief Power on reset time in ms, from supply up to the first SPI access */
+#define NRF24L01_BOOT_POR_TIME   11
+#endif
+
+/**
+ * @brief What reset the microcontroller
+ */
+typedef enum {
+    nrf24l01_boot_power_on = 0,            /**< Supply just came up, wait for the power on reset */
+    nrf24l01_boot_warm_restart,            /**< Watchdog or software reset, the radio stayed powered */
+} nrf24l01_boot_reset;
+
+/**
+ * @brief Bring-up states
+ */
+typedef enum {
+    nrf24l01_boot_waiting_por = 0,         /**< Waiting for the power on reset */
+    nrf24l01_boot_powering_up,             /**< Image written, crystal starting */
+    nrf24l01_boot_ready,                   /**< Configured and in Standby-I or Power Down */
+    nrf24l01_boot_failed,                  /**< No chip answering */
+} nrf24l01_boot_state;
+
+/**
+ * @brief Bring-up of one device
+ */
+typedef struct {
+    nrf24l01_device * device;              /**< Radio brought up */
+    nrf24l01_register_image image;         /**< Registers to write */
+    nrf24l01_boot_state state;             /**< Current state */
+    nrf24l01_boot_reset reset;             /**< Start kind */
+    uint32_t started;                      /**< Time of nrf24l01_boot_start(), ms */
+    uint32_t power_up_started_ms;          /**< PWR_UP time, ms; covers waits longer than the µs counter */
+    uint16_t power_up_started;             /**< PWR_UP time, µs */
+    uint32_t boot_time;                    /**< Start to ready, ms */
+} nrf24l01_boot;
+
+/**
+ * @brief Start bringing up a device, without waiting
+ * @param boot Pointer to bring-up
+ * @param device Pointer to device with SPI, GPIO and timer set
+ * @param image Register image to write, NULL to build it from the device configuration
+ * @param reset What reset the microcontroller
+ * @return 0 on success, non-zero on error
+ *
+ * Drives CE low and starts the µs timer; the chip is not accessed. The
+ * image is copied, it may be a temporary.
+ */
+uint8_t nrf24l01_boot_start(nrf24l01_boot * boot, nrf24l01_device * device, const nrf24l01_register_image * image, nrf24l01_boot_reset reset);
+
+/**
+ * @brief Advance the bring-up
+ * @param boot Pointer to bring-up
+ * @return Current state
+ *
+ * Call from the boot loop; never waits. Once ready, the cached
+ * configuration of the device follows the image and the device can be
+ * used as after nrf24l01_init().
+ */
+nrf24l01_boot_state nrf24l01_boot_service(nrf24l01_boot * boot);
+
+/**
+ * @brief Advance the bring-up of several devices
+ * @param boot Array of bring-ups
+ * @param count Number of bring-ups
+ * @return Devices neither ready nor failed
+ */
+uint8_t nrf24l01_boot_service_all(nrf24l01_boot * boot, uint8_t count);
+
+/** @} */ // End of NRF24L01_BOOT group
+
+#endif //NRF24L01_DRIVER_NRF24L01_BOOT_H
@@ -0,0 +1,193 @@
+#include "nrf24l01_bus.h"
+
+static int8_t nrf24l01_bus_index(nrf24l01_bus * bus, nrf24l01_device * device){
+  for (uint8_t i = 0; i < bus->device_count; i++){
+    if (bus->device[i] == device) return i;
+  }
+  return -1;
+}
+
+// pending job served next: best class, then the device of the running batch, then oldest
+static int8_t nrf24l01_bus_next(nrf24l01_bus * bus, uint8_t batch_device){
+  int8_t next = -1;
+  for (uint8_t i = 0; i < bus->queued; i++){
+    nrf24l01_bus_request * request = &bus->queue[i];
+    if (next < 0){
+      next = i;
+      continue;
+    }
+    nrf24l01_bus_request * best = &bus->queue[next];
+    if (request->priority != best->priority){
+      if (request->priority < best->priority) next = i;
+    }
+    else if ((request->device == batch_device) != (best->device == batch_device)){
+      if (request->device == batch_device) next = i;
+    }
+    else if ((int8_t)(request->ticket - best->ticket) < 0)
+      next = i;
+  }
+  return next;
+}
+
+static void nrf24l01_bus_remove(nrf24l01_bus * bus, uint8_t index){
+  bus->queued--;
+  bus->queue[index] = bus->queue[bus->queued];
+}
+
+static uint8_t nrf24l01_bus_drain(nrf24l01_bus * bus, nrf24l01_device * device){
+  uint8_t data[32];
+  uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+  // cleared before draining: a payload landing after the last read sets it
+  // again and keeps IRQ low, instead of being cleared unseen
+  uint8_t status_register = nrf24l01_clear_interrupt_flags(device, RX_DR);
+  if (chip_enabled) nrf24l01_chip_enable(device);
+  nrf24l01_status status = nrf24l01_status_decode(status_register);
+
+  while (status.pipe <= 5){
+    uint8_t length = device->data_pipe[status.pipe].nrf24l01_data_pipe_payload_width;
+    if (device->dynamic_payload_length_enable && device->data_pipe[status.pipe].nrf24l01_data_pipe_dyn_payload_length_enable){
+      nrf24l01_read_rx_payload_width(device, &length);
+      if (length < 1 || length > 32){
+        // corrupted length, the datasheet asks for a flush
+        nrf24l01_send_command(device, FLUSH_RX);
+        break;
+      }
+    }
+    if (length < 1 || length > 32) length = 32;
+
+    status_register = nrf24l01_read_rx_payload(device, data, length);
+    bus->stats.received++;
+    if (bus->on_rx != NULL) bus->on_rx(device, status.pipe, data, length, bus->rx_context);
+    // STATUS shifted out during the read still shows the payload just read
+    status_register = nrf24l01_nop(device);
+    status = nrf24l01_status_decode(status_register);
+  }
+  return status_register;
+}
+
+// runs queued jobs until the queue is empty, then releases the bus
+static uint8_t nrf24l01_bus_run(nrf24l01_bus * bus){
+  uint8_t executed = 0, batch_device = 0xFF, ce_restore = 0;
+  uint32_t state;
+
+  for (;;){
+    NRF24L01_BUS_CRITICAL_ENTER(state);
+    int8_t index = nrf24l01_bus_next(bus, batch_device);
+    if (index < 0){
+      bus->busy = 0;
+      NRF24L01_BUS_CRITICAL_EXIT(state);
+      break;
+    }
+    nrf24l01_bus_request request = bus->queue[index];
+    nrf24l01_bus_remove(bus, index);
+    if (request.job == NULL) bus->drain_pending &= ~(1 << request.device);
+    NRF24L01_BUS_CRITICAL_EXIT(state);
+
+    nrf24l01_device * device = bus->device[request.device];
+    if (request.device != batch_device){
+      if (ce_restore) nrf24l01_chip_enable(bus->device[batch_device]);
+      ce_restore = 0;
+      batch_device = request.device;
+    }
+    else
+      bus->stats.batched++;
+
+    if (request.ce_low && nrf24l01_port_ce_read(device)){
+      // one CE cycle for the whole batch
+      nrf24l01_chip_disable(device);
+      ce_restore = 1;
+      bus->stats.ce_cycles++;
+    }
+
+    if (request.job == NULL)
+      nrf24l01_bus_drain(bus, device);
+    else
+      request.job(device, request.context);
+    bus->stats.executed++;
+    executed++;
+  }
+
+  if (ce_restore) nrf24l01_chip_enable(bus->device[batch_device]);
+  return executed;
+}
+
+static uint8_t nrf24l01_bus_enqueue(nrf24l01_bus * bus, nrf24l01_device * device, uint8_t priority,
+                                    nrf24l01_bus_job job, void * context){
+  uint32_t state;
+  uint8_t owner = 0;
+
+  int8_t index = nrf24l01_bus_index(bus, device);
+  if (index < 0) return -1; // device not attached
+
+  NRF24L01_BUS_CRITICAL_ENTER(state);
+  if (job == NULL && (bus->drain_pending & (1 << index))){
+    // the queued drain reads this payload too
+    NRF24L01_BUS_CRITICAL_EXIT(state);
+    return 0;
+  }
+  if (bus->queued == NRF24L01_BUS_QUEUE_DEPTH){
+    bus->stats.rejected++;
+    NRF24L01_BUS_CRITICAL_EXIT(state);
+    return -1;
+  }
+
+  nrf24l01_bus_request * request = &bus->queue[bus->queued++];
+  request->job = job;
+  request->context = context;
+  request->device = index;
+  request->priority = priority;
+  request->ticket = bus->ticket++;
+  request->ce_low = priority == nrf24l01_bus_priority_config;
+  if (job == NULL) bus->drain_pending |= 1 << index;
+
+  if (bus->busy)
+    bus->stats.deferred++;
+  else
+    bus->busy = owner = 1;
+  NRF24L01_BUS_CRITICAL_EXIT(state);
+
+  if (owner) nrf24l01_bus_run(bus);
+  return 0;
+}
+
+uint8_t nrf24l01_bus_init(nrf24l01_bus * bus, nrf24l01_bus_rx_handler on_rx, void * context){
+  if (bus == NULL) return -1;
+  memset(bus, 0, sizeof(nrf24l01_bus));
+  bus->on_rx = on_rx;
+  bus->rx_context = context;
+  return 0;
+}
+
+uint8_t nrf24l01_bus_attach(nrf24l01_bus * bus, nrf24l01_device * device){
+  if (bus == NULL || device == NULL) return -1;
+  int8_t index = nrf24l01_bus_index(bus, device);
+  if (index >= 0) return index; // already attached
+  if (bus->device_count == NRF24L01_BUS_MAX_DEVICES) return -1; // bus full
+
+  bus->device[bus->device_count] = device;
+  return bus->device_count++;
+}
+
+uint8_t nrf24l01_bus_submit(nrf24l01_bus * bus, nrf24l01_device * device, nrf24l01_bus_priority priority,
+                            nrf24l01_bus_job job, void * context){
+  if (bus == NULL || device == NULL || job == NULL) return -1;
+  if (priority >= nrf24l01_bus_priority_count) return -1; // invalid class
+  return nrf24l01_bus_enqueue(bus, device, priority, job, context);
+}
+
+uint8_t nrf24l01_bus_irq(nrf24l01_bus * bus, nrf24l01_device * device){
+  if (bus == NULL || device == NULL) return -1;
+  return nrf24l01_bus_enqueue(bus, device, nrf24l01_bus_priority_rx_drain, NULL, NULL);
+}
+
+uint8_t nrf24l01_bus_service(nrf24l01_bus * bus){
+  uint32_t state;
+  if (bus == NULL) return 0;
+
+  NRF24L01_BUS_CRITICAL_ENTER(state);
+  uint8_t owner = !bus->busy && bus->queued;
+  if (owner) bus->busy = 1;
+  NRF24L01_BUS_CRITICAL_EXIT(state);
+
+  return owner ? nrf24l01_bus_run(bus) : 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file nrf24l01_bus.h
+ * @brief Shared SPI bus manager for several radios
+ *
+ * Serializes SPI transactions of up to NRF24L01_BUS_MAX_DEVICES radios that
+ * share one SPI peripheral and are touched from different contexts (main
+ * loop, EXTI handlers, timers). Work is submitted as jobs: a function that
+ * performs one or more driver calls on one device. A job runs at once when
+ * the bus is free; otherwise it is queued and the context that currently
+ * owns the bus runs it before releasing it. No job ever interleaves with
+ * another one, so no CSN frame is cut in two.
+ *
+ * Pending jobs are served by priority class, RX drains first, then TX,
+ * then configuration; inside a class in submission order. Queued jobs of
+ * the device that was just served are run back to back as one batch, and
+ * when jobs of the batch need CE low (register writes) CE is dropped once
+ * for the whole batch and restored at its end, instead of once per write.
+ *
+ * The critical section around the queue is NRF24L01_BUS_CRITICAL_ENTER /
+ * NRF24L01_BUS_CRITICAL_EXIT. On Cortex-M they save and mask PRIMASK;
+ * define them to mask only the radio interrupts, and for any other core,
+ * where the build stops until they are defined: an empty critical section
+ * would let an interrupt corrupt the queue.
+ *
+ * Every access to an attached device must go through the bus, including
+ * the ones the core driver makes on its own (nrf24l01_init, the optional
+ * modules): call them from a job.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_bus bus;
+ * nrf24l01_bus_init(&bus, on_rx, NULL);
+ * for (int i = 0; i < 4; i++) nrf24l01_bus_attach(&bus, &radio[i]);
+ *
+ * // EXTI handler of radio 2
+ * nrf24l01_bus_irq(&bus, &radio[2]);
+ *
+ * // main loop, background reconfiguration
+ * static uint8_t retune(nrf24l01_device * device, void * context){
+ *   uint8_t channel = *(uint8_t *)context;
+ *   return nrf24l01_write_register(device, RF_CH, &channel, 1);
+ * }
+ * nrf24l01_bus_submit(&bus, &radio[0], nrf24l01_bus_priority_config, retune, &channel);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_BUS_H
+#define NRF24L01_DRIVER_NRF24L01_BUS_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_BUS Shared SPI Bus
+ * @brief Serialized, prioritized and batched access to radios on one SPI bus
+ * @{
+ */
+
+#ifndef NRF24L01_BUS_MAX_DEVICES
+/** @brief Radios that can be attached to one bus */
+#define NRF24L01_BUS_MAX_DEVICES   4
+#endif
+
+#ifndef NRF24L01_BUS_QUEUE_DEPTH
+/** @brief Jobs that can wait for the bus, less than 128 */
+#define NRF24L01_BUS_QUEUE_DEPTH   16
+#endif
+
+#ifndef NRF24L01_BUS_CRITICAL_ENTER
+#if defined(__CORTEX_M)
+/** @brief Enter the critical section protecting the queue, state is a uint32_t lvalue */
+#define NRF24L01_BUS_CRITICAL_ENTER(state)   do { (state) = __get_PRIMASK(); __disable_irq(); } while (0)
+/** @brief Leave the critical section entered with the same state */
+#define NRF24L01_BUS_CRITICAL_EXIT(state)    __set_PRIMASK(state)
+#else
+#error "not a Cortex-M core: define NRF24L01_BUS_CRITICAL_ENTER and NRF24L01_BUS_CRITICAL_EXIT"
+#endif
+#elif !defined(NRF24L01_BUS_CRITICAL_EXIT)
+#error "NRF24L01_BUS_CRITICAL_ENTER defined without NRF24L01_BUS_CRITICAL_EXIT"
+#endif
+
+/**
+ * @brief Priority classes, lower value is served first
+ */
+typedef enum {
+    nrf24l01_bus_priority_rx_drain = 0,    /**< Emptying an RX FIFO after an interrupt */
+    nrf24l01_bus_priority_tx,              /**< Loading payloads, starting transmissions */
+    nrf24l01_bus_priority_config,          /**< Background configuration */
+    nrf24l01_bus_priority_count            /**< Number of priority classes */
+} nrf24l01_bus_priority;
+
+/**
+ * @brief Job run with exclusive access to the bus
+ * @param device Device the job was submitted for
+ * @param context User context given at submission
+ * @return Driver status, ignored by the bus
+ */
+typedef uint8_t (*nrf24l01_bus_job)(nrf24l01_device * device, void * context);
+
+/**
+ * @brief Payload delivered by an RX drain
+ * @param device Receiving device
+ * @param pipe Receiving pipe (0-5)
+ * @param data Payload
+ * @param length Payload length (1-32)
+ * @param context User context given to nrf24l01_bus_init()
+ */
+typedef void (*nrf24l01_bus_rx_handler)(nrf24l01_device * device, uint8_t pipe, const uint8_t * data,
+                                        uint8_t length, void * context);
+
+/**
+ * @brief One pending job
+ */
+typedef struct {
+    nrf24l01_bus_job job;                  /**< Function to run, NULL for an RX drain */
+    void * context;                        /**< Job context */
+    uint8_t device;                        /**< Index of the device in the bus */
+    uint8_t priority;                      /**< One of nrf24l01_bus_priority */
+    uint8_t ticket;                        /**< Submission order */
+    uint8_t ce_low;                        /**< Job needs CE low */
+} nrf24l01_bus_request;
+
+/**
+ * @brief Bus counters
+ */
+typedef struct {
+    uint32_t executed;                     /**< Jobs run */
+    uint32_t deferred;                     /**< Jobs queued because the bus was busy */
+    uint32_t batched;                      /**< Jobs run in the batch of the previous job */
+    uint32_t ce_cycles;                    /**< CE drops done on behalf of a batch */
+    uint32_t rejected;                     /**< Jobs refused because the queue was full */
+    uint32_t received;                     /**< Payloads delivered by RX drains */
+} nrf24l01_bus_stats;
+
+/**
+ * @brief Bus instance, one per SPI peripheral
+ */
+typedef struct {
+    nrf24l01_device * device[NRF24L01_BUS_MAX_DEVICES];     /**< Attached radios */
+    uint8_t device_count;                                    /**< Number of attached radios */
+    nrf24l01_bus_request queue[NRF24L01_BUS_QUEUE_DEPTH];   /**< Pending jobs, unordered */
+    uint8_t queued;                                          /**< Number of pending jobs */
+    uint8_t ticket;                                          /**< Ticket of the next submission */
+    uint8_t drain_pending;                                   /**< Bit per device with an RX drain queued */
+    volatile uint8_t busy;                                   /**< A context owns the bus */
+    nrf24l01_bus_rx_handler on_rx;                           /**< RX drain callback */
+    void * rx_context;                                       /**< RX drain callback context */
+    nrf24l01_bus_stats stats;                                /**< Counters */
+} nrf24l01_bus;
+
+/**
+ * @brief Initialize a bus
+ * @param bus Pointer to bus instance
+ * @param on_rx Called for every payload read by an RX drain, may be NULL
+ * @param context Context passed to on_rx
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_bus_init(nrf24l01_bus * bus, nrf24l01_bus_rx_handler on_rx, void * context);
+
+/**
+ * @brief Attach a radio to the bus
+ * @param bus Pointer to bus instance
+ * @param device Pointer to device on this bus
+ * @return Index of the device in the bus, or -1 on error
+ */
+uint8_t nrf24l01_bus_attach(nrf24l01_bus * bus, nrf24l01_device * device);
+
+/**
+ * @brief Run a job with exclusive access to the bus
+ * @param bus Pointer to bus instance
+ * @param device Attached device the job works on
+ * @param priority Priority class of the job
+ * @param job Function to run
+ * @param context Passed to the job, must stay valid until it has run
+ * @return 0 when the job ran or was queued, non-zero on error
+ *
+ * Safe from interrupt handlers. When another context owns the bus the job
+ * is queued and runs when that context releases it. Configuration jobs run
+ * with CE low.
+ */
+uint8_t nrf24l01_bus_submit(nrf24l01_bus * bus, nrf24l01_device * device, nrf24l01_bus_priority priority,
+                            nrf24l01_bus_job job, void * context);
+
+/**
+ * @brief Drain the RX FIFO of a device, call from its IRQ handler
+ * @param bus Pointer to bus instance
+ * @param device Attached device whose IRQ fired
+ * @return 0 when the drain ran or was queued, non-zero on error
+ *
+ * Clears RX_DR, then reads every payload in the RX FIFO and hands it to
+ * the on_rx callback; a payload arriving after the last read keeps RX_DR
+ * set for the next interrupt. Other flags are left for the application. A
+ * drain already queued for the device is not queued twice.
+ */
+uint8_t nrf24l01_bus_irq(nrf24l01_bus * bus, nrf24l01_device * device);
+
+/**
+ * @brief Run the queued jobs if the bus is free
+ * @param bus Pointer to bus instance
+ * @return Number of jobs run, 0 when another context owns the bus
+ *
+ * Submissions already run the queue. Call it from the main loop when the
+ * critical section hooks are empty, so an interrupt can submit while the
+ * owner is releasing the bus and its job would otherwise wait for the
+ * next submission.
+ */
+uint8_t nrf24l01_bus_service(nrf24l01_bus * bus);
+
+/** @} */ // End of NRF24L01_BUS group
+
+#endif //NRF24L01_DRIVER_NRF24L01_BUS_H
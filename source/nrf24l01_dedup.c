@@ -0,0 +1,86 @@
+#include "nrf24l01_dedup.h"
+
+uint8_t nrf24l01_dedup_write_tx_payload(nrf24l01_dedup_tx * tx, nrf24l01_device * device, uint8_t * data, uint16_t length){
+  uint8_t frame[32];
+  if (tx == NULL || device == NULL || data == NULL) return -1;
+  if (length < 1 || length > 32 - NRF24L01_DEDUP_HEADER_SIZE) return -1; // invalid payload length
+
+  frame[0] = tx->session;
+  frame[1] = tx->sequence;
+  memcpy(frame + NRF24L01_DEDUP_HEADER_SIZE, data, length);
+
+  return nrf24l01_write_tx_payload(device, frame, length + NRF24L01_DEDUP_HEADER_SIZE);
+}
+
+uint8_t nrf24l01_dedup_tx_init(nrf24l01_dedup_tx * tx, uint8_t session){
+  if (tx == NULL) return -1;
+  tx->session = session;
+  tx->sequence = 0;
+  return 0;
+}
+
+uint8_t nrf24l01_dedup_tx_next(nrf24l01_dedup_tx * tx){
+  if (tx == NULL) return 0;
+  return ++tx->sequence;
+}
+
+uint8_t nrf24l01_dedup_accept(nrf24l01_dedup_rx * rx, uint8_t pipe_number, uint8_t session, uint8_t sequence){
+  if (rx == NULL || pipe_number > 5) return 0;
+  nrf24l01_dedup_window * window = &rx->pipe[pipe_number];
+
+  int8_t distance = (int8_t)(sequence - window->highest);
+
+  if (!window->valid || session != window->session || distance <= -NRF24L01_DEDUP_WINDOW){
+    // first packet, or peer restarted its sequence
+    if (window->valid) rx->resyncs++;
+    window->valid = 1;
+    window->session = session;
+    window->highest = sequence;
+    window->window = 1;
+  }
+  else if (distance > 0){
+    // newer than anything seen, slide the window
+    window->window = distance >= NRF24L01_DEDUP_WINDOW ? 0 : window->window << distance;
+    window->window |= 1;
+    window->highest = sequence;
+  }
+  else {
+    uint32_t bit = (uint32_t)1 << -distance;
+    if (window->window & bit){
+      rx->duplicates++;
+      return 0;
+    }
+    window->window |= bit;
+  }
+
+  rx->accepted++;
+  return 1;
+}
+
+uint8_t nrf24l01_dedup_reset(nrf24l01_dedup_rx * rx, uint8_t pipe_number){
+  if (rx == NULL || pipe_number > 5) return -1;
+  memset(&rx->pipe[pipe_number], 0, sizeof(nrf24l01_dedup_window));
+  return 0;
+}
+
+uint8_t nrf24l01_dedup_read_rx_payload(nrf24l01_dedup_rx * rx, nrf24l01_device * device, uint8_t * data,
+                                       uint16_t length, uint8_t * payload_length){
+  uint8_t status_register = 0, pipe_number = 0;
+  uint8_t frame[32];
+  if (rx == NULL || device == NULL || data == NULL || payload_length == NULL) return -1;
+  *payload_length = 0;
+  if (length <= NRF24L01_DEDUP_HEADER_SIZE || length > 32) return -1; // invalid payload length
+
+  status_register = nrf24l01_nop(device);
+  pipe_number = NRF24L01_FIELD_GET(RX_P_NO, status_register);
+  if (pipe_number > 5) return -1; // rx fifo is empty
+
+  status_register = nrf24l01_read_rx_payload(device, frame, length);
+
+  if (nrf24l01_dedup_accept(rx, pipe_number, frame[0], frame[1])){
+    *payload_length = length - NRF24L01_DEDUP_HEADER_SIZE;
+    memcpy(data, frame + NRF24L01_DEDUP_HEADER_SIZE, *payload_length);
+  }
+
+  return status_register;
+}
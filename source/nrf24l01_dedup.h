@@ -0,0 +1,150 @@
+/**
+ * @file nrf24l01_dedup.h
+ * @brief Application-level sequence numbers and duplicate suppression
+ *
+ * The 2-bit PID of Enhanced ShockBurst only detects a duplicate inside one
+ * auto-retransmit exchange. When the ACK is lost and the application sends
+ * the packet again (after MAX_RT or its own timeout), the PRX delivers it a
+ * second time.
+ *
+ * This module prepends a session byte and a sequence number to every
+ * payload. The receiver keeps, for each data pipe, the session, the highest
+ * sequence number seen and a 32-entry sliding window of recently seen
+ * numbers, and drops everything it has already delivered. One pipe is
+ * assumed to carry one peer.
+ *
+ * A restarted sender counts its sequence numbers from the start again; the
+ * first 32 would fall inside the old window and be dropped. The session
+ * byte tells the receiver that the sender restarted: a new session resets
+ * the window. The sender must therefore pick a different session on every
+ * boot, e.g. from a boot counter kept in flash or backup registers, or from
+ * a random number; with a session fixed at build time packets after a
+ * restart are lost. A sequence number far behind the window (more than 32
+ * packets) is treated as a restart as well.
+ *
+ * @par Example Usage:
+ * @code
+ * // PTX: the same sequence number is reused until the packet is done
+ * static nrf24l01_dedup_tx tx;
+ * nrf24l01_dedup_tx_init(&tx, boot_count);
+ * nrf24l01_dedup_write_tx_payload(&tx, &nrf, command, sizeof(command));
+ * ...
+ * nrf24l01_dedup_tx_next(&tx); // after TX_DS or when giving up
+ *
+ * // PRX
+ * static nrf24l01_dedup_rx rx;
+ * uint8_t data[30], length;
+ * nrf24l01_dedup_read_rx_payload(&rx, &nrf, data, 32, &length);
+ * if (length > 0)
+ *     execute(data, length); // exactly once
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_DEDUP_H
+#define NRF24L01_DRIVER_NRF24L01_DEDUP_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_DEDUP Duplicate Suppression
+ * @brief Sequence numbers with a per-pipe sliding replay window
+ * @{
+ */
+
+/** @brief Bytes added in front of every payload */
+#define NRF24L01_DEDUP_HEADER_SIZE   2
+
+/** @brief Number of sequence numbers tracked behind the highest one */
+#define NRF24L01_DEDUP_WINDOW        32
+
+/**
+ * @brief Sender state, one per destination
+ */
+typedef struct {
+    uint8_t session;               /**< Session of this boot of the sender */
+    uint8_t sequence;              /**< Sequence number of the packet being sent */
+} nrf24l01_dedup_tx;
+
+/**
+ * @brief Replay window of one data pipe
+ */
+typedef struct {
+    uint8_t valid;                 /**< A packet has been received on this pipe */
+    uint8_t session;               /**< Session of the peer */
+    uint8_t highest;               /**< Highest sequence number seen */
+    uint32_t window;               /**< Bit n set: sequence number highest - n was seen */
+} nrf24l01_dedup_window;
+
+/**
+ * @brief Receiver state, one per device
+ */
+typedef struct {
+    nrf24l01_dedup_window pipe[6]; /**< Replay window per data pipe */
+    uint32_t accepted;             /**< Packets delivered */
+    uint32_t duplicates;           /**< Packets dropped as duplicates */
+    uint32_t resyncs;              /**< Peer restarts detected (new session or sequence far behind) */
+} nrf24l01_dedup_rx;
+
+/**
+ * @brief Start a sender session
+ * @param tx Pointer to sender state
+ * @param session Session byte, different on every boot of the sender
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_dedup_tx_init(nrf24l01_dedup_tx * tx, uint8_t session);
+
+/**
+ * @brief Write a payload with the current sequence number
+ * @param tx Pointer to sender state
+ * @param device Pointer to device configuration structure
+ * @param data Pointer to payload data
+ * @param length Payload length (1-30)
+ * @return Status register value
+ *
+ * Call again with the same data to retry; the sequence number only changes
+ * with nrf24l01_dedup_tx_next().
+ */
+uint8_t nrf24l01_dedup_write_tx_payload(nrf24l01_dedup_tx * tx, nrf24l01_device * device, uint8_t * data, uint16_t length);
+
+/**
+ * @brief Move on to the next sequence number
+ * @param tx Pointer to sender state
+ * @return New sequence number
+ */
+uint8_t nrf24l01_dedup_tx_next(nrf24l01_dedup_tx * tx);
+
+/**
+ * @brief Check a sequence number against the replay window of a pipe
+ * @param rx Pointer to receiver state
+ * @param pipe_number Data pipe the packet arrived on (0-5)
+ * @param session Session byte of the packet
+ * @param sequence Sequence number of the packet
+ * @return 1 if the packet is new, 0 if it is a duplicate
+ */
+uint8_t nrf24l01_dedup_accept(nrf24l01_dedup_rx * rx, uint8_t pipe_number, uint8_t session, uint8_t sequence);
+
+/**
+ * @brief Forget the replay window of a pipe
+ * @param rx Pointer to receiver state
+ * @param pipe_number Data pipe number (0-5)
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_dedup_reset(nrf24l01_dedup_rx * rx, uint8_t pipe_number);
+
+/**
+ * @brief Read the top RX payload and drop it if it is a duplicate
+ * @param rx Pointer to receiver state
+ * @param device Pointer to device configuration structure
+ * @param data Pointer to buffer for the payload without header
+ * @param length Length of the received frame, header included (3-32)
+ * @param payload_length Set to the number of bytes stored in data, 0 for a duplicate
+ * @return Status register value
+ *
+ * Use in place of nrf24l01_read_rx_payload() in IRQ or polling receive paths.
+ */
+uint8_t nrf24l01_dedup_read_rx_payload(nrf24l01_dedup_rx * rx, nrf24l01_device * device, uint8_t * data,
+                                       uint16_t length, uint8_t * payload_length);
+
+/** @} */ // End of NRF24L01_DEDUP group
+
+#endif //NRF24L01_DRIVER_NRF24L01_DEDUP_H
@@ -0,0 +1,165 @@
+#include "nrf24l01_energy.h"
+#include "nrf24l01_link.h"
+
+static nrf24l01_energy * nrf24l01_energy_observed[NRF24L01_ENERGY_MAX_DEVICES];
+
+// closes the time since the last event into the state the chip was in
+static void nrf24l01_energy_account(nrf24l01_energy * energy){
+  uint16_t now_us = nrf24l01_port_micros(energy->device);
+  uint32_t now_ms = nrf24l01_port_millis(energy->device);
+  uint32_t elapsed_ms = now_ms - energy->last_ms;
+  // the 16-bit µs counter is only trusted well below its wrap
+  uint64_t elapsed = elapsed_ms > 60 ? (uint64_t)elapsed_ms * 1000 : (uint16_t)(now_us - energy->last_us);
+  energy->last_us = now_us;
+  energy->last_ms = now_ms;
+
+  if (!(energy->config & PWR_UP))
+    energy->time_power_down += elapsed;
+  else if (!energy->ce)
+    energy->time_standby_1 += elapsed;
+  else if (energy->config & PRIM_RX)
+    energy->time_rx += elapsed;
+  else
+    energy->time_ptx_active += elapsed;
+}
+
+static uint16_t nrf24l01_energy_packet_time(nrf24l01_device * device, uint8_t length){
+  return NRF24L01_LINK_SETTLING_TIME +
+         nrf24l01_link_air_time(device->air_data_rate, device->address_width, 1, length, device->crc_length);
+}
+
+// pC, split so that years of time do not overflow the product
+static uint64_t nrf24l01_energy_charge(uint64_t time, uint32_t current){
+  return time / 1000 * current + time % 1000 * current / 1000;
+}
+
+nrf24l01_energy_currents nrf24l01_energy_default_currents(void){
+  nrf24l01_energy_currents currents;
+  currents.current[nrf24l01_energy_power_down] = 900;
+  currents.current[nrf24l01_energy_standby_1] = 26000;
+  currents.current[nrf24l01_energy_standby_2] = 320000;
+  currents.current[nrf24l01_energy_rx] = 13500000;
+  currents.current[nrf24l01_energy_tx_minus18dbm] = 7000000;
+  currents.current[nrf24l01_energy_tx_minus12dbm] = 7500000;
+  currents.current[nrf24l01_energy_tx_minus6dbm] = 9000000;
+  currents.current[nrf24l01_energy_tx_0dbm] = 11300000;
+  return currents;
+}
+
+uint8_t nrf24l01_energy_init(nrf24l01_energy * energy, nrf24l01_device * device, const nrf24l01_energy_currents * currents){
+  uint8_t rf_setup_register = 0, slot = NRF24L01_ENERGY_MAX_DEVICES;
+  if (energy == NULL || device == NULL) return -1;
+
+  for (uint8_t i = 0; i < NRF24L01_ENERGY_MAX_DEVICES; i++){
+    if (nrf24l01_energy_observed[i] == energy || (nrf24l01_energy_observed[i] != NULL && nrf24l01_energy_observed[i]->device == device)){
+      slot = i;
+      break;
+    }
+    if (nrf24l01_energy_observed[i] == NULL && slot == NRF24L01_ENERGY_MAX_DEVICES) slot = i;
+  }
+  if (slot == NRF24L01_ENERGY_MAX_DEVICES) return -1; // table full
+  nrf24l01_energy_observed[slot] = NULL;
+
+  memset(energy, 0, sizeof(nrf24l01_energy));
+  energy->device = device;
+  energy->currents = currents != NULL ? *currents : nrf24l01_energy_default_currents();
+  nrf24l01_read_register(device, CONFIG, &energy->config, 1);
+  nrf24l01_read_register(device, RF_SETUP, &rf_setup_register, 1);
+  energy->rf_power = NRF24L01_FIELD_GET(RF_PWR, rf_setup_register);
+  energy->ce = nrf24l01_port_ce_read(device);
+  energy->last_us = nrf24l01_port_micros(device);
+  energy->last_ms = nrf24l01_port_millis(device);
+
+  nrf24l01_energy_observed[slot] = energy;
+  return 0;
+}
+
+void nrf24l01_energy_deinit(nrf24l01_energy * energy){
+  for (uint8_t i = 0; i < NRF24L01_ENERGY_MAX_DEVICES; i++)
+    if (nrf24l01_energy_observed[i] == energy) nrf24l01_energy_observed[i] = NULL;
+}
+
+void nrf24l01_energy_observe(nrf24l01_device * device, nrf24l01_observe_event event, uint8_t value){
+  nrf24l01_energy * energy = NULL;
+  for (uint8_t i = 0; i < NRF24L01_ENERGY_MAX_DEVICES && energy == NULL; i++)
+    if (nrf24l01_energy_observed[i] != NULL && nrf24l01_energy_observed[i]->device == device) energy = nrf24l01_energy_observed[i];
+  if (energy == NULL) return;
+
+  switch (event) {
+    case nrf24l01_observe_ce:
+      nrf24l01_energy_account(energy);
+      energy->ce = value;
+      break;
+    case nrf24l01_observe_config:
+      nrf24l01_energy_account(energy);
+      energy->config = value;
+      break;
+    case nrf24l01_observe_rf_setup:
+      // only sets the level of later transmissions
+      energy->rf_power = NRF24L01_FIELD_GET(RF_PWR, value);
+      break;
+    case nrf24l01_observe_tx_payload:
+      energy->time_tx[energy->rf_power] += nrf24l01_energy_packet_time(device, value);
+      energy->time_ack += nrf24l01_energy_packet_time(device, 0);
+      energy->tx_packets++;
+      break;
+    case nrf24l01_observe_tx_payload_no_ack:
+      energy->time_tx[energy->rf_power] += nrf24l01_energy_packet_time(device, value);
+      energy->tx_packets++;
+      break;
+    case nrf24l01_observe_rx_payload:
+      energy->rx_packets++;
+      break;
+    case nrf24l01_observe_ack_payload:
+      // sent from RX mode, in reply to a packet: part of time_rx
+      energy->time_ack_payload[energy->rf_power] += nrf24l01_energy_packet_time(device, value);
+      energy->ack_payloads++;
+      break;
+  }
+}
+
+uint8_t nrf24l01_energy_get_report(nrf24l01_energy * energy, nrf24l01_energy_report * report){
+  if (energy == NULL || report == NULL) return -1;
+  const uint32_t * current = energy->currents.current;
+  memset(report, 0, sizeof(nrf24l01_energy_report));
+  nrf24l01_energy_account(energy);
+
+  uint64_t estimated = energy->time_ack, listening = energy->time_rx, rx_charge = 0;
+  for (uint8_t i = 0; i < 4; i++){
+    // an ACK payload written before listening started can exceed time_rx
+    uint64_t ack_payload = energy->time_ack_payload[i] < listening ? energy->time_ack_payload[i] : listening;
+    listening -= ack_payload;
+    rx_charge += nrf24l01_energy_charge(ack_payload, current[nrf24l01_energy_tx_minus18dbm + i]);
+    report->time[nrf24l01_energy_tx_minus18dbm + i] = energy->time_tx[i] + ack_payload;
+    estimated += energy->time_tx[i];
+  }
+  rx_charge += nrf24l01_energy_charge(listening, current[nrf24l01_energy_rx]);
+  report->time[nrf24l01_energy_power_down] = energy->time_power_down;
+  report->time[nrf24l01_energy_standby_1] = energy->time_standby_1;
+  report->time[nrf24l01_energy_rx] = listening + energy->time_ack;
+  if (estimated <= energy->time_ptx_active)
+    report->time[nrf24l01_energy_standby_2] = energy->time_ptx_active - estimated;
+  else {
+    // a short CE pulse: the chip finished the packet in what was counted as Standby-I
+    uint64_t excess = estimated - energy->time_ptx_active;
+    report->time[nrf24l01_energy_standby_1] -= excess < energy->time_standby_1 ? excess : energy->time_standby_1;
+  }
+
+  uint64_t charge = 0, tx_charge = 0;
+  for (uint8_t i = 0; i < nrf24l01_energy_state_count; i++){
+    uint64_t state_charge = nrf24l01_energy_charge(report->time[i], current[i]);
+    report->elapsed += report->time[i];
+    charge += state_charge;
+  }
+  for (uint8_t i = 0; i < 4; i++)
+    tx_charge += nrf24l01_energy_charge(energy->time_tx[i], current[nrf24l01_energy_tx_minus18dbm + i]);
+  tx_charge += nrf24l01_energy_charge(energy->time_ack, current[nrf24l01_energy_rx]);
+  tx_charge += nrf24l01_energy_charge(report->time[nrf24l01_energy_standby_2], current[nrf24l01_energy_standby_2]);
+
+  // pC to nC, pC per ms is nA
+  report->charge = charge / 1000;
+  if (report->elapsed >= 1000) report->average_current = (uint32_t)(charge / (report->elapsed / 1000));
+  if (energy->tx_packets > 0) report->charge_per_tx_packet = (uint32_t)(tx_charge / energy->tx_packets / 1000);
+  if (energy->rx_packets > 0) report->charge_per_rx_packet = (uint32_t)(rx_charge / energy->rx_packets / 1000);
+  return 0;
+}
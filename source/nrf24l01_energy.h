@@ -0,0 +1,151 @@
+/**
+ * @file nrf24l01_energy.h
+ * @brief Energy accounting: time in each chip state, charge per packet, average current
+ *
+ * Observes the core through NRF24L01_OBSERVER: build every source with
+ * -DNRF24L01_OBSERVER=nrf24l01_energy_observe. Each CE edge and each
+ * CONFIG or RF_SETUP write closes the time spent in the previous state:
+ * Power Down, Standby-I, RX (PRX with CE high) or active PTX (CE high).
+ * Active PTX time is split using the payloads written: every one is
+ * counted as one transmission (settling plus packet on air, at the
+ * rf_output_power in use) and, unless sent without ACK, one ACK
+ * reception; what is left is Standby-II. Retransmissions are not seen,
+ * so the TX figures are a lower bound on lossy links. ACK payloads a PRX
+ * writes are each counted as one transmission taken out of its RX time,
+ * not as packets sent.
+ *
+ * A table of currents, by default the typical values of the nRF24L01+
+ * datasheet, turns the times into charge. Times are kept in 64-bit µs and
+ * charge is worked out in pC, so a device can be observed for years.
+ *
+ * Observed devices are registered in a table of NRF24L01_ENERGY_MAX_DEVICES
+ * entries; the observer runs in the context of the driver call that
+ * changed the state.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_energy energy;
+ * nrf24l01_energy_init(&energy, &nrf, NULL);          // datasheet currents
+ * ...
+ * nrf24l01_energy_report report;
+ * nrf24l01_energy_get_report(&energy, &report);
+ * printf("%lu nA average, %lu nC per packet sent\n", report.average_current, report.charge_per_tx_packet);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_ENERGY_H
+#define NRF24L01_DRIVER_NRF24L01_ENERGY_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_ENERGY Energy Accounting
+ * @brief Time-in-state accumulators and a current model
+ * @{
+ */
+
+#ifndef NRF24L01_ENERGY_MAX_DEVICES
+/** @brief Devices that can be observed at once */
+#define NRF24L01_ENERGY_MAX_DEVICES   4
+#endif
+
+/**
+ * @brief States time is accounted to
+ */
+typedef enum {
+    nrf24l01_energy_power_down = 0,        /**< Power Down */
+    nrf24l01_energy_standby_1,             /**< Standby-I */
+    nrf24l01_energy_standby_2,             /**< Standby-II, active PTX between transmissions */
+    nrf24l01_energy_rx,                    /**< RX, listening or waiting for an ACK */
+    nrf24l01_energy_tx_minus18dbm,         /**< TX at -18 dBm */
+    nrf24l01_energy_tx_minus12dbm,         /**< TX at -12 dBm */
+    nrf24l01_energy_tx_minus6dbm,          /**< TX at -6 dBm */
+    nrf24l01_energy_tx_0dbm,               /**< TX at 0 dBm */
+    nrf24l01_energy_state_count            /**< Number of states */
+} nrf24l01_energy_state;
+
+/**
+ * @brief Supply current per state, nA
+ */
+typedef struct {
+    uint32_t current[nrf24l01_energy_state_count];   /**< Indexed by nrf24l01_energy_state */
+} nrf24l01_energy_currents;
+
+/**
+ * @brief Accounting of one device
+ */
+typedef struct {
+    nrf24l01_device * device;                        /**< Observed radio */
+    nrf24l01_energy_currents currents;               /**< Current model */
+    uint8_t config;                                  /**< CONFIG as last written */
+    uint8_t ce;                                      /**< CE level */
+    uint8_t rf_power;                                /**< RF_PWR as last written */
+    uint16_t last_us;                                /**< Time of the last event, µs */
+    uint32_t last_ms;                                /**< Time of the last event, ms */
+    uint64_t time_power_down;                        /**< Measured, µs */
+    uint64_t time_standby_1;                         /**< Measured, µs */
+    uint64_t time_rx;                                /**< Measured PRX listening, µs */
+    uint64_t time_ptx_active;                        /**< Measured PTX with CE high, µs */
+    uint64_t time_tx[4];                             /**< Estimated TX per rf_output_power, µs */
+    uint64_t time_ack;                               /**< Estimated ACK reception, µs */
+    uint64_t time_ack_payload[4];                    /**< Estimated ACK payloads sent within time_rx, per rf_output_power, µs */
+    uint32_t tx_packets;                             /**< Payloads written, ACK payloads aside */
+    uint32_t ack_payloads;                           /**< ACK payloads written */
+    uint32_t rx_packets;                             /**< Payloads read */
+} nrf24l01_energy;
+
+/**
+ * @brief Figures derived from the accumulators
+ */
+typedef struct {
+    uint64_t time[nrf24l01_energy_state_count];      /**< Time per state, µs */
+    uint64_t elapsed;                                /**< Time observed, µs */
+    uint64_t charge;                                 /**< Total charge, nC */
+    uint32_t average_current;                        /**< Charge over time, nA */
+    uint32_t charge_per_tx_packet;                   /**< TX, ACK and Standby-II charge per payload sent, nC */
+    uint32_t charge_per_rx_packet;                   /**< Listening and ACK payload charge per payload received, nC */
+} nrf24l01_energy_report;
+
+/**
+ * @brief Typical currents of the nRF24L01+ datasheet at 3 V, 2 Mbps
+ * @return Current table
+ */
+nrf24l01_energy_currents nrf24l01_energy_default_currents(void);
+
+/**
+ * @brief Start observing a device
+ * @param energy Pointer to accounting
+ * @param device Pointer to an initialized device
+ * @param currents Current table, NULL for the datasheet values
+ * @return 0 on success, non-zero when the device table is full or on error
+ *
+ * Reads CONFIG, RF_SETUP and CE once; starting again on the same device
+ * restarts its accounting.
+ */
+uint8_t nrf24l01_energy_init(nrf24l01_energy * energy, nrf24l01_device * device, const nrf24l01_energy_currents * currents);
+
+/**
+ * @brief Stop observing a device
+ * @param energy Pointer to accounting
+ */
+void nrf24l01_energy_deinit(nrf24l01_energy * energy);
+
+/**
+ * @brief Observer for NRF24L01_OBSERVER
+ * @param device Device the event happened on
+ * @param event What happened
+ * @param value Event value
+ */
+void nrf24l01_energy_observe(nrf24l01_device * device, nrf24l01_observe_event event, uint8_t value);
+
+/**
+ * @brief Bring the accumulators up to now and derive the figures
+ * @param energy Pointer to accounting
+ * @param report Pointer to report to fill
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_energy_get_report(nrf24l01_energy * energy, nrf24l01_energy_report * report);
+
+/** @} */ // End of NRF24L01_ENERGY group
+
+#endif //NRF24L01_DRIVER_NRF24L01_ENERGY_H
@@ -0,0 +1,64 @@
+#include "nrf24l01_events.h"
+
+// reads the RX FIFO until empty, returns STATUS of the last transaction
+static uint8_t nrf24l01_events_drain(nrf24l01_events * events, uint8_t status_register){
+  nrf24l01_device * device = events->device;
+  nrf24l01_events_payload_handler handler = device->primary_rx ? events->on_rx : events->on_ack_payload;
+  uint8_t data[32];
+  uint8_t pipe = NRF24L01_FIELD_GET(RX_P_NO, status_register);
+
+  while (pipe <= 5){
+    uint8_t length = device->data_pipe[pipe].nrf24l01_data_pipe_payload_width;
+    if (device->dynamic_payload_length_enable && device->data_pipe[pipe].nrf24l01_data_pipe_dyn_payload_length_enable){
+      nrf24l01_read_rx_payload_width(device, &length);
+      if (length < 1 || length > 32){
+        // corrupted length, the datasheet asks for a flush
+        return nrf24l01_flush_rx(device);
+      }
+    }
+    if (length < 1 || length > 32) length = 32;
+
+    nrf24l01_read_rx_payload(device, data, length);
+    if (handler != NULL) handler(pipe, data, length, events->context);
+
+    status_register = nrf24l01_nop(device);
+    pipe = NRF24L01_FIELD_GET(RX_P_NO, status_register);
+  }
+  return status_register;
+}
+
+uint8_t nrf24l01_events_init(nrf24l01_events * events, nrf24l01_device * device, void * context){
+  if (events == NULL || device == NULL) return -1;
+  memset(events, 0, sizeof(nrf24l01_events));
+  events->device = device;
+  events->context = context;
+  return 0;
+}
+
+uint8_t nrf24l01_process(nrf24l01_events * events){
+  if (events == NULL || events->device == NULL) return -1;
+  nrf24l01_device * device = events->device;
+
+  uint8_t status_register = nrf24l01_nop(device);
+  uint8_t first_status = status_register;
+  uint8_t pending = status_register & (RX_DR | TX_DS | MAX_RT);
+
+  for (uint8_t round = 0; round < NRF24L01_EVENTS_MAX_ROUNDS; round++){
+    if (pending & RX_DR || NRF24L01_FIELD_GET(RX_P_NO, status_register) <= 5)
+      nrf24l01_events_drain(events, status_register);
+    if (pending & TX_DS && events->on_tx_done != NULL) events->on_tx_done(events->context);
+    if (pending & MAX_RT && events->on_max_rt != NULL) events->on_max_rt(events->context);
+    if (pending == 0) break;
+
+    // one write clears everything handled; it shifts out STATUS as it was before
+    uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+    status_register = nrf24l01_clear_interrupt_flags(device, pending);
+    if (chip_enabled) nrf24l01_chip_enable(device);
+
+    // flags raised while the callbacks ran keep the IRQ line low, serve them now
+    pending = status_register & (RX_DR | TX_DS | MAX_RT) & ~pending;
+    if (pending == 0 && NRF24L01_FIELD_GET(RX_P_NO, status_register) > 5) break;
+  }
+
+  return first_status;
+}
@@ -0,0 +1,100 @@
+/**
+ * @file nrf24l01_events.h
+ * @brief Event dispatcher: callbacks instead of STATUS polling
+ *
+ * The application registers the callbacks it cares about and calls
+ * nrf24l01_process() when the IRQ line falls, or from the main loop. One
+ * call reads STATUS once, empties the RX FIFO, reports TX_DS and MAX_RT,
+ * and clears every handled flag with a single STATUS write. Between IRQs
+ * the MCU can sleep (WFI) instead of polling with nrf24l01_nop().
+ *
+ * Payloads received while the radio is PTX are ACK payloads and go to
+ * on_ack_payload; on a PRX they go to on_rx. When both TX_DS and RX_DR
+ * are set, the ACK payload is reported before on_tx_done. Callbacks run
+ * in the context that called nrf24l01_process() and may use the driver,
+ * e.g. flush the TX FIFO from on_max_rt.
+ *
+ * @par Example Usage:
+ * @code
+ * static void on_rx(uint8_t pipe, const uint8_t * data, uint8_t length, void * context){ ... }
+ * static void on_tx_done(void * context){ ... }
+ *
+ * static nrf24l01_events events;
+ * nrf24l01_events_init(&events, &nrf, NULL);
+ * events.on_rx = on_rx;
+ * events.on_tx_done = on_tx_done;
+ *
+ * // EXTI callback of the IRQ pin (falling edge)
+ * nrf24l01_process(&events);
+ *
+ * // main loop
+ * __WFI();
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_EVENTS_H
+#define NRF24L01_DRIVER_NRF24L01_EVENTS_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_EVENTS Event Dispatcher
+ * @brief Callbacks for received payloads, sent payloads and retransmit failures
+ * @{
+ */
+
+#ifndef NRF24L01_EVENTS_MAX_ROUNDS
+/** @brief Passes of nrf24l01_process() over events that arrive while it runs */
+#define NRF24L01_EVENTS_MAX_ROUNDS   4
+#endif
+
+/**
+ * @brief Payload callback
+ * @param pipe Receiving pipe (0-5)
+ * @param data Payload
+ * @param length Payload length (1-32)
+ * @param context User context
+ */
+typedef void (*nrf24l01_events_payload_handler)(uint8_t pipe, const uint8_t * data, uint8_t length, void * context);
+
+/**
+ * @brief Transmit event callback
+ * @param context User context
+ */
+typedef void (*nrf24l01_events_tx_handler)(void * context);
+
+/**
+ * @brief Dispatcher instance, one per device
+ *
+ * Callbacks left NULL are skipped; their flags are cleared all the same.
+ */
+typedef struct {
+    nrf24l01_device * device;                       /**< Radio served */
+    nrf24l01_events_payload_handler on_rx;          /**< Payload received (PRX) */
+    nrf24l01_events_payload_handler on_ack_payload; /**< ACK payload received (PTX) */
+    nrf24l01_events_tx_handler on_tx_done;          /**< TX_DS: payload sent and acknowledged */
+    nrf24l01_events_tx_handler on_max_rt;           /**< MAX_RT: retransmits exhausted, payload still in the TX FIFO */
+    void * context;                                 /**< Passed to every callback */
+} nrf24l01_events;
+
+/**
+ * @brief Initialize a dispatcher without callbacks
+ * @param events Pointer to dispatcher instance
+ * @param device Pointer to an initialized device
+ * @param context Passed to every callback
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_events_init(nrf24l01_events * events, nrf24l01_device * device, void * context);
+
+/**
+ * @brief Service every pending event
+ * @param events Pointer to dispatcher instance
+ * @return STATUS register as read at the start, or -1 on error
+ *
+ * CE keeps its level: it is dropped only around the STATUS write.
+ */
+uint8_t nrf24l01_process(nrf24l01_events * events);
+
+/** @} */ // End of NRF24L01_EVENTS group
+
+#endif //NRF24L01_DRIVER_NRF24L01_EVENTS_H
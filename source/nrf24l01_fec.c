@@ -0,0 +1,233 @@
+#include "nrf24l01_fec.h"
+
+/* GF(2^8) antilog table, primitive polynomial x^8 + x^4 + x^3 + x^2 + 1, doubled to skip the mod 255 */
+static const uint8_t nrf24l01_fec_exp[512] = {
+  0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26,
+  0x4c, 0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0,
+  0x9d, 0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23,
+  0x46, 0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1,
+  0x5f, 0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc, 0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0,
+  0xfd, 0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2,
+  0xd9, 0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce,
+  0x81, 0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93, 0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc,
+  0x85, 0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54,
+  0xa8, 0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73,
+  0xe6, 0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e, 0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff,
+  0xe3, 0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41,
+  0x82, 0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6,
+  0x51, 0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef, 0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09,
+  0x12, 0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16,
+  0x2c, 0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x01,
+  0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1d, 0x3a, 0x74, 0xe8, 0xcd, 0x87, 0x13, 0x26, 0x4c,
+  0x98, 0x2d, 0x5a, 0xb4, 0x75, 0xea, 0xc9, 0x8f, 0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x9d,
+  0x27, 0x4e, 0x9c, 0x25, 0x4a, 0x94, 0x35, 0x6a, 0xd4, 0xb5, 0x77, 0xee, 0xc1, 0x9f, 0x23, 0x46,
+  0x8c, 0x05, 0x0a, 0x14, 0x28, 0x50, 0xa0, 0x5d, 0xba, 0x69, 0xd2, 0xb9, 0x6f, 0xde, 0xa1, 0x5f,
+  0xbe, 0x61, 0xc2, 0x99, 0x2f, 0x5e, 0xbc, 0x65, 0xca, 0x89, 0x0f, 0x1e, 0x3c, 0x78, 0xf0, 0xfd,
+  0xe7, 0xd3, 0xbb, 0x6b, 0xd6, 0xb1, 0x7f, 0xfe, 0xe1, 0xdf, 0xa3, 0x5b, 0xb6, 0x71, 0xe2, 0xd9,
+  0xaf, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0d, 0x1a, 0x34, 0x68, 0xd0, 0xbd, 0x67, 0xce, 0x81,
+  0x1f, 0x3e, 0x7c, 0xf8, 0xed, 0xc7, 0x93, 0x3b, 0x76, 0xec, 0xc5, 0x97, 0x33, 0x66, 0xcc, 0x85,
+  0x17, 0x2e, 0x5c, 0xb8, 0x6d, 0xda, 0xa9, 0x4f, 0x9e, 0x21, 0x42, 0x84, 0x15, 0x2a, 0x54, 0xa8,
+  0x4d, 0x9a, 0x29, 0x52, 0xa4, 0x55, 0xaa, 0x49, 0x92, 0x39, 0x72, 0xe4, 0xd5, 0xb7, 0x73, 0xe6,
+  0xd1, 0xbf, 0x63, 0xc6, 0x91, 0x3f, 0x7e, 0xfc, 0xe5, 0xd7, 0xb3, 0x7b, 0xf6, 0xf1, 0xff, 0xe3,
+  0xdb, 0xab, 0x4b, 0x96, 0x31, 0x62, 0xc4, 0x95, 0x37, 0x6e, 0xdc, 0xa5, 0x57, 0xae, 0x41, 0x82,
+  0x19, 0x32, 0x64, 0xc8, 0x8d, 0x07, 0x0e, 0x1c, 0x38, 0x70, 0xe0, 0xdd, 0xa7, 0x53, 0xa6, 0x51,
+  0xa2, 0x59, 0xb2, 0x79, 0xf2, 0xf9, 0xef, 0xc3, 0x9b, 0x2b, 0x56, 0xac, 0x45, 0x8a, 0x09, 0x12,
+  0x24, 0x48, 0x90, 0x3d, 0x7a, 0xf4, 0xf5, 0xf7, 0xf3, 0xfb, 0xeb, 0xcb, 0x8b, 0x0b, 0x16, 0x2c,
+  0x58, 0xb0, 0x7d, 0xfa, 0xe9, 0xcf, 0x83, 0x1b, 0x36, 0x6c, 0xd8, 0xad, 0x47, 0x8e, 0x01, 0x02
+};
+
+/* GF(2^8) log table, log(0) is undefined and stored as 0 */
+static const uint8_t nrf24l01_fec_log[256] = {
+  0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1a, 0xc6, 0x03, 0xdf, 0x33, 0xee, 0x1b, 0x68, 0xc7, 0x4b,
+  0x04, 0x64, 0xe0, 0x0e, 0x34, 0x8d, 0xef, 0x81, 0x1c, 0xc1, 0x69, 0xf8, 0xc8, 0x08, 0x4c, 0x71,
+  0x05, 0x8a, 0x65, 0x2f, 0xe1, 0x24, 0x0f, 0x21, 0x35, 0x93, 0x8e, 0xda, 0xf0, 0x12, 0x82, 0x45,
+  0x1d, 0xb5, 0xc2, 0x7d, 0x6a, 0x27, 0xf9, 0xb9, 0xc9, 0x9a, 0x09, 0x78, 0x4d, 0xe4, 0x72, 0xa6,
+  0x06, 0xbf, 0x8b, 0x62, 0x66, 0xdd, 0x30, 0xfd, 0xe2, 0x98, 0x25, 0xb3, 0x10, 0x91, 0x22, 0x88,
+  0x36, 0xd0, 0x94, 0xce, 0x8f, 0x96, 0xdb, 0xbd, 0xf1, 0xd2, 0x13, 0x5c, 0x83, 0x38, 0x46, 0x40,
+  0x1e, 0x42, 0xb6, 0xa3, 0xc3, 0x48, 0x7e, 0x6e, 0x6b, 0x3a, 0x28, 0x54, 0xfa, 0x85, 0xba, 0x3d,
+  0xca, 0x5e, 0x9b, 0x9f, 0x0a, 0x15, 0x79, 0x2b, 0x4e, 0xd4, 0xe5, 0xac, 0x73, 0xf3, 0xa7, 0x57,
+  0x07, 0x70, 0xc0, 0xf7, 0x8c, 0x80, 0x63, 0x0d, 0x67, 0x4a, 0xde, 0xed, 0x31, 0xc5, 0xfe, 0x18,
+  0xe3, 0xa5, 0x99, 0x77, 0x26, 0xb8, 0xb4, 0x7c, 0x11, 0x44, 0x92, 0xd9, 0x23, 0x20, 0x89, 0x2e,
+  0x37, 0x3f, 0xd1, 0x5b, 0x95, 0xbc, 0xcf, 0xcd, 0x90, 0x87, 0x97, 0xb2, 0xdc, 0xfc, 0xbe, 0x61,
+  0xf2, 0x56, 0xd3, 0xab, 0x14, 0x2a, 0x5d, 0x9e, 0x84, 0x3c, 0x39, 0x53, 0x47, 0x6d, 0x41, 0xa2,
+  0x1f, 0x2d, 0x43, 0xd8, 0xb7, 0x7b, 0xa4, 0x76, 0xc4, 0x17, 0x49, 0xec, 0x7f, 0x0c, 0x6f, 0xf6,
+  0x6c, 0xa1, 0x3b, 0x52, 0x29, 0x9d, 0x55, 0xaa, 0xfb, 0x60, 0x86, 0xb1, 0xbb, 0xcc, 0x3e, 0x5a,
+  0xcb, 0x59, 0x5f, 0xb0, 0x9c, 0xa9, 0xa0, 0x51, 0x0b, 0xf5, 0x16, 0xeb, 0x7a, 0x75, 0x2c, 0xd7,
+  0x4f, 0xae, 0xd5, 0xe9, 0xe6, 0xe7, 0xad, 0xe8, 0x74, 0xd6, 0xf4, 0xea, 0xa8, 0x50, 0x58, 0xaf
+};
+
+/* generator polynomial g(x) = (x + a^0)(x + a^1)...(x + a^(parity - 1)),
+   gen[i] multiplies x^i, gen[NRF24L01_FEC_PARITY] = 1 */
+static const uint8_t nrf24l01_fec_generator[NRF24L01_FEC_PARITY + 1] = {
+#if NRF24L01_FEC_PARITY == 2
+  0x02, 0x03, 0x01
+#elif NRF24L01_FEC_PARITY == 4
+  0x40, 0x78, 0x36, 0x0f, 0x01
+#elif NRF24L01_FEC_PARITY == 6
+  0x26, 0xe3, 0x20, 0xda, 0x01, 0x3f, 0x01
+#elif NRF24L01_FEC_PARITY == 8
+  0x18, 0xc8, 0xad, 0xef, 0x36, 0x51, 0x0b, 0xff, 0x01
+#elif NRF24L01_FEC_PARITY == 10
+  0xc1, 0x9d, 0x71, 0x5f, 0x5e, 0xc7, 0x6f, 0x9f, 0xc2, 0xd8, 0x01
+#elif NRF24L01_FEC_PARITY == 12
+  0x61, 0xd5, 0x7f, 0x5c, 0x54, 0x07, 0x1f, 0xdc, 0x76, 0x43, 0x77, 0x44, 0x01
+#elif NRF24L01_FEC_PARITY == 14
+  0xa3, 0xea, 0xd2, 0xa6, 0x7f, 0xc3, 0x9e, 0x2b, 0x97, 0xae, 0x46, 0x72, 0x36, 0x0e, 0x01
+#elif NRF24L01_FEC_PARITY == 16
+  0x3b, 0x24, 0x32, 0x62, 0xe5, 0x29, 0x41, 0xa3, 0x08, 0x1e, 0xd1, 0x44, 0xbd, 0x68, 0x0d, 0x3b, 0x01
+#endif
+};
+
+static inline uint8_t nrf24l01_fec_mul(uint8_t a, uint8_t b){
+  if (a == 0 || b == 0) return 0;
+  return nrf24l01_fec_exp[nrf24l01_fec_log[a] + nrf24l01_fec_log[b]];
+}
+
+static inline uint8_t nrf24l01_fec_div(uint8_t a, uint8_t b){
+  if (a == 0) return 0;
+  return nrf24l01_fec_exp[nrf24l01_fec_log[a] + 255 - nrf24l01_fec_log[b]];
+}
+
+// alpha^power for any non-negative power
+static inline uint8_t nrf24l01_fec_pow(uint16_t power){
+  return nrf24l01_fec_exp[power % 255];
+}
+
+uint8_t nrf24l01_fec_encode(const uint8_t * data, uint8_t length, uint8_t * frame){
+  uint8_t * parity;
+  if (data == NULL || frame == NULL) return -1;
+  if (length < 1 || length > NRF24L01_FEC_MAX_DATA) return -1; // invalid data length
+
+  memmove(frame, data, length);
+  parity = frame + length;
+  memset(parity, 0, NRF24L01_FEC_PARITY);
+
+  // systematic encoding: parity = data(x) * x^parity mod g(x), parity[0] is the highest degree
+  for (uint8_t i = 0; i < length; i++){
+    uint8_t feedback = frame[i] ^ parity[0];
+    for (uint8_t j = 0; j < NRF24L01_FEC_PARITY - 1; j++)
+      parity[j] = parity[j + 1] ^ nrf24l01_fec_mul(feedback, nrf24l01_fec_generator[NRF24L01_FEC_PARITY - 1 - j]);
+    parity[NRF24L01_FEC_PARITY - 1] = nrf24l01_fec_mul(feedback, nrf24l01_fec_generator[0]);
+  }
+
+  return length + NRF24L01_FEC_PARITY;
+}
+
+uint8_t nrf24l01_fec_decode(uint8_t * frame, uint8_t frame_length, uint8_t * corrected){
+  uint8_t syndrome[NRF24L01_FEC_PARITY];
+  uint8_t locator[NRF24L01_FEC_PARITY + 1], previous[NRF24L01_FEC_PARITY + 1], temp[NRF24L01_FEC_PARITY + 1];
+  uint8_t evaluator[NRF24L01_FEC_PARITY];
+  uint8_t errors = 0, any = 0;
+
+  if (corrected != NULL) *corrected = 0;
+  if (frame == NULL) return -1;
+  if (frame_length <= NRF24L01_FEC_PARITY || frame_length > 32) return -1; // invalid frame length
+
+  // syndromes S_i = r(a^i), first byte is the highest degree coefficient
+  for (uint8_t i = 0; i < NRF24L01_FEC_PARITY; i++){
+    uint8_t s = 0;
+    for (uint8_t p = 0; p < frame_length; p++)
+      s = nrf24l01_fec_mul(s, nrf24l01_fec_exp[i]) ^ frame[p];
+    syndrome[i] = s;
+    any |= s;
+  }
+  if (!any) return frame_length - NRF24L01_FEC_PARITY; // no errors
+
+  // Berlekamp-Massey: error locator polynomial
+  uint8_t degree = 0, shift = 1, last_discrepancy = 1;
+  memset(locator, 0, sizeof(locator));
+  memset(previous, 0, sizeof(previous));
+  locator[0] = previous[0] = 1;
+
+  for (uint8_t n = 0; n < NRF24L01_FEC_PARITY; n++){
+    uint8_t discrepancy = syndrome[n];
+    for (uint8_t i = 1; i <= degree; i++)
+      discrepancy ^= nrf24l01_fec_mul(locator[i], syndrome[n - i]);
+
+    if (discrepancy == 0){
+      shift++;
+      continue;
+    }
+
+    uint8_t scale = nrf24l01_fec_div(discrepancy, last_discrepancy);
+    memcpy(temp, locator, sizeof(locator));
+    for (uint8_t i = 0; i + shift <= NRF24L01_FEC_PARITY; i++)
+      locator[i + shift] ^= nrf24l01_fec_mul(scale, previous[i]);
+
+    if (2 * degree <= n){
+      degree = n + 1 - degree;
+      memcpy(previous, temp, sizeof(locator));
+      last_discrepancy = discrepancy;
+      shift = 1;
+    }
+    else
+      shift++;
+  }
+  if (degree > NRF24L01_FEC_PARITY / 2) return -1; // too many errors
+
+  // error evaluator: S(x) * locator(x) mod x^parity
+  for (uint8_t k = 0; k < NRF24L01_FEC_PARITY; k++){
+    evaluator[k] = 0;
+    for (uint8_t j = 0; j <= k && j <= degree; j++)
+      evaluator[k] ^= nrf24l01_fec_mul(locator[j], syndrome[k - j]);
+  }
+
+  // Chien search over the positions of the shortened code, Forney for the values
+  for (uint8_t p = 0; p < frame_length; p++){
+    uint8_t position = frame_length - 1 - p;
+    uint8_t x_inverse = nrf24l01_fec_pow(255 - position);
+    uint8_t value = 0, x_power = 1;
+    for (uint8_t i = 0; i <= degree; i++){
+      value ^= nrf24l01_fec_mul(locator[i], x_power);
+      x_power = nrf24l01_fec_mul(x_power, x_inverse);
+    }
+    if (value != 0) continue;
+
+    uint8_t numerator = 0, denominator = 0, x_previous = 0;
+    x_power = 1;
+    for (uint8_t k = 0; k < NRF24L01_FEC_PARITY; k++){
+      numerator ^= nrf24l01_fec_mul(evaluator[k], x_power);
+      // formal derivative keeps the odd terms only: locator_k * x^(k - 1)
+      if ((k & 1) && k <= degree)
+        denominator ^= nrf24l01_fec_mul(locator[k], x_previous);
+      x_previous = x_power;
+      x_power = nrf24l01_fec_mul(x_power, x_inverse);
+    }
+    if (denominator == 0) return -1;
+
+    frame[p] ^= nrf24l01_fec_mul(nrf24l01_fec_pow(position), nrf24l01_fec_div(numerator, denominator));
+    errors++;
+  }
+  if (errors != degree) return -1; // locator roots outside the frame: uncorrectable
+
+  if (corrected != NULL) *corrected = errors;
+  return frame_length - NRF24L01_FEC_PARITY;
+}
+
+uint8_t nrf24l01_fec_write_tx_payload(nrf24l01_device * device, uint8_t * data, uint16_t length){
+  uint8_t frame[32];
+  if (device == NULL || data == NULL) return -1;
+  if (length < 1 || length > NRF24L01_FEC_MAX_DATA) return -1; // invalid data length
+
+  uint8_t frame_length = nrf24l01_fec_encode(data, length, frame);
+
+  return nrf24l01_write_tx_payload(device, frame, frame_length);
+}
+
+uint8_t nrf24l01_fec_read_rx_payload(nrf24l01_device * device, uint8_t * data, uint16_t frame_length, uint8_t * length){
+  uint8_t status_register = 0, data_length = 0;
+  uint8_t frame[32];
+  if (device == NULL || data == NULL || length == NULL) return -1;
+  *length = 0;
+  if (frame_length <= NRF24L01_FEC_PARITY || frame_length > 32) return -1; // invalid frame length
+
+  status_register = nrf24l01_read_rx_payload(device, frame, frame_length);
+
+  data_length = nrf24l01_fec_decode(frame, frame_length, NULL);
+  if (data_length != (uint8_t)-1){
+    memcpy(data, frame, data_length);
+    *length = data_length;
+  }
+
+  return status_register;
+}
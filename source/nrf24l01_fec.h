@@ -0,0 +1,96 @@
+/**
+ * @file nrf24l01_fec.h
+ * @brief Reed-Solomon forward error correction for nRF24L01 payloads
+ *
+ * On a marginal link a single flipped bit costs a full retransmit cycle
+ * (ARD plus air time, up to auto_retransmit_count times). This module adds a
+ * shortened Reed-Solomon code over GF(2^8) to the payload: NRF24L01_FEC_PARITY
+ * parity bytes are appended on transmit and up to NRF24L01_FEC_PARITY / 2
+ * corrupted bytes are repaired on receive. The code works on whole bytes, so
+ * a burst of bit errors inside one byte counts as a single error.
+ *
+ * Encoding and decoding are table driven (GF(2^8) log/antilog tables and
+ * the generator polynomial, all constant and in flash). Encoding costs NRF24L01_FEC_PARITY table lookups per data byte.
+ * Decoding an error-free frame costs NRF24L01_FEC_PARITY lookups per byte for
+ * the syndromes; correction work is only done when a syndrome is non-zero.
+ *
+ * With FEC in place the chip CRC can be shortened or disabled with
+ * nrf24l01_crc(). The chip forces CRC on whenever auto-acknowledgment is
+ * enabled on a pipe.
+ *
+ * @par Example Usage:
+ * @code
+ * // PTX, 24 data bytes + 8 parity bytes = 32 byte frame
+ * nrf24l01_fec_write_tx_payload(&nrf, data, 24);
+ *
+ * // PRX, static payload width of 32 on the pipe
+ * uint8_t data[NRF24L01_FEC_MAX_DATA], length;
+ * nrf24l01_fec_read_rx_payload(&nrf, data, 32, &length);
+ * if (length > 0)
+ *     handle(data, length);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_FEC_H
+#define NRF24L01_DRIVER_NRF24L01_FEC_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_FEC Forward Error Correction
+ * @brief Shortened Reed-Solomon code over the payload
+ * @{
+ */
+
+#ifndef NRF24L01_FEC_PARITY
+/** @brief Parity bytes per frame (even, 2-16), corrects half as many bytes */
+#define NRF24L01_FEC_PARITY    8
+#endif
+
+#if NRF24L01_FEC_PARITY < 2 || NRF24L01_FEC_PARITY > 16 || (NRF24L01_FEC_PARITY % 2) != 0
+#error "NRF24L01_FEC_PARITY must be an even number between 2 and 16"
+#endif
+
+/** @brief Largest number of data bytes in one frame */
+#define NRF24L01_FEC_MAX_DATA  (32 - NRF24L01_FEC_PARITY)
+
+/**
+ * @brief Encode data into a frame
+ * @param data Pointer to data bytes
+ * @param length Number of data bytes (1 to NRF24L01_FEC_MAX_DATA)
+ * @param frame Pointer to output buffer, length + NRF24L01_FEC_PARITY bytes
+ * @return Frame length, 0xFF on error
+ */
+uint8_t nrf24l01_fec_encode(const uint8_t * data, uint8_t length, uint8_t * frame);
+
+/**
+ * @brief Correct a frame in place
+ * @param frame Pointer to received frame
+ * @param frame_length Frame length, parity included
+ * @param corrected Set to the number of corrected bytes, may be NULL
+ * @return Number of data bytes at the start of frame, 0xFF if uncorrectable
+ */
+uint8_t nrf24l01_fec_decode(uint8_t * frame, uint8_t frame_length, uint8_t * corrected);
+
+/**
+ * @brief Encode and write a TX payload
+ * @param device Pointer to device configuration structure
+ * @param data Pointer to data bytes
+ * @param length Number of data bytes (1 to NRF24L01_FEC_MAX_DATA)
+ * @return Status register value
+ */
+uint8_t nrf24l01_fec_write_tx_payload(nrf24l01_device * device, uint8_t * data, uint16_t length);
+
+/**
+ * @brief Read and decode the top RX payload
+ * @param device Pointer to device configuration structure
+ * @param data Pointer to buffer for the decoded data
+ * @param frame_length Length of the received frame, parity included
+ * @param length Set to the number of decoded bytes, 0 if the frame was uncorrectable
+ * @return Status register value
+ */
+uint8_t nrf24l01_fec_read_rx_payload(nrf24l01_device * device, uint8_t * data, uint16_t frame_length, uint8_t * length);
+
+/** @} */ // End of NRF24L01_FEC group
+
+#endif //NRF24L01_DRIVER_NRF24L01_FEC_H
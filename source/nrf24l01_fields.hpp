@@ -0,0 +1,199 @@
+/**
+ * @file nrf24l01_fields.hpp
+ * @brief Typed register fields for C++ (constexpr counterpart of NRF24L01_FIELD_*)
+ *
+ * Every register of nrf24l01.h is a namespace holding its address and one
+ * Field type per bit or bit group. A Field knows its register, mask and
+ * shift, so reads and writes are a mask and a shift, and constant values
+ * that do not fit the field are rejected by static_assert.
+ *
+ * Header only, C++17.
+ *
+ * @par Example Usage:
+ * @code
+ * namespace f = nrf24l01::fields;
+ *
+ * // SETUP_RETR = 750 µs, 5 retransmits; set<16>() would not compile
+ * uint8_t setup_retr = f::setup_retr::ard::set<2>() | f::setup_retr::arc::set<5>();
+ * nrf24l01_write_register(&nrf, f::setup_retr::address, &setup_retr, 1);
+ *
+ * // ISR: one NOP, decoded in registers
+ * auto status = f::status::decode(nrf24l01_nop(&nrf));
+ * if (status.irq & RX_DR) handle(status.pipe);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_FIELDS_HPP
+#define NRF24L01_DRIVER_NRF24L01_FIELDS_HPP
+
+#include <cstdint>
+#include "nrf24l01.h"
+
+namespace nrf24l01 {
+namespace fields {
+
+/**
+ * @defgroup NRF24L01_FIELDS_CPP C++ Register Fields
+ * @brief Compile-time described registers and fields
+ * @{
+ */
+
+/** @brief Index of the lowest set bit */
+constexpr uint8_t lowest_bit(uint8_t mask) noexcept {
+    uint8_t shift = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        shift++;
+    }
+    return shift;
+}
+
+/**
+ * @brief Bit group of a register
+ * @tparam Address Register address
+ * @tparam Mask Field bits in the register
+ */
+template <uint8_t Address, uint8_t Mask>
+struct Field {
+    static_assert(Mask != 0, "empty field");
+
+    static constexpr uint8_t address = Address;              /**< Register holding the field */
+    static constexpr uint8_t mask = Mask;                    /**< Field bits */
+    static constexpr uint8_t shift = lowest_bit(Mask);       /**< Position of the lowest field bit */
+    static constexpr uint8_t max = Mask >> shift;            /**< Largest field value */
+
+    /** @brief Field value in a register value */
+    static constexpr uint8_t get(uint8_t reg) noexcept { return (reg & mask) >> shift; }
+
+    /** @brief Value in field position, bits outside the field are dropped */
+    static constexpr uint8_t prep(uint8_t value) noexcept { return static_cast<uint8_t>(value << shift) & mask; }
+
+    /** @brief Constant in field position, checked at compile time */
+    template <uint8_t Value>
+    static constexpr uint8_t set() noexcept {
+        static_assert(Value <= max, "value does not fit the register field");
+        return Value << shift;
+    }
+
+    /** @brief Register value with this field replaced */
+    static constexpr uint8_t set(uint8_t reg, uint8_t value) noexcept {
+        return static_cast<uint8_t>((reg & ~mask) | prep(value));
+    }
+};
+
+namespace config {
+constexpr uint8_t address = CONFIG;
+using mask_rx_dr = Field<CONFIG, MASK_RX_DR>;
+using mask_tx_ds = Field<CONFIG, MASK_TX_DS>;
+using mask_max_rt = Field<CONFIG, MASK_MAX_RT>;
+using en_crc = Field<CONFIG, EN_CRC>;
+using crco = Field<CONFIG, CRCO>;
+using pwr_up = Field<CONFIG, PWR_UP>;
+using prim_rx = Field<CONFIG, PRIM_RX>;
+} // namespace config
+
+namespace en_aa {
+constexpr uint8_t address = EN_AA;
+using enaa = Field<EN_AA, ENAA_P5 | ENAA_P4 | ENAA_P3 | ENAA_P2 | ENAA_P1 | ENAA_P0>;
+} // namespace en_aa
+
+namespace en_rxaddr {
+constexpr uint8_t address = EN_RXADDR;
+using erx = Field<EN_RXADDR, ERX_P5 | ERX_P4 | ERX_P3 | ERX_P2 | ERX_P1 | ERX_P0>;
+} // namespace en_rxaddr
+
+namespace setup_aw {
+constexpr uint8_t address = SETUP_AW;
+using aw = Field<SETUP_AW, AW>;
+} // namespace setup_aw
+
+namespace setup_retr {
+constexpr uint8_t address = SETUP_RETR;
+using ard = Field<SETUP_RETR, ARD>;
+using arc = Field<SETUP_RETR, ARC>;
+} // namespace setup_retr
+
+namespace rf_ch {
+constexpr uint8_t address = RF_CH;
+using channel = Field<RF_CH, RF_CH_FIELD>;
+} // namespace rf_ch
+
+namespace rf_setup {
+constexpr uint8_t address = RF_SETUP;
+using pll_lock = Field<RF_SETUP, PLL_LOCK>;
+using rf_dr = Field<RF_SETUP, RF_DR>;
+using rf_pwr = Field<RF_SETUP, RF_PWR>;
+using lna_hcurr = Field<RF_SETUP, LNA_HCURR>;
+} // namespace rf_setup
+
+namespace status {
+constexpr uint8_t address = STATUS;
+using rx_dr = Field<STATUS, RX_DR>;
+using tx_ds = Field<STATUS, TX_DS>;
+using max_rt = Field<STATUS, MAX_RT>;
+using rx_p_no = Field<STATUS, RX_P_NO>;
+using tx_full = Field<STATUS, TX_FULL>;
+
+/** @brief Pipe number, interrupt flags and TX_FULL in one pass */
+constexpr nrf24l01_status decode(uint8_t value) noexcept {
+    return nrf24l01_status{rx_p_no::get(value), static_cast<uint8_t>(value & (RX_DR | TX_DS | MAX_RT)), tx_full::get(value)};
+}
+} // namespace status
+
+namespace observe_tx {
+constexpr uint8_t address = OBSERVE_TX;
+using plos_cnt = Field<OBSERVE_TX, PLOS_CNT>;
+using arc_cnt = Field<OBSERVE_TX, ARC_CNT>;
+} // namespace observe_tx
+
+namespace prd {
+constexpr uint8_t address = PRD;
+using carrier_detect = Field<PRD, CD>;
+} // namespace prd
+
+/** @brief RX_ADDR_P0 to RX_ADDR_P5 and TX_ADDR are multi-byte, no fields */
+template <uint8_t Pipe>
+struct rx_addr {
+    static_assert(Pipe <= 5, "pipe number out of range");
+    static constexpr uint8_t address = RX_ADDR_P0 + Pipe;
+};
+
+namespace tx_addr {
+constexpr uint8_t address = TX_ADDR;
+} // namespace tx_addr
+
+/** @brief RX_PW_P0 to RX_PW_P5 */
+template <uint8_t Pipe>
+struct rx_pw {
+    static_assert(Pipe <= 5, "pipe number out of range");
+    static constexpr uint8_t address = RX_PW_P0 + Pipe;
+    using width = Field<RX_PW_P0 + Pipe, RX_PW_FIELD>;
+};
+
+namespace fifo_status {
+constexpr uint8_t address = FIFO_STATUS;
+using tx_reuse = Field<FIFO_STATUS, TX_REUSE>;
+using fifo_full = Field<FIFO_STATUS, FIFO_FULL>;
+using tx_empty = Field<FIFO_STATUS, TX_EMPTY>;
+using rx_full = Field<FIFO_STATUS, RX_FULL>;
+using rx_empty = Field<FIFO_STATUS, RX_EMPTY>;
+} // namespace fifo_status
+
+namespace dynpd {
+constexpr uint8_t address = DYNPD;
+using dpl = Field<DYNPD, 0b00111111>;
+} // namespace dynpd
+
+namespace feature {
+constexpr uint8_t address = FEATURE;
+using en_dpl = Field<FEATURE, EN_DPL>;
+using en_ack_pay = Field<FEATURE, EN_ACK_PAY>;
+using en_dyn_ack = Field<FEATURE, EN_DYN_ACK>;
+} // namespace feature
+
+/** @} */ // End of NRF24L01_FIELDS_CPP group
+
+} // namespace fields
+} // namespace nrf24l01
+
+#endif //NRF24L01_DRIVER_NRF24L01_FIELDS_HPP
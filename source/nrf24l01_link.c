@@ -0,0 +1,122 @@
+#include "nrf24l01_link.h"
+
+static uint8_t nrf24l01_link_crc_bytes(nrf24l01_crc_length crc_length){
+  switch (crc_length) {
+    case nrf24l01_crc_1byte:
+      return 1;
+    case nrf24l01_crc_2bytes:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+uint16_t nrf24l01_link_air_time(nrf24l01_air_data_rate air_data_rate, nrf24l01_address_width address_width,
+                                uint8_t packet_control_field, uint8_t payload_length, nrf24l01_crc_length crc_length){
+  uint16_t bits = 8 * (1 + address_width + payload_length + nrf24l01_link_crc_bytes(crc_length));
+  if (packet_control_field)
+    bits += NRF24L01_LINK_PCF_BITS;
+
+  // 1 bit per µs at 1 Mbps, 2 at 2 Mbps
+  if (air_data_rate == nrf24l01_air_data_rate_2mbps)
+    return (bits + 1) / 2;
+  return bits;
+}
+
+uint8_t nrf24l01_link_profile_select(const nrf24l01_link_requirements * requirements, nrf24l01_link_profile * profile){
+  if (requirements == NULL || profile == NULL) return -1;
+  if (requirements->max_payload < 1 || requirements->max_payload > 32) return -1; // invalid payload length
+  if (requirements->min_payload < 1 || requirements->min_payload > requirements->max_payload) return -1;
+  if (requirements->typical_payload < requirements->min_payload ||
+      requirements->typical_payload > requirements->max_payload) return -1;
+  if (requirements->ack_payload > 32) return -1; // invalid ack payload length
+
+  memset(profile, 0, sizeof(nrf24l01_link_profile));
+  profile->air_data_rate = requirements->air_data_rate;
+
+  switch (requirements->integrity) {
+    case nrf24l01_integrity_basic:
+      profile->crc_length = nrf24l01_crc_1byte;
+      profile->address_width = nrf24l01_address_width_3bytes;
+      break;
+    case nrf24l01_integrity_standard:
+      profile->crc_length = nrf24l01_crc_2bytes;
+      profile->address_width = nrf24l01_address_width_4bytes;
+      break;
+    case nrf24l01_integrity_strict:
+    default:
+      profile->crc_length = nrf24l01_crc_2bytes;
+      profile->address_width = nrf24l01_address_width_5bytes;
+  }
+
+  // ACK payloads need DPL on both sides, varying sizes are cheaper with DPL
+  profile->auto_ack = requirements->requires_delivery || requirements->ack_payload > 0;
+  profile->dynamic_ack = profile->auto_ack && requirements->mixed_delivery;
+  profile->ack_payload = requirements->ack_payload;
+  profile->dynamic_payload = requirements->ack_payload > 0 ||
+                             (requirements->min_payload != requirements->max_payload && profile->auto_ack);
+
+  // without ACK the PCF (and so DPL) is not on air: plain ShockBurst, static width
+  uint8_t packet_control_field = profile->auto_ack;
+  if (!packet_control_field) profile->dynamic_payload = 0;
+
+  profile->payload_length = profile->dynamic_payload ? requirements->typical_payload : requirements->max_payload;
+  profile->static_payload_width = profile->dynamic_payload ? 0 : requirements->max_payload;
+
+  profile->packet_bits = 8 * (1 + profile->address_width + profile->payload_length + nrf24l01_link_crc_bytes(profile->crc_length))
+                       + (packet_control_field ? NRF24L01_LINK_PCF_BITS : 0);
+  profile->air_time = nrf24l01_link_air_time(profile->air_data_rate, profile->address_width, packet_control_field,
+                                             profile->payload_length, profile->crc_length);
+
+  profile->transaction_time = NRF24L01_LINK_SETTLING_TIME + profile->air_time;
+  if (profile->auto_ack){
+    profile->transaction_time += NRF24L01_LINK_SETTLING_TIME;
+    profile->transaction_time += nrf24l01_link_air_time(profile->air_data_rate, profile->address_width, 1,
+                                                        requirements->ack_payload, profile->crc_length);
+  }
+
+  // NOACK: the PCF stays on air, only the turnaround and the ACK go
+  if (profile->dynamic_ack)
+    profile->no_ack_transaction_time = NRF24L01_LINK_SETTLING_TIME + profile->air_time;
+
+  profile->max_packets_per_second = 1000000UL / profile->transaction_time;
+
+  return 0;
+}
+
+uint8_t nrf24l01_link_profile_apply(nrf24l01_device * device, const nrf24l01_link_profile * profile){
+  if (device == NULL || profile == NULL) return -1;
+
+  device->crc_length = profile->crc_length;
+  device->address_width = profile->address_width;
+  device->air_data_rate = profile->air_data_rate;
+  device->dynamic_payload_length_enable = profile->dynamic_payload;
+  device->payload_with_ack_enable = profile->ack_payload > 0;
+  device->dynamic_ack_enable = profile->dynamic_ack;
+  if (!profile->auto_ack)
+    device->auto_retransmit_count = nrf24l01_auto_retransmit_count_disable;
+  else if (device->auto_retransmit_count == nrf24l01_auto_retransmit_count_disable)
+    // left disabled by an earlier profile without ACK
+    device->auto_retransmit_count = nrf24l01_auto_retransmit_count_3;
+
+  // the ACK payload has to fit in the retransmit delay (datasheet 7.4.2)
+  uint8_t long_ack = profile->air_data_rate == nrf24l01_air_data_rate_1mbps ? profile->ack_payload > 5 : profile->ack_payload > 15;
+  if (long_ack && device->auto_retransmit_delay < nrf24l01_auto_retransmit_delay_500us)
+    device->auto_retransmit_delay = nrf24l01_auto_retransmit_delay_500us;
+
+  for (uint8_t i = 0; i < 6; i++){
+    nrf24l01_data_pipe * pipe = &device->data_pipe[i];
+    // EN_AA left on a disabled pipe keeps the chip in Enhanced ShockBurst
+    if (!profile->auto_ack){
+      pipe->nrf24l01_data_pipe_auto_ack = 0;
+      pipe->nrf24l01_data_pipe_dyn_payload_length_enable = 0;
+    }
+    if (!pipe->nrf24l01_data_pipe_enable) continue;
+    pipe->nrf24l01_data_pipe_auto_ack = profile->auto_ack;
+    pipe->nrf24l01_data_pipe_dyn_payload_length_enable = profile->dynamic_payload;
+    if (!profile->dynamic_payload)
+      pipe->nrf24l01_data_pipe_payload_width = profile->static_payload_width;
+  }
+
+  return 0;
+}
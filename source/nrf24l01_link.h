@@ -0,0 +1,139 @@
+/**
+ * @file nrf24l01_link.h
+ * @brief Air-time minimizing link profile selection
+ *
+ * Picks the smallest per-packet overhead that still meets a reliability
+ * target: CRC length, address width, static or dynamic payload length and
+ * Enhanced ShockBurst (ACK) or plain ShockBurst (no ACK, no packet control
+ * field), and per-packet NOACK on an acknowledged link. The selected profile carries a model of the air time per packet
+ * and of the maximum packet rate, so configurations can be compared before
+ * they are flashed.
+ *
+ * Packet model (nRF24L01 datasheet, chapter 7):
+ * @code
+ * | preamble 1 | address 3-5 | PCF 9 bits (ESB only) | payload 0-32 | CRC 0-2 |
+ * @endcode
+ * One transaction is the TX settling time (130 µs) plus the packet on air
+ * and, with ACK, the RX turnaround (130 µs) plus the ACK packet on air.
+ *
+ * Plain ShockBurst needs EN_AA clear on every pipe: one pipe left with
+ * auto acknowledgment keeps the chip in Enhanced ShockBurst, with the PCF
+ * on air and the CRC forced on. A packet written with W_TX_PAYLOAD_NOACK
+ * (EN_DYN_ACK) on an acknowledged link skips the ACK but still carries
+ * the PCF and the CRC, so it is only chosen when the same link also sends
+ * packets that must be delivered.
+ *
+ * @par Example Usage:
+ * @code
+ * nrf24l01_link_requirements requirements = {
+ *     .min_payload = 3, .typical_payload = 6, .max_payload = 8,
+ *     .requires_delivery = 1, .ack_payload = 0,
+ *     .integrity = nrf24l01_integrity_basic,
+ *     .air_data_rate = nrf24l01_air_data_rate_2mbps,
+ * };
+ * nrf24l01_link_profile profile;
+ * nrf24l01_link_profile_select(&requirements, &profile);
+ * // profile.transaction_time, profile.max_packets_per_second
+ * nrf24l01_link_profile_apply(&nrf, &profile);
+ * nrf24l01_init(&nrf);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_LINK_H
+#define NRF24L01_DRIVER_NRF24L01_LINK_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_LINK Link Profile
+ * @brief Minimum-overhead packet format for a reliability target
+ * @{
+ */
+
+/** @brief Standby to TX/RX settling time in µs */
+#define NRF24L01_LINK_SETTLING_TIME   130
+
+/** @brief Bits of the ESB packet control field */
+#define NRF24L01_LINK_PCF_BITS        9
+
+/**
+ * @brief Reliability targets
+ */
+typedef enum {
+    nrf24l01_integrity_basic = 0,      /**< 1-byte CRC, 3-byte address */
+    nrf24l01_integrity_standard,       /**< 2-byte CRC, 4-byte address */
+    nrf24l01_integrity_strict,         /**< 2-byte CRC, 5-byte address */
+} nrf24l01_integrity;
+
+/**
+ * @brief What the application needs from the link
+ */
+typedef struct {
+    uint8_t min_payload;                   /**< Smallest payload sent (1-32) */
+    uint8_t typical_payload;               /**< Most frequent payload size (1-32) */
+    uint8_t max_payload;                   /**< Largest payload sent (1-32) */
+    uint8_t requires_delivery;             /**< Packets must be acknowledged and retransmitted */
+    uint8_t mixed_delivery;                /**< With requires_delivery, only some packets need it, the rest go out without ACK */
+    uint8_t ack_payload;                   /**< Bytes carried back in the ACK (0 for none) */
+    nrf24l01_integrity integrity;          /**< Reliability target */
+    nrf24l01_air_data_rate air_data_rate;  /**< Air data rate */
+} nrf24l01_link_requirements;
+
+/**
+ * @brief Selected packet format and its modeled cost
+ */
+typedef struct {
+    nrf24l01_crc_length crc_length;        /**< CRC length */
+    nrf24l01_address_width address_width;  /**< Address width */
+    nrf24l01_air_data_rate air_data_rate;  /**< Air data rate */
+    uint8_t dynamic_payload;               /**< Dynamic payload length (DPL) used */
+    uint8_t auto_ack;                      /**< Enhanced ShockBurst with ACK */
+    uint8_t dynamic_ack;                   /**< EN_DYN_ACK, packets without ACK written with W_TX_PAYLOAD_NOACK */
+    uint8_t ack_payload;                   /**< Bytes carried back in the ACK (0 for none) */
+    uint8_t payload_length;                /**< Payload bytes on air for the typical packet */
+    uint8_t static_payload_width;          /**< RX_PW_Px value when DPL is not used */
+    uint16_t packet_bits;                  /**< Bits on air for the typical packet */
+    uint16_t air_time;                     /**< Typical packet on air, µs */
+    uint16_t transaction_time;             /**< Settling, packet and ACK, µs */
+    uint16_t no_ack_transaction_time;      /**< Settling and packet sent with W_TX_PAYLOAD_NOACK, µs (0 without dynamic_ack) */
+    uint32_t max_packets_per_second;       /**< Theoretical packet rate with this profile */
+} nrf24l01_link_profile;
+
+/**
+ * @brief Air time of one packet
+ * @param air_data_rate Air data rate
+ * @param address_width Address width
+ * @param packet_control_field 1 if the 9-bit PCF is sent (Enhanced ShockBurst)
+ * @param payload_length Payload bytes (0-32)
+ * @param crc_length CRC length
+ * @return Time on air in µs, rounded up
+ */
+uint16_t nrf24l01_link_air_time(nrf24l01_air_data_rate air_data_rate, nrf24l01_address_width address_width,
+                                uint8_t packet_control_field, uint8_t payload_length, nrf24l01_crc_length crc_length);
+
+/**
+ * @brief Pick the cheapest profile meeting the requirements
+ * @param requirements Pointer to link requirements
+ * @param profile Pointer to profile to fill
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_link_profile_select(const nrf24l01_link_requirements * requirements, nrf24l01_link_profile * profile);
+
+/**
+ * @brief Copy a profile into the device configuration
+ * @param device Pointer to device configuration structure
+ * @param profile Pointer to selected profile
+ * @return 0 on success, non-zero on error
+ *
+ * Updates the device structure and every enabled pipe. Without auto
+ * acknowledgment it is cleared on all six pipes, DPL with it, so the chip
+ * runs plain ShockBurst. With auto acknowledgment a disabled retransmit
+ * count is set back to 3, with ACK payloads EN_ACK_PAY is set and ARD
+ * raised to 500 µs where the datasheet requires it, and dynamic_ack sets
+ * EN_DYN_ACK. The chip is written by the next nrf24l01_init().
+ */
+uint8_t nrf24l01_link_profile_apply(nrf24l01_device * device, const nrf24l01_link_profile * profile);
+
+/** @} */ // End of NRF24L01_LINK group
+
+#endif //NRF24L01_DRIVER_NRF24L01_LINK_H
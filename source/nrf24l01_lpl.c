@@ -0,0 +1,138 @@
+#include "nrf24l01_lpl.h"
+
+uint8_t nrf24l01_lpl_rx_init(nrf24l01_lpl_rx * rx, nrf24l01_device * device, uint32_t period, uint32_t window){
+  if (rx == NULL || device == NULL) return -1;
+  if (window == 0 || window >= period) return -1; // invalid schedule
+  memset(rx, 0, sizeof(nrf24l01_lpl_rx));
+  rx->period = period;
+  rx->window = window;
+
+  // the schedule decides when to power down, not an idle time
+  if (nrf24l01_power_init(&rx->power, device, 0)) return -1;
+  nrf24l01_power_sleep(&rx->power);
+  rx->started = nrf24l01_port_millis(device);
+  rx->cycle_started = rx->started;
+  rx->phase = nrf24l01_lpl_rx_sleeping;
+  return 0;
+}
+
+nrf24l01_lpl_rx_phase nrf24l01_lpl_rx_service(nrf24l01_lpl_rx * rx){
+  if (rx == NULL) return nrf24l01_lpl_rx_sleeping;
+  nrf24l01_device * device = rx->power.device;
+  uint32_t now = nrf24l01_port_millis(device);
+
+  switch (rx->phase) {
+    case nrf24l01_lpl_rx_sleeping:
+      if (now - rx->cycle_started < rx->period) break;
+      rx->cycle_started = now;
+      rx->wake_started = nrf24l01_port_micros(device);
+      nrf24l01_power_listen(&rx->power);
+      rx->phase = nrf24l01_lpl_rx_waking;
+      rx->stats.wakeups++;
+      // fall through
+    case nrf24l01_lpl_rx_waking:
+      if (nrf24l01_power_service(&rx->power) == nrf24l01_power_state_rx){
+        uint16_t latency = nrf24l01_port_micros(device) - rx->wake_started;
+        rx->stats.wake_latency_sum += latency;
+        if (latency > rx->stats.wake_latency_max) rx->stats.wake_latency_max = latency;
+        rx->window_started = now;
+        rx->phase = nrf24l01_lpl_rx_listening;
+      }
+      break;
+
+    case nrf24l01_lpl_rx_listening:
+      if (NRF24L01_FIELD_GET(RX_P_NO, nrf24l01_nop(device)) <= 5){
+        // traffic: stay for another window, the sender may have more
+        if (rx->window_started != now) rx->stats.extended++;
+        rx->window_started = now;
+      }
+      else if (now - rx->window_started >= rx->window){
+        nrf24l01_power_sleep(&rx->power);
+        rx->stats.awake_time += now - rx->cycle_started;
+        rx->phase = nrf24l01_lpl_rx_sleeping;
+      }
+      break;
+  }
+  return rx->phase;
+}
+
+uint16_t nrf24l01_lpl_duty_cycle(nrf24l01_lpl_rx * rx){
+  if (rx == NULL) return 0;
+  uint32_t now = nrf24l01_port_millis(rx->power.device);
+  uint32_t total = now - rx->started;
+  uint64_t awake = rx->stats.awake_time;
+  if (rx->phase != nrf24l01_lpl_rx_sleeping) awake += now - rx->cycle_started;
+  if (total == 0) return 0;
+  return (uint16_t)(awake * 1000 / total);
+}
+
+uint8_t nrf24l01_lpl_tx_init(nrf24l01_lpl_tx * tx, nrf24l01_device * device, uint32_t period, uint32_t window){
+  if (tx == NULL || device == NULL) return -1;
+  if (window == 0 || window >= period) return -1; // invalid schedule
+  memset(tx, 0, sizeof(nrf24l01_lpl_tx));
+  tx->device = device;
+  tx->period = period;
+  tx->window = window;
+  tx->state = nrf24l01_lpl_tx_idle;
+  return 0;
+}
+
+uint8_t nrf24l01_lpl_send(nrf24l01_lpl_tx * tx, uint8_t * data, uint8_t length){
+  if (tx == NULL || data == NULL) return -1;
+  if (length < 1 || length > 32) return -1; // invalid payload length
+  if (tx->state == nrf24l01_lpl_tx_sending) return -1; // busy
+  nrf24l01_device * device = tx->device;
+
+  nrf24l01_chip_disable(device);
+  nrf24l01_flush_tx(device);
+  nrf24l01_clear_interrupt_flags(device, TX_DS | MAX_RT);
+  nrf24l01_write_tx_payload(device, data, length);
+  // the payload stays in the FIFO across MAX_RT rounds; only with CE low
+  if (nrf24l01_reuse_tx_payload(device) == (uint8_t)-1) return -1; // not a PTX
+  nrf24l01_chip_enable(device);
+
+  tx->send_started = nrf24l01_port_millis(device);
+  tx->state = nrf24l01_lpl_tx_sending;
+  return 0;
+}
+
+// CE low, reuse ended, flags cleared
+static void nrf24l01_lpl_tx_stop(nrf24l01_lpl_tx * tx){
+  nrf24l01_chip_disable(tx->device);
+  nrf24l01_flush_tx(tx->device);
+  nrf24l01_clear_interrupt_flags(tx->device, TX_DS | MAX_RT);
+  tx->state = nrf24l01_lpl_tx_idle;
+}
+
+nrf24l01_lpl_tx_state nrf24l01_lpl_tx_service(nrf24l01_lpl_tx * tx){
+  if (tx == NULL) return nrf24l01_lpl_tx_idle;
+  if (tx->state != nrf24l01_lpl_tx_sending) return tx->state;
+  nrf24l01_device * device = tx->device;
+
+  uint8_t status_register = nrf24l01_nop(device);
+  uint32_t elapsed = nrf24l01_port_millis(device) - tx->send_started;
+
+  if (status_register & TX_DS){
+    nrf24l01_lpl_tx_stop(tx);
+    tx->stats.delivered++;
+    tx->stats.latency_sum += elapsed;
+    if (elapsed > tx->stats.latency_max) tx->stats.latency_max = elapsed;
+    return nrf24l01_lpl_tx_delivered;
+  }
+
+  if (elapsed >= tx->period + tx->window){
+    // a whole period went by, the receiver listened at least once
+    nrf24l01_lpl_tx_stop(tx);
+    tx->stats.failed++;
+    return nrf24l01_lpl_tx_failed;
+  }
+
+  if (status_register & MAX_RT){
+    // next round of retransmissions of the reused payload
+    nrf24l01_chip_disable(device);
+    nrf24l01_clear_interrupt_flags(device, MAX_RT);
+    nrf24l01_chip_enable(device);
+    tx->stats.rounds++;
+  }
+  return tx->state;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file nrf24l01_lpl.h
+ * @brief Duty-cycled low-power listening for battery PRX nodes, and its sender
+ *
+ * The receiver sleeps in Power Down and every period ms wakes up, listens
+ * for window ms and powers down again; the power manager does the wake up
+ * without blocking. A received payload keeps it listening for another
+ * window, so a burst is taken in one go. With a 100 ms period and a 3 ms
+ * window the receiver is on about 4.5% of the time instead of 100%.
+ *
+ * The sender cannot know when the receiver listens, so it repeats the
+ * packet for one whole period plus a window: the payload is marked with
+ * nrf24l01_reuse_tx_payload() and CE held high, and every MAX_RT is
+ * cleared to start the next round of retransmissions, until an ACK
+ * arrives or the time is up. Sender and receiver use the same period and
+ * window; the receiver needs auto acknowledgment.
+ *
+ * The receiver reports the duty cycle it achieved and how long its wake
+ * ups take, the sender the delivery latency, which is the wake up latency
+ * the application sees.
+ *
+ * @par Example Usage:
+ * @code
+ * // battery actuator, PRX
+ * static nrf24l01_lpl_rx rx;
+ * nrf24l01_lpl_rx_init(&rx, &nrf, 100, 3);
+ * for (;;){
+ *   nrf24l01_lpl_rx_service(&rx);
+ *   while (NRF24L01_FIELD_GET(RX_P_NO, nrf24l01_nop(&nrf)) <= 5) { ... read the payload ... }
+ * }
+ *
+ * // controller, PTX
+ * static nrf24l01_lpl_tx tx;
+ * nrf24l01_lpl_tx_init(&tx, &nrf, 100, 3);
+ * nrf24l01_lpl_send(&tx, command, sizeof(command));
+ * while (nrf24l01_lpl_tx_service(&tx) == nrf24l01_lpl_tx_sending);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_LPL_H
+#define NRF24L01_DRIVER_NRF24L01_LPL_H
+
+#include "nrf24l01_power.h"
+
+/**
+ * @defgroup NRF24L01_LPL Low-Power Listening
+ * @brief Periodic listen windows on the receiver, repeated sends on the sender
+ * @{
+ */
+
+/**
+ * @brief Receiver phases
+ */
+typedef enum {
+    nrf24l01_lpl_rx_sleeping = 0,          /**< Powered down until the next period */
+    nrf24l01_lpl_rx_waking,                /**< Waiting for the radio to come up */
+    nrf24l01_lpl_rx_listening,             /**< Listen window open */
+} nrf24l01_lpl_rx_phase;
+
+/**
+ * @brief Receiver counters
+ */
+typedef struct {
+    uint32_t wakeups;                      /**< Listen windows opened */
+    uint32_t extended;                     /**< Windows kept open by received payloads */
+    uint32_t awake_time;                   /**< Time out of Power Down, ms */
+    uint32_t wake_latency_sum;             /**< Sum of wake up to RX times, µs */
+    uint32_t wake_latency_max;             /**< Longest wake up to RX time, µs */
+} nrf24l01_lpl_rx_stats;
+
+/**
+ * @brief Low-power listening receiver
+ */
+typedef struct {
+    nrf24l01_power power;                  /**< Power manager of the radio */
+    nrf24l01_lpl_rx_phase phase;           /**< Current phase */
+    uint32_t period;                       /**< Time between wake ups, ms */
+    uint32_t window;                       /**< Listen time, ms */
+    uint32_t started;                      /**< Time the schedule started, ms */
+    uint32_t cycle_started;                /**< Time of the last wake up, ms */
+    uint32_t window_started;               /**< Time the window opened or was last extended, ms */
+    uint16_t wake_started;                 /**< Time of the last wake up, µs */
+    nrf24l01_lpl_rx_stats stats;           /**< Counters */
+} nrf24l01_lpl_rx;
+
+/**
+ * @brief Sender results
+ */
+typedef enum {
+    nrf24l01_lpl_tx_idle = 0,              /**< Nothing being sent */
+    nrf24l01_lpl_tx_sending,               /**< Repeating the packet */
+    nrf24l01_lpl_tx_delivered,             /**< Acknowledged, reported once */
+    nrf24l01_lpl_tx_failed,                /**< No ACK within period + window, reported once */
+} nrf24l01_lpl_tx_state;
+
+/**
+ * @brief Sender counters
+ */
+typedef struct {
+    uint32_t delivered;                    /**< Packets acknowledged */
+    uint32_t failed;                       /**< Packets given up */
+    uint32_t rounds;                       /**< MAX_RT rounds restarted */
+    uint32_t latency_sum;                  /**< Sum of send to ACK times, ms */
+    uint32_t latency_max;                  /**< Longest send to ACK time, ms */
+} nrf24l01_lpl_tx_stats;
+
+/**
+ * @brief Low-power listening sender
+ */
+typedef struct {
+    nrf24l01_device * device;              /**< PTX radio, powered up */
+    nrf24l01_lpl_tx_state state;           /**< Current state */
+    uint32_t period;                       /**< Receiver period, ms */
+    uint32_t window;                       /**< Receiver listen time, ms */
+    uint32_t send_started;                 /**< Time the packet was first sent, ms */
+    nrf24l01_lpl_tx_stats stats;           /**< Counters */
+} nrf24l01_lpl_tx;
+
+/**
+ * @brief Start the listen schedule of a receiver
+ * @param rx Pointer to receiver
+ * @param device Pointer to an initialized PRX device
+ * @param period Time between wake ups in ms
+ * @param window Listen time in ms, shorter than the period
+ * @return 0 on success, non-zero on error
+ *
+ * The radio is powered down until the first period ends.
+ */
+uint8_t nrf24l01_lpl_rx_init(nrf24l01_lpl_rx * rx, nrf24l01_device * device, uint32_t period, uint32_t window);
+
+/**
+ * @brief Advance the listen schedule
+ * @param rx Pointer to receiver
+ * @return Current phase
+ *
+ * Call from the main loop; never waits. Reading the payloads stays with
+ * the application; a payload in the RX FIFO extends the window.
+ */
+nrf24l01_lpl_rx_phase nrf24l01_lpl_rx_service(nrf24l01_lpl_rx * rx);
+
+/**
+ * @brief Share of the time the receiver was out of Power Down
+ * @param rx Pointer to receiver
+ * @return Duty cycle in per mille since nrf24l01_lpl_rx_init()
+ */
+uint16_t nrf24l01_lpl_duty_cycle(nrf24l01_lpl_rx * rx);
+
+/**
+ * @brief Set up a sender for receivers on the given schedule
+ * @param tx Pointer to sender
+ * @param device Pointer to an initialized, powered up PTX device
+ * @param period Receiver time between wake ups in ms
+ * @param window Receiver listen time in ms
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_lpl_tx_init(nrf24l01_lpl_tx * tx, nrf24l01_device * device, uint32_t period, uint32_t window);
+
+/**
+ * @brief Start repeating a packet
+ * @param tx Pointer to sender
+ * @param data Pointer to payload data
+ * @param length Payload length (1-32)
+ * @return 0 on success, non-zero while another packet is being sent or on error
+ */
+uint8_t nrf24l01_lpl_send(nrf24l01_lpl_tx * tx, uint8_t * data, uint8_t length);
+
+/**
+ * @brief Restart the retransmissions after MAX_RT and check for the ACK
+ * @param tx Pointer to sender
+ * @return nrf24l01_lpl_tx_sending while busy, then delivered or failed once, then idle
+ */
+nrf24l01_lpl_tx_state nrf24l01_lpl_tx_service(nrf24l01_lpl_tx * tx);
+
+/** @} */ // End of NRF24L01_LPL group
+
+#endif //NRF24L01_DRIVER_NRF24L01_LPL_H
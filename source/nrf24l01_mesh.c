@@ -0,0 +1,306 @@
+#include "nrf24l01_mesh.h"
+
+static uint8_t nrf24l01_mesh_expired(nrf24l01_mesh_route * route, uint32_t now){
+  return !route->fixed && now - route->updated > NRF24L01_MESH_ROUTE_TIMEOUT;
+}
+
+static nrf24l01_mesh_route * nrf24l01_mesh_find(nrf24l01_mesh * mesh, uint8_t node){
+  for (uint8_t i = 0; i < NRF24L01_MESH_ROUTES; i++)
+    if (mesh->route[i].valid && mesh->route[i].node == node) return &mesh->route[i];
+  return NULL;
+}
+
+// free entry, else the expired or least recently refreshed learned one; NULL when all are static
+static nrf24l01_mesh_route * nrf24l01_mesh_victim(nrf24l01_mesh * mesh, uint32_t now){
+  nrf24l01_mesh_route * victim = NULL;
+  for (uint8_t i = 0; i < NRF24L01_MESH_ROUTES; i++){
+    nrf24l01_mesh_route * route = &mesh->route[i];
+    if (!route->valid || nrf24l01_mesh_expired(route, now)) return route;
+    if (route->fixed) continue;
+    if (victim == NULL || now - route->updated > now - victim->updated) victim = route;
+  }
+  return victim;
+}
+
+static void nrf24l01_mesh_learn(nrf24l01_mesh * mesh, uint8_t node, uint8_t via, uint8_t hops){
+  if (node == NRF24L01_MESH_ANY || node == mesh->node) return;
+  uint32_t now = nrf24l01_port_millis(mesh->rx_device);
+
+  nrf24l01_mesh_route * route = nrf24l01_mesh_find(mesh, node);
+  if (route != NULL){
+    if (route->fixed) return;
+    // same way refreshes, a shorter or equal way wins, a dead one is replaced
+    if (route->next_hop != via && hops > route->hops && !nrf24l01_mesh_expired(route, now)) return;
+  }
+  else if ((route = nrf24l01_mesh_victim(mesh, now)) == NULL)
+    return;
+
+  route->node = node;
+  route->next_hop = via;
+  route->hops = hops;
+  route->valid = 1;
+  route->fixed = 0;
+  route->updated = now;
+}
+
+// 1 the first time a (source, sequence number) pair comes by
+static uint8_t nrf24l01_mesh_first_seen(nrf24l01_mesh * mesh, uint8_t source, uint8_t sequence){
+  uint16_t key = (uint16_t)source << 8 | sequence;
+  for (uint8_t i = 0; i < mesh->seen_count; i++)
+    if (mesh->seen[i] == key) return 0;
+
+  mesh->seen[mesh->seen_next] = key;
+  mesh->seen_next = (mesh->seen_next + 1) % NRF24L01_MESH_SEEN;
+  if (mesh->seen_count < NRF24L01_MESH_SEEN) mesh->seen_count++;
+  return 1;
+}
+
+// takes over the reference of the caller, the queue has room
+static void nrf24l01_mesh_enqueue(nrf24l01_mesh * mesh, nrf24l01_packet * packet, uint8_t next_hop, uint16_t received){
+  nrf24l01_mesh_entry * entry = &mesh->queue[(mesh->queue_head + mesh->queue_count) % NRF24L01_MESH_QUEUE_DEPTH];
+  entry->packet = packet;
+  entry->next_hop = next_hop;
+  entry->received = received;
+  mesh->queue_count++;
+}
+
+static void nrf24l01_mesh_handle(nrf24l01_mesh * mesh, nrf24l01_packet * packet, uint16_t received){
+  uint8_t * header = nrf24l01_packet_payload(packet);
+  mesh->stats.received++;
+
+  if (packet->length < NRF24L01_MESH_HEADER_SIZE){
+    mesh->stats.dropped_malformed++;
+    nrf24l01_packet_unref(mesh->pool, packet);
+    return;
+  }
+
+  uint8_t destination = header[0], source = header[1], last_hop = header[2], hops = header[3] + 1;
+  if (source == mesh->node || !nrf24l01_mesh_first_seen(mesh, source, header[4])){
+    mesh->stats.dropped_loop++;
+    nrf24l01_packet_unref(mesh->pool, packet);
+    return;
+  }
+  if (mesh->learn) nrf24l01_mesh_learn(mesh, source, last_hop, hops);
+
+  if (destination == mesh->node){
+    mesh->stats.delivered++;
+    if (mesh->on_deliver != NULL) mesh->on_deliver(source, packet, mesh->context);
+    nrf24l01_packet_unref(mesh->pool, packet);
+    return;
+  }
+
+  if (hops >= NRF24L01_MESH_MAX_HOPS){
+    mesh->stats.dropped_hops++;
+    nrf24l01_packet_unref(mesh->pool, packet);
+    return;
+  }
+
+  uint8_t next_hop = nrf24l01_mesh_next_hop(mesh, destination);
+  if (next_hop == last_hop){
+    // would bounce straight back: the neighbours disagree on the way
+    mesh->stats.dropped_loop++;
+    nrf24l01_packet_unref(mesh->pool, packet);
+    return;
+  }
+
+  // rewritten in place, the packet goes out as it is
+  header[2] = mesh->node;
+  header[3] = hops;
+  nrf24l01_mesh_enqueue(mesh, packet, next_hop, received);
+}
+
+// CE of the TX radio is low
+static void nrf24l01_mesh_point(nrf24l01_mesh * mesh, uint8_t next_hop){
+  nrf24l01_device * device = mesh->tx_device;
+  if (mesh->tx_hop == next_hop) return;
+
+  uint8_t address[5];
+  memcpy(address, mesh->address, 5);
+  address[0] = next_hop;
+  nrf24l01_write_register(device, TX_ADDR, address, device->address_width);
+  // pipe 0 takes the acknowledgment of the next hop
+  nrf24l01_write_register(device, RX_ADDR_P0, address, device->address_width);
+  mesh->tx_hop = next_hop;
+}
+
+static void nrf24l01_mesh_start(nrf24l01_mesh * mesh){
+  nrf24l01_device * device = mesh->tx_device;
+  nrf24l01_mesh_entry * entry = &mesh->queue[mesh->queue_head];
+
+  nrf24l01_chip_disable(device);
+  if (device->primary_rx){
+    // pipe 0 is off while listening, the acknowledgment comes in on it
+    uint8_t en_rxaddr = mesh->en_rxaddr | ERX_P0;
+    nrf24l01_write_register(device, EN_RXADDR, &en_rxaddr, 1);
+    device->data_pipe[0].nrf24l01_data_pipe_enable = 1;
+    nrf24l01_write_register(device, CONFIG, &mesh->config, 1);
+    device->primary_rx = 0;
+  }
+  nrf24l01_mesh_point(mesh, entry->next_hop);
+  nrf24l01_packet_send(device, entry->packet, mesh->no_ack ? W_TX_PAYLOAD_NOACK : W_TX_PAYLOAD);
+  // CE stays high until TX_DS or MAX_RT, no 130 µs busy pulse
+  nrf24l01_chip_enable(device);
+  mesh->sending = 1;
+}
+
+static void nrf24l01_mesh_check_tx(nrf24l01_mesh * mesh){
+  nrf24l01_device * device = mesh->tx_device;
+  uint8_t status_register = nrf24l01_nop(device);
+  if (!(status_register & (TX_DS | MAX_RT))) return; // still on the air
+
+  nrf24l01_chip_disable(device);
+  nrf24l01_mesh_entry * entry = &mesh->queue[mesh->queue_head];
+  if (status_register & TX_DS){
+    uint16_t latency = nrf24l01_port_micros(device) - entry->received;
+    mesh->stats.forwarded++;
+    mesh->stats.latency_sum += latency;
+    if (latency > mesh->stats.latency_max) mesh->stats.latency_max = latency;
+  }
+  else {
+    // drop the frame so the radio does not resend it when MAX_RT is cleared
+    nrf24l01_flush_tx(device);
+    mesh->stats.tx_failed++;
+  }
+  nrf24l01_clear_interrupt_flags(device, status_register & (TX_DS | MAX_RT));
+
+  nrf24l01_packet_unref(mesh->pool, entry->packet);
+  mesh->queue_head = (mesh->queue_head + 1) % NRF24L01_MESH_QUEUE_DEPTH;
+  mesh->queue_count--;
+  mesh->sending = 0;
+}
+
+uint8_t nrf24l01_mesh_init(nrf24l01_mesh * mesh, nrf24l01_device * rx_device, nrf24l01_device * tx_device,
+                           nrf24l01_pool * pool, uint8_t node){
+  if (mesh == NULL || rx_device == NULL || tx_device == NULL || pool == NULL) return -1;
+  if (node == NRF24L01_MESH_ANY) return -1; // reserved ID
+  memset(mesh, 0, sizeof(nrf24l01_mesh));
+  mesh->rx_device = rx_device;
+  mesh->tx_device = tx_device;
+  mesh->pool = pool;
+  mesh->node = node;
+  mesh->learn = 1;
+  mesh->tx_hop = NRF24L01_MESH_ANY;
+  memcpy(mesh->address, rx_device->transmit_address, 5);
+
+  nrf24l01_chip_disable(tx_device);
+  nrf24l01_read_register(tx_device, CONFIG, &mesh->config, 1);
+  mesh->config &= ~PRIM_RX;
+
+  uint8_t address[5];
+  memcpy(address, mesh->address, 5);
+  address[0] = node;
+  nrf24l01_chip_disable(rx_device);
+  nrf24l01_write_register(rx_device, RX_ADDR_P1, address, rx_device->address_width);
+  // pipe 0 only while sending, see nrf24l01_mesh_start()
+  nrf24l01_read_register(rx_device, EN_RXADDR, &mesh->en_rxaddr, 1);
+  mesh->en_rxaddr = (mesh->en_rxaddr & ~ERX_P0) | ERX_P1;
+  nrf24l01_write_register(rx_device, EN_RXADDR, &mesh->en_rxaddr, 1);
+  rx_device->data_pipe[0].nrf24l01_data_pipe_enable = 0;
+  rx_device->data_pipe[1].nrf24l01_data_pipe_enable = 1;
+  if (tx_device != rx_device){
+    uint8_t en_rxaddr = 0;
+    nrf24l01_read_register(tx_device, EN_RXADDR, &en_rxaddr, 1);
+    en_rxaddr |= ERX_P0;
+    nrf24l01_write_register(tx_device, EN_RXADDR, &en_rxaddr, 1);
+    tx_device->data_pipe[0].nrf24l01_data_pipe_enable = 1;
+  }
+  nrf24l01_chip_enable(rx_device);
+  return 0;
+}
+
+uint8_t nrf24l01_mesh_route_add(nrf24l01_mesh * mesh, uint8_t node, uint8_t next_hop){
+  if (mesh == NULL || next_hop == NRF24L01_MESH_ANY) return -1;
+  nrf24l01_mesh_route * route = nrf24l01_mesh_find(mesh, node);
+  if (route == NULL) route = nrf24l01_mesh_victim(mesh, nrf24l01_port_millis(mesh->rx_device));
+  if (route == NULL) return -1; // table full of static routes
+
+  route->node = node;
+  route->next_hop = next_hop;
+  route->hops = 0;
+  route->valid = 1;
+  route->fixed = 1;
+  return 0;
+}
+
+uint8_t nrf24l01_mesh_route_remove(nrf24l01_mesh * mesh, uint8_t node){
+  if (mesh == NULL) return -1;
+  nrf24l01_mesh_route * route = nrf24l01_mesh_find(mesh, node);
+  if (route == NULL) return -1;
+  route->valid = 0;
+  return 0;
+}
+
+uint8_t nrf24l01_mesh_next_hop(nrf24l01_mesh * mesh, uint8_t node){
+  if (mesh == NULL) return node;
+  uint32_t now = nrf24l01_port_millis(mesh->rx_device);
+
+  nrf24l01_mesh_route * route = nrf24l01_mesh_find(mesh, node);
+  if (route != NULL && !nrf24l01_mesh_expired(route, now)) return route->next_hop;
+  route = nrf24l01_mesh_find(mesh, NRF24L01_MESH_ANY);
+  if (route != NULL) return route->next_hop;
+  return node; // assume a neighbour
+}
+
+uint8_t nrf24l01_mesh_send(nrf24l01_mesh * mesh, uint8_t destination, const uint8_t * data, uint8_t length){
+  if (mesh == NULL || data == NULL) return -1;
+  if (length < 1 || length > NRF24L01_MESH_PAYLOAD_SIZE) return -1; // invalid length
+  if (destination == mesh->node || destination == NRF24L01_MESH_ANY) return -1; // invalid destination
+  if (mesh->queue_count == NRF24L01_MESH_QUEUE_DEPTH) return -1; // queue full
+
+  nrf24l01_packet * packet = nrf24l01_pool_alloc(mesh->pool);
+  if (packet == NULL) return -1;
+
+  uint8_t * header = nrf24l01_packet_payload(packet);
+  header[0] = destination;
+  header[1] = mesh->node;
+  header[2] = mesh->node;
+  header[3] = 0;
+  header[4] = mesh->sequence++;
+  memcpy(header + NRF24L01_MESH_HEADER_SIZE, data, length);
+  packet->length = NRF24L01_MESH_HEADER_SIZE + length;
+
+  nrf24l01_mesh_enqueue(mesh, packet, nrf24l01_mesh_next_hop(mesh, destination),
+                        nrf24l01_port_micros(mesh->tx_device));
+  mesh->stats.originated++;
+  return 0;
+}
+
+uint8_t nrf24l01_mesh_service(nrf24l01_mesh * mesh){
+  uint8_t count = 0;
+  if (mesh == NULL) return 0;
+  nrf24l01_device * device = mesh->rx_device;
+
+  uint8_t status_register = nrf24l01_nop(device);
+  // a full queue leaves frames in the RX FIFO, their senders retry
+  while (NRF24L01_FIELD_GET(RX_P_NO, status_register) <= 5 && mesh->queue_count < NRF24L01_MESH_QUEUE_DEPTH){
+    nrf24l01_packet * packet = nrf24l01_pool_receive(mesh->pool, device, status_register);
+    if (packet == NULL) break;
+    nrf24l01_mesh_handle(mesh, packet, nrf24l01_port_micros(device));
+    count++;
+    // the forward goes out while the next frame is read
+    if (!mesh->sending && mesh->queue_count > 0) nrf24l01_mesh_start(mesh);
+    status_register = nrf24l01_nop(device);
+  }
+  if (status_register & RX_DR && NRF24L01_FIELD_GET(RX_P_NO, status_register) > 5){
+    uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+    nrf24l01_clear_interrupt_flags(device, RX_DR);
+    if (chip_enabled) nrf24l01_chip_enable(device);
+  }
+
+  if (mesh->sending) nrf24l01_mesh_check_tx(mesh);
+  if (!mesh->sending){
+    if (mesh->queue_count > 0)
+      nrf24l01_mesh_start(mesh);
+    else if (mesh->tx_device == device && !device->primary_rx){
+      // one radio and nothing to send: back to listening, pipe 0 still
+      // points at the last next hop and would take frames meant for it
+      nrf24l01_write_register(device, EN_RXADDR, &mesh->en_rxaddr, 1);
+      device->data_pipe[0].nrf24l01_data_pipe_enable = 0;
+      uint8_t config_register = mesh->config | PRIM_RX;
+      nrf24l01_write_register(device, CONFIG, &config_register, 1);
+      device->primary_rx = 1;
+      nrf24l01_chip_enable(device);
+    }
+  }
+  return count;
+}
@@ -0,0 +1,234 @@
+/**
+ * @file nrf24l01_mesh.h
+ * @brief Multi-hop relay: routing by node ID and zero-copy forwarding
+ *
+ * Every node has a one byte ID. Its radio listens on data pipe 1 at the
+ * mesh address, the transmit_address of the device with its first byte
+ * (LSB) replaced by the node ID; pipe 0 is taken for the acknowledgments
+ * of the hop being sent. Pipe 0 is off while a radio listens: left on the
+ * address of the last next hop, it would take frames meant for that
+ * neighbour. A frame carries a NRF24L01_MESH_HEADER_SIZE byte
+ * header (destination, source, last hop, hop count, sequence number)
+ * followed by up to NRF24L01_MESH_PAYLOAD_SIZE bytes of data.
+ *
+ * A relay reads a frame into a pool packet, rewrites the last hop and
+ * hop count in place and writes the same packet to the TX FIFO of the
+ * next hop with W_TX_PAYLOAD (W_TX_PAYLOAD_NOACK when no_ack is set):
+ * no copy between receiving and forwarding, and the forward starts in
+ * the same nrf24l01_mesh_service() call that read the frame.
+ *
+ * Routes are looked up in a table keyed by destination. Static routes are
+ * added with nrf24l01_mesh_route_add(); with learning on, every frame also
+ * teaches the route back to its source through its last hop, and learned
+ * routes expire after NRF24L01_MESH_ROUTE_TIMEOUT ms. A destination without
+ * a route is sent to the NRF24L01_MESH_ANY route when there is one, or
+ * straight to the destination as a neighbour.
+ *
+ * Loops are cut three ways: a frame is dropped when its hop count reaches
+ * NRF24L01_MESH_MAX_HOPS, when it comes back to its source or is seen a
+ * second time (source and sequence number), and when its next hop is the
+ * node it came from.
+ *
+ * With one radio the relay turns it around to PTX for each forward and
+ * back to PRX when the queue is empty; frames arriving meanwhile wait for
+ * the retransmissions of their sender. With a second radio as tx_device
+ * both directions run at once. The per-hop latency counted in the stats
+ * runs from reading the frame to the acknowledgment of the next hop.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_pool pool;
+ * static nrf24l01_mesh mesh;
+ * nrf24l01_pool_init(&pool);
+ * nrf24l01_mesh_init(&mesh, &nrf, &nrf, &pool, 12);      // one radio, node 12
+ * mesh.on_deliver = handle_frame;
+ * nrf24l01_mesh_route_add(&mesh, NRF24L01_MESH_ANY, 1);   // towards the gateway
+ *
+ * nrf24l01_mesh_send(&mesh, 1, reading, sizeof(reading));
+ * for (;;) nrf24l01_mesh_service(&mesh);                  // or on every IRQ
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_MESH_H
+#define NRF24L01_DRIVER_NRF24L01_MESH_H
+
+#include "nrf24l01_pool.h"
+
+/**
+ * @defgroup NRF24L01_MESH Multi-Hop Relay
+ * @brief Routing table, in-place forwarding, loop suppression and hop latency
+ * @{
+ */
+
+#ifndef NRF24L01_MESH_ROUTES
+/** @brief Entries in the routing table */
+#define NRF24L01_MESH_ROUTES          16
+#endif
+
+#ifndef NRF24L01_MESH_QUEUE_DEPTH
+/** @brief Frames waiting for the next hop */
+#define NRF24L01_MESH_QUEUE_DEPTH     8
+#endif
+
+#ifndef NRF24L01_MESH_MAX_HOPS
+/** @brief Hops after which a frame is dropped */
+#define NRF24L01_MESH_MAX_HOPS        8
+#endif
+
+#ifndef NRF24L01_MESH_SEEN
+/** @brief Recent (source, sequence number) pairs remembered for loop suppression */
+#define NRF24L01_MESH_SEEN            16
+#endif
+
+#ifndef NRF24L01_MESH_ROUTE_TIMEOUT
+/** @brief Time in ms a learned route stays valid without traffic */
+#define NRF24L01_MESH_ROUTE_TIMEOUT   60000
+#endif
+
+/** @brief Bytes of the frame header */
+#define NRF24L01_MESH_HEADER_SIZE     5
+
+/** @brief Largest data part of a frame */
+#define NRF24L01_MESH_PAYLOAD_SIZE    (32 - NRF24L01_MESH_HEADER_SIZE)
+
+/** @brief Destination of the default route; not a valid node ID */
+#define NRF24L01_MESH_ANY             0xFF
+
+/**
+ * @brief One routing table entry
+ */
+typedef struct {
+    uint8_t node;                          /**< Destination */
+    uint8_t next_hop;                      /**< Neighbour frames for node are sent to */
+    uint8_t hops;                          /**< Distance in hops, learned routes only */
+    uint8_t valid : 1;                     /**< Entry in use */
+    uint8_t fixed : 1;                     /**< Static route, never replaced or expired */
+    uint32_t updated;                      /**< Time of the last refresh, ms */
+} nrf24l01_mesh_route;
+
+/**
+ * @brief A frame waiting for its next hop
+ */
+typedef struct {
+    nrf24l01_packet * packet;              /**< Frame, one reference held by the queue */
+    uint8_t next_hop;                      /**< Neighbour it goes to */
+    uint16_t received;                     /**< Time it was read, µs; for the hop latency */
+} nrf24l01_mesh_entry;
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    uint32_t received;                     /**< Frames read */
+    uint32_t delivered;                    /**< Frames for this node */
+    uint32_t forwarded;                    /**< Frames acknowledged by the next hop */
+    uint32_t originated;                   /**< Frames queued by nrf24l01_mesh_send() */
+    uint32_t dropped_hops;                 /**< Frames at NRF24L01_MESH_MAX_HOPS */
+    uint32_t dropped_loop;                 /**< Frames seen before, back at their source or bouncing back */
+    uint32_t dropped_malformed;            /**< Frames shorter than the header */
+    uint32_t tx_failed;                    /**< Forwards ended by MAX_RT */
+    uint32_t latency_sum;                  /**< Sum of the hop latencies of forwarded frames, µs */
+    uint32_t latency_max;                  /**< Longest hop latency, µs */
+} nrf24l01_mesh_stats;
+
+/**
+ * @brief Handler for a frame addressed to this node
+ * @param source Node the frame came from
+ * @param packet Frame; its data starts NRF24L01_MESH_HEADER_SIZE bytes into the payload.
+ *               Take a reference with nrf24l01_packet_ref() to keep it past the call
+ * @param context User context
+ */
+typedef void (*nrf24l01_mesh_handler)(uint8_t source, nrf24l01_packet * packet, void * context);
+
+/**
+ * @brief Relay instance, one per node
+ */
+typedef struct {
+    nrf24l01_device * rx_device;                         /**< PRX radio */
+    nrf24l01_device * tx_device;                         /**< PTX radio, or rx_device for one radio */
+    nrf24l01_pool * pool;                                /**< Packet buffers */
+    nrf24l01_mesh_handler on_deliver;                    /**< Frames for this node, may be NULL */
+    void * context;                                      /**< Passed to on_deliver */
+    uint8_t node;                                        /**< ID of this node */
+    uint8_t learn : 1;                                   /**< Learn routes from received frames, on by default */
+    uint8_t no_ack : 1;                                  /**< Forward with W_TX_PAYLOAD_NOACK, needs dynamic ACK */
+    uint8_t sending : 1;                                 /**< Queue head is in the TX FIFO */
+    uint8_t config;                                      /**< CONFIG without PRIM_RX, for turning one radio around */
+    uint8_t en_rxaddr;                                   /**< EN_RXADDR of rx_device for listening, pipe 0 off */
+    uint8_t address[5];                                  /**< Mesh address, first byte replaced by the node ID */
+    uint8_t tx_hop;                                      /**< Neighbour TX_ADDR currently points to */
+    uint8_t sequence;                                    /**< Sequence number of the next own frame */
+    nrf24l01_mesh_route route[NRF24L01_MESH_ROUTES];     /**< Routing table */
+    uint16_t seen[NRF24L01_MESH_SEEN];                   /**< Recent source << 8 | sequence number */
+    uint8_t seen_count;                                  /**< Valid entries in seen */
+    uint8_t seen_next;                                   /**< Entry replaced next */
+    nrf24l01_mesh_entry queue[NRF24L01_MESH_QUEUE_DEPTH]; /**< Frames for the next hops, ring */
+    uint8_t queue_head;                                  /**< Oldest frame */
+    uint8_t queue_count;                                 /**< Frames in the ring */
+    nrf24l01_mesh_stats stats;                           /**< Counters */
+} nrf24l01_mesh;
+
+/**
+ * @brief Set up a node and start listening
+ * @param mesh Pointer to relay instance
+ * @param rx_device Initialized PRX device, dynamic payload length on pipes 0 and 1
+ * @param tx_device Initialized PTX device, or rx_device to share one radio
+ * @param pool Pool the frames are read into
+ * @param node ID of this node (0-254)
+ * @return 0 on success, non-zero on error
+ *
+ * Points pipe 1 of rx_device at the mesh address of the node, turns its
+ * pipe 0 off and raises CE. A separate tx_device gets pipe 0 on, for the
+ * acknowledgments.
+ */
+uint8_t nrf24l01_mesh_init(nrf24l01_mesh * mesh, nrf24l01_device * rx_device, nrf24l01_device * tx_device,
+                           nrf24l01_pool * pool, uint8_t node);
+
+/**
+ * @brief Add or replace a static route
+ * @param mesh Pointer to relay instance
+ * @param node Destination, or NRF24L01_MESH_ANY for the default route
+ * @param next_hop Neighbour to send its frames to
+ * @return 0 on success, non-zero when the table is full of static routes
+ */
+uint8_t nrf24l01_mesh_route_add(nrf24l01_mesh * mesh, uint8_t node, uint8_t next_hop);
+
+/**
+ * @brief Remove the route of a destination
+ * @param mesh Pointer to relay instance
+ * @param node Destination
+ * @return 0 on success, non-zero when there was no route
+ */
+uint8_t nrf24l01_mesh_route_remove(nrf24l01_mesh * mesh, uint8_t node);
+
+/**
+ * @brief Next hop towards a destination
+ * @param mesh Pointer to relay instance
+ * @param node Destination
+ * @return Neighbour the frame goes to
+ */
+uint8_t nrf24l01_mesh_next_hop(nrf24l01_mesh * mesh, uint8_t node);
+
+/**
+ * @brief Queue a frame from this node
+ * @param mesh Pointer to relay instance
+ * @param destination Node ID
+ * @param data Pointer to data
+ * @param length Data length (1-NRF24L01_MESH_PAYLOAD_SIZE)
+ * @return 0 on success, non-zero when the queue or pool is full or on error
+ */
+uint8_t nrf24l01_mesh_send(nrf24l01_mesh * mesh, uint8_t destination, const uint8_t * data, uint8_t length);
+
+/**
+ * @brief Read, deliver and forward received frames and move the TX queue on
+ * @param mesh Pointer to relay instance
+ * @return Number of frames read
+ *
+ * Call from the main loop or after every IRQ of either radio. Never waits:
+ * a forward in progress is checked again on the next call.
+ */
+uint8_t nrf24l01_mesh_service(nrf24l01_mesh * mesh);
+
+/** @} */ // End of NRF24L01_MESH group
+
+#endif //NRF24L01_DRIVER_NRF24L01_MESH_H
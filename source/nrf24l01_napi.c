@@ -0,0 +1,114 @@
+#include "nrf24l01_napi.h"
+
+// CONFIG and STATUS are written with CE low, the radio goes back to RX afterwards
+static void nrf24l01_napi_rx_interrupt(nrf24l01_device * device, uint8_t enable){
+  uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+  nrf24l01_chip_disable(device);
+  if (enable) nrf24l01_clear_interrupt_flags(device, RX_DR);
+  nrf24l01_interrupt(device, nrf24l01_irq_rx_data_ready, enable);
+  if (chip_enabled) nrf24l01_chip_enable(device);
+}
+
+// reads at most limit payloads, status_register tracks the RX FIFO head
+static uint8_t nrf24l01_napi_drain(nrf24l01_napi * napi, uint8_t * status_register, uint8_t limit){
+  nrf24l01_device * device = napi->device;
+  uint8_t data[32], count = 0;
+  uint8_t pipe = NRF24L01_FIELD_GET(RX_P_NO, *status_register);
+
+  while (pipe <= 5 && count < limit){
+    uint8_t length = device->data_pipe[pipe].nrf24l01_data_pipe_payload_width;
+    if (device->dynamic_payload_length_enable && device->data_pipe[pipe].nrf24l01_data_pipe_dyn_payload_length_enable){
+      nrf24l01_read_rx_payload_width(device, &length);
+      if (length < 1 || length > 32){
+        // corrupted length, the datasheet asks for a flush
+        *status_register = nrf24l01_flush_rx(device);
+        break;
+      }
+    }
+    if (length < 1 || length > 32) length = 32;
+
+    nrf24l01_read_rx_payload(device, data, length);
+    if (napi->on_rx != NULL) napi->on_rx(pipe, data, length, napi->context);
+    count++;
+
+    *status_register = nrf24l01_nop(device);
+    pipe = NRF24L01_FIELD_GET(RX_P_NO, *status_register);
+  }
+  return count;
+}
+
+uint8_t nrf24l01_napi_init(nrf24l01_napi * napi, nrf24l01_device * device, nrf24l01_napi_handler on_rx,
+                           void * context, uint8_t budget){
+  if (napi == NULL || device == NULL) return -1;
+  if (budget == 0) return -1; // invalid budget
+
+  memset(napi, 0, sizeof(nrf24l01_napi));
+  napi->device = device;
+  napi->on_rx = on_rx;
+  napi->context = context;
+  napi->budget = budget;
+  napi->mode = nrf24l01_napi_mode_irq;
+  nrf24l01_napi_rx_interrupt(device, 1);
+  return 0;
+}
+
+uint8_t nrf24l01_napi_irq(nrf24l01_napi * napi){
+  if (napi == NULL) return 0;
+  if (napi->mode != nrf24l01_napi_mode_irq) return 0; // edge from before the mask took effect
+  napi->stats.interrupts++;
+
+  // a payload still waiting after these means packets come faster than IRQs
+  uint8_t limit = NRF24L01_NAPI_POLL_THRESHOLD - 1 < napi->budget ? NRF24L01_NAPI_POLL_THRESHOLD - 1 : napi->budget;
+  uint8_t status_register = nrf24l01_nop(napi->device);
+  uint8_t count = nrf24l01_napi_drain(napi, &status_register, limit);
+  napi->stats.irq_packets += count;
+
+  if (NRF24L01_FIELD_GET(RX_P_NO, status_register) > 5){
+    // light traffic: stay on interrupts. The write shifts out STATUS from
+    // before the clear, a payload that slipped in shows up there
+    uint8_t chip_enabled = nrf24l01_port_ce_read(napi->device);
+    status_register = nrf24l01_clear_interrupt_flags(napi->device, RX_DR);
+    if (chip_enabled) nrf24l01_chip_enable(napi->device);
+    if (NRF24L01_FIELD_GET(RX_P_NO, status_register) > 5) return count;
+  }
+
+  // under load: mask RX_DR and leave the rest to nrf24l01_napi_poll()
+  napi->mode = nrf24l01_napi_mode_poll;
+  napi->stats.to_poll++;
+  nrf24l01_napi_rx_interrupt(napi->device, 0);
+  return count;
+}
+
+uint8_t nrf24l01_napi_poll(nrf24l01_napi * napi){
+  if (napi == NULL) return 0;
+  if (napi->mode != nrf24l01_napi_mode_poll) return 0;
+  napi->stats.polls++;
+
+  uint8_t status_register = nrf24l01_nop(napi->device);
+  uint8_t count = nrf24l01_napi_drain(napi, &status_register, napi->budget);
+  napi->stats.poll_packets += count;
+
+  if (NRF24L01_FIELD_GET(RX_P_NO, status_register) <= 5){
+    napi->stats.budget_exhausted++;
+    return count;
+  }
+  // the FIFO only stays empty for a whole poll period once the burst is over
+  if (count) return count;
+
+  // back to interrupts. The clear shifts out STATUS from before it: a
+  // payload that slipped in since the drain would lose its RX_DR there,
+  // so stay in polling mode. One arriving after the clear raises the IRQ
+  // once unmasked
+  uint8_t chip_enabled = nrf24l01_port_ce_read(napi->device);
+  status_register = nrf24l01_clear_interrupt_flags(napi->device, RX_DR);
+  if (NRF24L01_FIELD_GET(RX_P_NO, status_register) <= 5){
+    if (chip_enabled) nrf24l01_chip_enable(napi->device);
+    return count;
+  }
+  // in IRQ mode before the unmask, an edge right after it is not stale
+  napi->mode = nrf24l01_napi_mode_irq;
+  napi->stats.to_irq++;
+  nrf24l01_interrupt(napi->device, nrf24l01_irq_rx_data_ready, 1);
+  if (chip_enabled) nrf24l01_chip_enable(napi->device);
+  return count;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file nrf24l01_napi.h
+ * @brief Adaptive RX: interrupts while traffic is light, budgeted polling under load
+ *
+ * In interrupt mode every IRQ reads the RX FIFO from the handler. When an
+ * IRQ finds NRF24L01_NAPI_POLL_THRESHOLD or more payloads waiting, packets
+ * arrive faster than one interrupt per packet can keep up with: the
+ * handler reads one less than the threshold, masks RX_DR in CONFIG
+ * (MASK_RX_DR, through nrf24l01_interrupt()) and leaves the rest to
+ * nrf24l01_napi_poll(), called from the main loop or a timer, which reads
+ * at most budget payloads per call. The first poll that finds the FIFO already empty,
+ * with nothing arrived since the previous poll, clears RX_DR, unmasks it
+ * and returns to interrupt mode, unless the STATUS shifted out by the
+ * clear shows a payload that came in meanwhile; a poll that merely
+ * empties it stays in polling mode, so a steady stream does not flip
+ * modes every period.
+ *
+ * In polling mode no EXTI fires and RX_DR is not cleared per packet, so
+ * a saturated link costs only the width and payload transactions. A
+ * mode switch writes CONFIG, which needs CE low for a moment; the radio
+ * is back in RX 130 µs later.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_napi napi;
+ * nrf24l01_napi_init(&napi, &nrf, on_rx, NULL, 8);
+ *
+ * // EXTI callback of the IRQ pin
+ * nrf24l01_napi_irq(&napi);
+ *
+ * // main loop or 1 kHz timer
+ * nrf24l01_napi_poll(&napi);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_NAPI_H
+#define NRF24L01_DRIVER_NRF24L01_NAPI_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_NAPI Adaptive RX
+ * @brief Interrupt and polling hybrid for bursty traffic
+ * @{
+ */
+
+#ifndef NRF24L01_NAPI_POLL_THRESHOLD
+/** @brief Payloads waiting at one IRQ that switch to polling (2-3, the FIFO holds 3) */
+#define NRF24L01_NAPI_POLL_THRESHOLD   2
+#endif
+
+/**
+ * @brief RX mode
+ */
+typedef enum {
+    nrf24l01_napi_mode_irq = 0,            /**< RX_DR enabled, served from the IRQ handler */
+    nrf24l01_napi_mode_poll,               /**< RX_DR masked, served by nrf24l01_napi_poll() */
+} nrf24l01_napi_mode;
+
+/**
+ * @brief Payload callback
+ * @param pipe Receiving pipe (0-5)
+ * @param data Payload
+ * @param length Payload length (1-32)
+ * @param context User context
+ */
+typedef void (*nrf24l01_napi_handler)(uint8_t pipe, const uint8_t * data, uint8_t length, void * context);
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    uint32_t interrupts;                   /**< IRQs served */
+    uint32_t polls;                        /**< Poll calls that read the radio */
+    uint32_t irq_packets;                  /**< Payloads read in interrupt mode */
+    uint32_t poll_packets;                 /**< Payloads read in polling mode */
+    uint32_t to_poll;                      /**< Switches from interrupt to polling mode */
+    uint32_t to_irq;                       /**< Switches from polling to interrupt mode */
+    uint32_t budget_exhausted;             /**< Calls that stopped with payloads left in the FIFO */
+} nrf24l01_napi_stats;
+
+/**
+ * @brief Adaptive RX instance, one per PRX device
+ */
+typedef struct {
+    nrf24l01_device * device;              /**< Radio served */
+    nrf24l01_napi_handler on_rx;           /**< Payload callback */
+    void * context;                        /**< Payload callback context */
+    uint8_t budget;                        /**< Payloads read per call at most */
+    volatile uint8_t mode;                 /**< One of nrf24l01_napi_mode */
+    nrf24l01_napi_stats stats;             /**< Counters */
+} nrf24l01_napi;
+
+/**
+ * @brief Initialize in interrupt mode
+ * @param napi Pointer to instance
+ * @param device Pointer to an initialized PRX device
+ * @param on_rx Payload callback
+ * @param context Passed to on_rx
+ * @param budget Payloads read per call at most (1-255)
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_napi_init(nrf24l01_napi * napi, nrf24l01_device * device, nrf24l01_napi_handler on_rx,
+                           void * context, uint8_t budget);
+
+/**
+ * @brief Serve the IRQ, call from the handler of the IRQ pin
+ * @param napi Pointer to instance
+ * @return Number of payloads read
+ */
+uint8_t nrf24l01_napi_irq(nrf24l01_napi * napi);
+
+/**
+ * @brief Read up to budget payloads in polling mode
+ * @param napi Pointer to instance
+ * @return Number of payloads read, 0 in interrupt mode
+ */
+uint8_t nrf24l01_napi_poll(nrf24l01_napi * napi);
+
+/** @} */ // End of NRF24L01_NAPI group
+
+#endif //NRF24L01_DRIVER_NRF24L01_NAPI_H
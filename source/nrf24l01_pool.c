@@ -0,0 +1,79 @@
+#include "nrf24l01_pool.h"
+
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "nrf24l01_pool needs lock-free atomics");
+
+uint8_t nrf24l01_pool_init(nrf24l01_pool * pool){
+  if (pool == NULL) return -1;
+  memset(pool, 0, sizeof(nrf24l01_pool));
+  for (uint8_t i = 0; i < NRF24L01_POOL_SIZE; i++) atomic_init(&pool->packet[i].refcount, 0);
+  atomic_init(&pool->next, 0);
+  atomic_init(&pool->stats.allocated, 0);
+  atomic_init(&pool->stats.exhausted, 0);
+  atomic_init(&pool->stats.in_use, 0);
+  return 0;
+}
+
+nrf24l01_packet * nrf24l01_pool_alloc(nrf24l01_pool * pool){
+  if (pool == NULL) return NULL;
+
+  // start after the last allocation, the buffer just freed is usually further on
+  uint32_t start = atomic_fetch_add_explicit(&pool->next, 1, memory_order_relaxed);
+  for (uint8_t i = 0; i < NRF24L01_POOL_SIZE; i++){
+    nrf24l01_packet * packet = &pool->packet[(start + i) % NRF24L01_POOL_SIZE];
+    uint_fast8_t expected = 0;
+    // acquire: the last holder is done with the buffer before it is reused
+    if (atomic_compare_exchange_strong_explicit(&packet->refcount, &expected, 1,
+                                                memory_order_acquire, memory_order_relaxed)){
+      packet->length = 0;
+      packet->pipe = 0;
+      atomic_fetch_add_explicit(&pool->stats.allocated, 1, memory_order_relaxed);
+      atomic_fetch_add_explicit(&pool->stats.in_use, 1, memory_order_relaxed);
+      return packet;
+    }
+  }
+
+  atomic_fetch_add_explicit(&pool->stats.exhausted, 1, memory_order_relaxed);
+  return NULL;
+}
+
+void nrf24l01_packet_ref(nrf24l01_packet * packet){
+  if (packet == NULL) return;
+  atomic_fetch_add_explicit(&packet->refcount, 1, memory_order_relaxed);
+}
+
+void nrf24l01_packet_unref(nrf24l01_pool * pool, nrf24l01_packet * packet){
+  if (pool == NULL || packet == NULL) return;
+  if (atomic_fetch_sub_explicit(&packet->refcount, 1, memory_order_release) == 1)
+    atomic_fetch_sub_explicit(&pool->stats.in_use, 1, memory_order_relaxed);
+}
+
+nrf24l01_packet * nrf24l01_pool_receive(nrf24l01_pool * pool, nrf24l01_device * device, uint8_t status_register){
+  if (pool == NULL || device == NULL) return NULL;
+  uint8_t pipe = NRF24L01_FIELD_GET(RX_P_NO, status_register);
+  if (pipe > 5) return NULL; // RX FIFO empty
+
+  nrf24l01_packet * packet = nrf24l01_pool_alloc(pool);
+  if (packet == NULL) return NULL;
+
+  uint8_t length = device->data_pipe[pipe].nrf24l01_data_pipe_payload_width;
+  if (device->dynamic_payload_length_enable && device->data_pipe[pipe].nrf24l01_data_pipe_dyn_payload_length_enable){
+    nrf24l01_read_rx_payload_width(device, &length);
+    if (length < 1 || length > 32){
+      // corrupted length, the datasheet asks for a flush
+      nrf24l01_flush_rx(device);
+      nrf24l01_packet_unref(pool, packet);
+      return NULL;
+    }
+  }
+  if (length < 1 || length > 32) length = 32;
+
+  nrf24l01_read_rx_frame(device, packet->frame, length);
+  packet->length = length;
+  packet->pipe = pipe;
+  return packet;
+}
+
+uint8_t nrf24l01_packet_send(nrf24l01_device * device, nrf24l01_packet * packet, uint8_t command){
+  if (device == NULL || packet == NULL) return -1;
+  return nrf24l01_write_tx_frame(device, command, packet->frame, packet->length);
+}
@@ -0,0 +1,149 @@
+/**
+ * @file nrf24l01_pool.h
+ * @brief Fixed pool of reference-counted packet buffers for zero-copy RX, TX and forwarding
+ *
+ * Every packet buffer keeps one byte of headroom in front of the payload
+ * for the SPI command and STATUS of nrf24l01_read_rx_frame(), so it and
+ * nrf24l01_write_tx_frame() move the payload straight between the radio
+ * and the buffer, without staging copies. Sending only reads the buffer.
+ * A received packet is handed on by reference: queue it, forward it to
+ * another radio, or send it on several, and each holder drops its
+ * reference when done. The last one returns the buffer to the pool.
+ *
+ * Allocation and reference counting are lock-free (C11 atomics, like
+ * nrf24l01_txq), so tasks and interrupt handlers share one pool. The
+ * payload of a packet is only written by whoever allocated it, before
+ * it is shared.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_pool pool;
+ * nrf24l01_pool_init(&pool);
+ *
+ * // relay: receive on one radio, forward on another
+ * uint8_t status_register = nrf24l01_nop(&rx_radio);
+ * nrf24l01_packet * packet;
+ * while ((packet = nrf24l01_pool_receive(&pool, &rx_radio, status_register)) != NULL){
+ *   nrf24l01_packet_send(&tx_radio, packet, W_TX_PAYLOAD_NOACK);
+ *   nrf24l01_packet_ref(packet);
+ *   log_enqueue(packet);             // calls nrf24l01_packet_unref() later
+ *   nrf24l01_packet_unref(&pool, packet);
+ *   status_register = nrf24l01_nop(&rx_radio);
+ * }
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_POOL_H
+#define NRF24L01_DRIVER_NRF24L01_POOL_H
+
+#include <stdatomic.h>
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_POOL Packet Buffer Pool
+ * @brief Preallocated packet buffers with SPI headroom and reference counts
+ * @{
+ */
+
+#ifndef NRF24L01_POOL_SIZE
+/** @brief Packet buffers in a pool */
+#define NRF24L01_POOL_SIZE   16
+#endif
+
+/** @brief Bytes in front of the payload, for the command and STATUS byte */
+#define NRF24L01_POOL_HEADROOM   1
+
+/**
+ * @brief One packet buffer
+ */
+typedef struct {
+    uint8_t frame[NRF24L01_POOL_HEADROOM + 32];   /**< Headroom followed by the payload */
+    uint8_t length;                               /**< Payload length */
+    uint8_t pipe;                                 /**< Receiving pipe */
+    atomic_uint_fast8_t refcount;                 /**< Holders, 0 while free */
+} nrf24l01_packet;
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    atomic_uint_fast32_t allocated;        /**< Successful allocations */
+    atomic_uint_fast32_t exhausted;        /**< Allocations refused because every buffer was held */
+    atomic_uint_fast32_t in_use;           /**< Buffers currently held */
+} nrf24l01_pool_stats;
+
+/**
+ * @brief Pool instance
+ */
+typedef struct {
+    nrf24l01_packet packet[NRF24L01_POOL_SIZE];   /**< Packet buffers */
+    atomic_uint_fast32_t next;                    /**< Where the next allocation starts looking */
+    nrf24l01_pool_stats stats;                    /**< Counters */
+} nrf24l01_pool;
+
+/**
+ * @brief Initialize a pool with every buffer free
+ * @param pool Pointer to pool instance
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_pool_init(nrf24l01_pool * pool);
+
+/**
+ * @brief Take a free buffer, from any task or interrupt handler
+ * @param pool Pointer to pool instance
+ * @return Packet holding one reference, or NULL when the pool is exhausted
+ */
+nrf24l01_packet * nrf24l01_pool_alloc(nrf24l01_pool * pool);
+
+/**
+ * @brief Add a reference to a held packet
+ * @param packet Pointer to packet
+ */
+void nrf24l01_packet_ref(nrf24l01_packet * packet);
+
+/**
+ * @brief Drop a reference; the last one returns the buffer to the pool
+ * @param pool Pointer to the pool the packet came from
+ * @param packet Pointer to packet
+ */
+void nrf24l01_packet_unref(nrf24l01_pool * pool, nrf24l01_packet * packet);
+
+/**
+ * @brief Payload of a packet
+ * @param packet Pointer to packet
+ * @return Pointer to the first payload byte, behind the headroom
+ */
+static inline uint8_t * nrf24l01_packet_payload(nrf24l01_packet * packet){
+  return packet->frame + NRF24L01_POOL_HEADROOM;
+}
+
+/**
+ * @brief Read the next RX FIFO payload into a new packet
+ * @param pool Pointer to pool instance
+ * @param device Pointer to device
+ * @param status_register STATUS as last read, its RX_P_NO names the pipe of the payload
+ * @return Packet holding one reference, or NULL when the FIFO is empty, the pool is exhausted or on error
+ *
+ * The payload width comes from R_RX_PL_WID on dynamic payload pipes and
+ * from the configured width otherwise. A corrupted dynamic width flushes
+ * the RX FIFO, as the datasheet asks. The FIFO is left untouched while
+ * the pool is exhausted, so nothing is lost before the RX FIFO overflows.
+ */
+nrf24l01_packet * nrf24l01_pool_receive(nrf24l01_pool * pool, nrf24l01_device * device, uint8_t status_register);
+
+/**
+ * @brief Write a packet to the TX FIFO, or as an ACK payload, without copying it
+ * @param device Pointer to device
+ * @param packet Pointer to packet
+ * @param command W_TX_PAYLOAD, W_TX_PAYLOAD_NOACK or W_ACK_PAYLOAD | pipe
+ * @return Status register value, or -1 on error
+ *
+ * The packet is only read and keeps its references; it may be sent
+ * again, to the same or another radio, also by several radios at once
+ * from different contexts.
+ */
+uint8_t nrf24l01_packet_send(nrf24l01_device * device, nrf24l01_packet * packet, uint8_t command);
+
+/** @} */ // End of NRF24L01_POOL group
+
+#endif //NRF24L01_DRIVER_NRF24L01_POOL_H
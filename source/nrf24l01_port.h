@@ -0,0 +1,85 @@
+/**
+ * @file nrf24l01_port.h
+ * @brief Port layer: how the driver reaches SPI, GPIO and time
+ *
+ * The driver never calls a vendor library directly. Everything it needs
+ * from the board goes through the operations below, which a port header
+ * defines as macros or static inline functions. The port is chosen at
+ * compile time with NRF24L01_PORT, so the fast path inlines to the vendor
+ * call (or to register accesses) without any indirection. The runtime
+ * port instead calls through a table of function pointers per device,
+ * for boards where several bus types coexist.
+ *
+ * Shipped ports:
+ * | NRF24L01_PORT                 | Header                      | Binding                          |
+ * |-------------------------------|-----------------------------|----------------------------------|
+ * | NRF24L01_PORT_STM32_HAL (default) | nrf24l01_port_stm32_hal.h | STM32Cube HAL, any family      |
+ * | NRF24L01_PORT_STM32_LL        | nrf24l01_port_stm32_ll.h    | STM32Cube LL, polled SPI         |
+ * | NRF24L01_PORT_STM32_REG       | nrf24l01_port_stm32_reg.h   | CMSIS registers, pipelined SPI   |
+ * | NRF24L01_PORT_HOST            | nrf24l01_port_host.h        | emulated chip for host tests     |
+ * | NRF24L01_PORT_RUNTIME         | nrf24l01_port_runtime.h     | function pointers per device     |
+ * | NRF24L01_PORT_CUSTOM          | NRF24L01_PORT_HEADER        | your own                         |
+ *
+ * A port header provides:
+ * - NRF24L01_PORT_DEVICE_FIELDS: members added to nrf24l01_device (handles, pins)
+ * - NRF24L01_PORT_DEVICE_SIZE: bytes those members take, for the size budget
+ * - nrf24l01_port_spi_transfer(device, tx, rx, length): full-duplex transfer, 0 on success;
+ *   tx and rx may be the same buffer (in-place frame reads)
+ * - nrf24l01_port_spi_transmit(device, tx, length): optional transmit-only transfer that
+ *   leaves tx intact; without it the driver shifts the answer into a scratch buffer
+ * - nrf24l01_port_csn_write(device, level), nrf24l01_port_ce_write(device, level)
+ * - nrf24l01_port_ce_read(device), nrf24l01_port_irq_read(device): pin levels (0 or 1)
+ * - nrf24l01_port_micros(device): free running 16-bit microsecond counter
+ * - nrf24l01_port_millis(device): 32-bit millisecond tick
+ * - nrf24l01_port_delay_ms(device, ms)
+ * - nrf24l01_port_timer_start(device): start the microsecond counter
+ *
+ * @par Example Usage:
+ * @code
+ * // compiler flags for an STM32G4 project
+ * -DNRF24L01_STM32_HAL_HEADER=\"stm32g4xx_hal.h\"
+ *
+ * // or the LL port
+ * -DNRF24L01_PORT=NRF24L01_PORT_STM32_LL
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_H
+
+/**
+ * @defgroup NRF24L01_PORT Port Layer
+ * @brief Compile-time selection of the hardware binding
+ * @{
+ */
+
+#define NRF24L01_PORT_STM32_HAL   1  /**< STM32Cube HAL */
+#define NRF24L01_PORT_STM32_LL    2  /**< STM32Cube LL */
+#define NRF24L01_PORT_HOST        3  /**< Emulated chip on a host */
+#define NRF24L01_PORT_RUNTIME     4  /**< Function pointer table per device */
+#define NRF24L01_PORT_CUSTOM      5  /**< Port header named by NRF24L01_PORT_HEADER */
+#define NRF24L01_PORT_STM32_REG   6  /**< STM32 CMSIS registers, no HAL or LL */
+
+#ifndef NRF24L01_PORT
+#define NRF24L01_PORT   NRF24L01_PORT_STM32_HAL
+#endif
+
+#if NRF24L01_PORT == NRF24L01_PORT_STM32_HAL
+#include "nrf24l01_port_stm32_hal.h"
+#elif NRF24L01_PORT == NRF24L01_PORT_STM32_LL
+#include "nrf24l01_port_stm32_ll.h"
+#elif NRF24L01_PORT == NRF24L01_PORT_STM32_REG
+#include "nrf24l01_port_stm32_reg.h"
+#elif NRF24L01_PORT == NRF24L01_PORT_HOST
+#include "nrf24l01_port_host.h"
+#elif NRF24L01_PORT == NRF24L01_PORT_RUNTIME
+#include "nrf24l01_port_runtime.h"
+#elif NRF24L01_PORT == NRF24L01_PORT_CUSTOM
+#include NRF24L01_PORT_HEADER
+#else
+#error "unknown NRF24L01_PORT"
+#endif
+
+/** @} */ // End of NRF24L01_PORT group
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_H
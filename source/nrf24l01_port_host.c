@@ -0,0 +1,187 @@
+#include "nrf24l01.h"
+
+#if NRF24L01_PORT == NRF24L01_PORT_HOST
+
+uint32_t nrf24l01_host_clock_us = 0;
+
+// STATUS as the chip shifts it out: flags plus RX_P_NO of the FIFO head and TX_FULL
+static uint8_t nrf24l01_host_status(const nrf24l01_host_chip * chip){
+  uint8_t status = chip->registers[STATUS] & (RX_DR | TX_DS | MAX_RT);
+  status |= NRF24L01_FIELD_PREP(RX_P_NO, chip->rx_count ? chip->rx_pipe[0] : 7);
+  if (chip->tx_count == 3) status |= TX_FULL;
+  return status;
+}
+
+static uint8_t nrf24l01_host_fifo_status(const nrf24l01_host_chip * chip){
+  uint8_t fifo_status = 0;
+  if (chip->tx_reuse) fifo_status |= TX_REUSE;
+  if (chip->tx_count == 3) fifo_status |= FIFO_FULL;
+  if (chip->tx_count == 0) fifo_status |= TX_EMPTY;
+  if (chip->rx_count == 3) fifo_status |= RX_FULL;
+  if (chip->rx_count == 0) fifo_status |= RX_EMPTY;
+  return fifo_status;
+}
+
+static uint8_t * nrf24l01_host_address(nrf24l01_host_chip * chip, uint8_t reg){
+  switch (reg) {
+    case RX_ADDR_P0:
+      return chip->rx_addr_p0;
+    case RX_ADDR_P1:
+      return chip->rx_addr_p1;
+    case TX_ADDR:
+      return chip->tx_addr;
+    default:
+      return NULL;
+  }
+}
+
+static void nrf24l01_host_push_tx(nrf24l01_host_chip * chip, const uint8_t * data, uint16_t length){
+  if (chip->tx_count == 3 || length == 0) return; // payload lost, like on the chip
+  if (length > 32) length = 32;
+  memcpy(chip->tx_fifo[chip->tx_count], data, length);
+  chip->tx_length[chip->tx_count] = length;
+  chip->tx_count++;
+  chip->tx_reuse = 0;
+}
+
+static void nrf24l01_host_pop_rx(nrf24l01_host_chip * chip){
+  if (chip->rx_count == 0) return;
+  chip->rx_count--;
+  memmove(chip->rx_fifo[0], chip->rx_fifo[1], sizeof(chip->rx_fifo[0]) * chip->rx_count);
+  memmove(chip->rx_length, chip->rx_length + 1, chip->rx_count);
+  memmove(chip->rx_pipe, chip->rx_pipe + 1, chip->rx_count);
+}
+
+void nrf24l01_host_chip_reset(nrf24l01_host_chip * chip){
+  if (chip == NULL) return;
+  memset(chip, 0, sizeof(nrf24l01_host_chip));
+  chip->registers[CONFIG] = EN_CRC;
+  chip->registers[EN_AA] = 0x3F;
+  chip->registers[EN_RXADDR] = ERX_P0 | ERX_P1;
+  chip->registers[SETUP_AW] = 0x03;
+  chip->registers[SETUP_RETR] = 0x03;
+  chip->registers[RF_CH] = 0x02;
+  chip->registers[RF_SETUP] = RF_DR | RF_PWR | LNA_HCURR;
+  chip->registers[STATUS] = 0x0E;
+  chip->registers[RX_ADDR_P2] = 0xC3;
+  chip->registers[RX_ADDR_P3] = 0xC4;
+  chip->registers[RX_ADDR_P4] = 0xC5;
+  chip->registers[RX_ADDR_P5] = 0xC6;
+  memset(chip->rx_addr_p0, 0xE7, 5);
+  memset(chip->rx_addr_p1, 0xC2, 5);
+  memset(chip->tx_addr, 0xE7, 5);
+  chip->csn = 1;
+}
+
+uint8_t nrf24l01_host_spi_transfer(nrf24l01_host_chip * chip, const uint8_t * tx, uint8_t * rx, uint16_t length){
+  if (chip == NULL || tx == NULL || rx == NULL || length == 0) return -1;
+  if (length > 33) return -1; // longer than any command
+
+  // tx and rx may be the same buffer
+  uint8_t in[33];
+  memcpy(in, tx, length);
+  uint8_t command = in[0];
+  uint16_t data_length = length - 1;
+  const uint8_t * data_in = in + 1;
+  uint8_t * data_out = rx + 1;
+
+  chip->spi_command = command;
+  chip->spi_transactions++;
+  chip->spi_bytes += length;
+  rx[0] = nrf24l01_host_status(chip);
+  memset(data_out, 0, data_length);
+
+  if ((command & 0xE0) == R_REGISTER){
+    uint8_t reg = command & 0x1F;
+    uint8_t * address = nrf24l01_host_address(chip, reg);
+    if (address != NULL)
+      memcpy(data_out, address, data_length > 5 ? 5 : data_length);
+    else if (data_length > 0)
+      data_out[0] = reg == STATUS ? rx[0] : reg == FIFO_STATUS ? nrf24l01_host_fifo_status(chip) : chip->registers[reg];
+  }
+  else if ((command & 0xE0) == W_REGISTER){
+    uint8_t reg = command & 0x1F;
+    uint8_t * address = nrf24l01_host_address(chip, reg);
+    if (address != NULL)
+      memcpy(address, data_in, data_length > 5 ? 5 : data_length);
+    else if (reg == STATUS && data_length > 0)
+      chip->registers[STATUS] &= ~(data_in[0] & (RX_DR | TX_DS | MAX_RT)); // write 1 to clear
+    else if (data_length > 0 && reg != FIFO_STATUS && reg != OBSERVE_TX && reg != PRD)
+      chip->registers[reg] = data_in[0];
+  }
+  else if (command == R_RX_PAYLOAD){
+    if (chip->rx_count){
+      memcpy(data_out, chip->rx_fifo[0], data_length > 32 ? 32 : data_length);
+      nrf24l01_host_pop_rx(chip);
+    }
+  }
+  else if (command == W_TX_PAYLOAD || command == W_TX_PAYLOAD_NOACK || (command & 0xF8) == W_ACK_PAYLOAD)
+    nrf24l01_host_push_tx(chip, data_in, data_length);
+  else if (command == R_RX_PL_WID){
+    if (data_length > 0) data_out[0] = chip->rx_count ? chip->rx_length[0] : 0;
+  }
+  else if (command == FLUSH_TX){
+    chip->tx_count = 0;
+    chip->tx_reuse = 0;
+  }
+  else if (command == FLUSH_RX)
+    chip->rx_count = 0;
+  else if (command == REUSE_TX_PL)
+    chip->tx_reuse = 1;
+
+  return 0;
+}
+
+uint8_t nrf24l01_host_spi_transmit(nrf24l01_host_chip * chip, const uint8_t * tx, uint16_t length){
+  if (chip == NULL || tx == NULL || length == 0) return -1;
+  uint8_t command = chip->spi_command;
+
+  chip->spi_bytes += length;
+  if (command == W_TX_PAYLOAD || command == W_TX_PAYLOAD_NOACK || (command & 0xF8) == W_ACK_PAYLOAD)
+    nrf24l01_host_push_tx(chip, tx, length);
+  return 0;
+}
+
+uint8_t nrf24l01_host_receive(nrf24l01_host_chip * chip, uint8_t pipe, const uint8_t * data, uint8_t length){
+  if (chip == NULL || data == NULL) return -1;
+  if (pipe > 5 || length < 1 || length > 32) return -1; // invalid packet
+  if (!(chip->registers[EN_RXADDR] & (1 << pipe))) return -1; // pipe disabled
+  if (chip->rx_count == 3) return -1; // RX FIFO full, packet dropped
+
+  memcpy(chip->rx_fifo[chip->rx_count], data, length);
+  chip->rx_length[chip->rx_count] = length;
+  chip->rx_pipe[chip->rx_count] = pipe;
+  chip->rx_count++;
+  chip->registers[STATUS] |= RX_DR;
+  return 0;
+}
+
+uint8_t nrf24l01_host_complete_tx(nrf24l01_host_chip * chip, uint8_t * data, uint8_t acked){
+  if (chip == NULL || chip->tx_count == 0) return 0;
+  uint8_t length = chip->tx_length[0];
+  if (data != NULL) memcpy(data, chip->tx_fifo[0], length);
+
+  if (!acked){
+    chip->registers[STATUS] |= MAX_RT;
+    return length;
+  }
+
+  chip->registers[STATUS] |= TX_DS;
+  if (!chip->tx_reuse){
+    chip->tx_count--;
+    memmove(chip->tx_fifo[0], chip->tx_fifo[1], sizeof(chip->tx_fifo[0]) * chip->tx_count);
+    memmove(chip->tx_length, chip->tx_length + 1, chip->tx_count);
+  }
+  return length;
+}
+
+uint8_t nrf24l01_host_irq(const nrf24l01_host_chip * chip){
+  if (chip == NULL) return 1;
+  uint8_t config = chip->registers[CONFIG];
+  uint8_t flags = chip->registers[STATUS];
+  // MASK_x bits of CONFIG line up with the STATUS flags
+  flags &= ~config & (RX_DR | TX_DS | MAX_RT);
+  return flags == 0;
+}
+
+#endif
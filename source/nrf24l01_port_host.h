@@ -0,0 +1,137 @@
+/**
+ * @file nrf24l01_port_host.h
+ * @brief Host port: the driver against an emulated chip, for tests and benchmarks
+ *
+ * Builds with any C11 compiler, no vendor headers. Each device points at a
+ * nrf24l01_host_chip that models the register file, the 3-level TX and RX
+ * FIFOs, the STATUS/FIFO_STATUS bits and the SPI commands. Time is virtual:
+ * delays advance the clock instantly and every microsecond read advances
+ * it by one, so busy waits terminate. The test plays the other side of the
+ * air with nrf24l01_host_receive() and nrf24l01_host_complete_tx().
+ *
+ * @par Example Usage:
+ * @code
+ * // cc -DNRF24L01_PORT=NRF24L01_PORT_HOST nrf24l01.c nrf24l01_port_host.c test.c
+ * nrf24l01_host_chip chip;
+ * nrf24l01_host_chip_reset(&chip);
+ * nrf24l01_device nrf = nrf24l01_get_default_config();
+ * nrf.chip = &chip;
+ * nrf24l01_init(&nrf);
+ *
+ * nrf24l01_host_receive(&chip, 1, (const uint8_t *)"ping", 4);
+ * uint8_t status = nrf24l01_nop(&nrf);      // RX_DR set, pipe 1
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_HOST_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_HOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Emulated nRF24L01+
+ */
+typedef struct{
+    uint8_t registers[0x20];             /**< Single byte registers by address */
+    uint8_t rx_addr_p0[5];               /**< RX_ADDR_P0 */
+    uint8_t rx_addr_p1[5];               /**< RX_ADDR_P1 */
+    uint8_t tx_addr[5];                  /**< TX_ADDR */
+    uint8_t tx_fifo[3][32];              /**< TX FIFO (and ACK payloads), head first */
+    uint8_t tx_length[3];                /**< Payload length per TX FIFO slot */
+    uint8_t tx_count;                    /**< Payloads in the TX FIFO */
+    uint8_t tx_reuse;                    /**< REUSE_TX_PL active */
+    uint8_t rx_fifo[3][32];              /**< RX FIFO, head first */
+    uint8_t rx_length[3];                /**< Payload length per RX FIFO slot */
+    uint8_t rx_pipe[3];                  /**< Pipe per RX FIFO slot */
+    uint8_t rx_count;                    /**< Payloads in the RX FIFO */
+    uint8_t ce;                          /**< CE pin level */
+    uint8_t csn;                         /**< CSN pin level */
+    uint8_t spi_command;                 /**< Command byte of the last transaction */
+    uint32_t spi_transactions;           /**< SPI transactions seen */
+    uint32_t spi_bytes;                  /**< SPI bytes exchanged */
+} nrf24l01_host_chip;
+
+/** @brief Virtual time in µs, shared by every emulated chip */
+extern uint32_t nrf24l01_host_clock_us;
+
+/**
+ * @brief Put a chip in its power-on reset state
+ * @param chip Pointer to emulated chip
+ */
+void nrf24l01_host_chip_reset(nrf24l01_host_chip * chip);
+
+/**
+ * @brief One SPI transaction (CSN low to CSN high)
+ * @param chip Pointer to emulated chip
+ * @param tx Bytes from the MCU, command first
+ * @param rx Bytes to the MCU, STATUS first
+ * @param length Transaction length
+ * @return 0
+ */
+uint8_t nrf24l01_host_spi_transfer(nrf24l01_host_chip * chip, const uint8_t * tx, uint8_t * rx, uint16_t length);
+
+/**
+ * @brief Transmit-only bytes continuing the transaction, still under CSN low
+ * @param chip Pointer to emulated chip
+ * @param tx Payload bytes of the command sent by the last nrf24l01_host_spi_transfer()
+ * @param length Number of bytes
+ * @return 0
+ *
+ * Only the payload writes (W_TX_PAYLOAD, W_TX_PAYLOAD_NOACK, W_ACK_PAYLOAD)
+ * are split this way, after a transfer of the command byte alone.
+ */
+uint8_t nrf24l01_host_spi_transmit(nrf24l01_host_chip * chip, const uint8_t * tx, uint16_t length);
+
+/**
+ * @brief A packet arrives over the air
+ * @param chip Pointer to emulated chip
+ * @param pipe Receiving pipe (0-5)
+ * @param data Payload
+ * @param length Payload length (1-32)
+ * @return 0 on success, non-zero when the RX FIFO is full or the pipe is disabled
+ */
+uint8_t nrf24l01_host_receive(nrf24l01_host_chip * chip, uint8_t pipe, const uint8_t * data, uint8_t length);
+
+/**
+ * @brief The payload at the TX FIFO head finishes its transmission
+ * @param chip Pointer to emulated chip
+ * @param data Receives the payload, may be NULL
+ * @param acked 1 for TX_DS (payload removed), 0 for MAX_RT (payload kept)
+ * @return Payload length, 0 when the TX FIFO is empty
+ */
+uint8_t nrf24l01_host_complete_tx(nrf24l01_host_chip * chip, uint8_t * data, uint8_t acked);
+
+/**
+ * @brief IRQ pin level: low while an unmasked interrupt flag is set
+ * @param chip Pointer to emulated chip
+ * @return Pin level
+ */
+uint8_t nrf24l01_host_irq(const nrf24l01_host_chip * chip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define NRF24L01_PORT_DEVICE_FIELDS \
+    nrf24l01_host_chip * chip;                      /**< Emulated chip */
+
+#define NRF24L01_PORT_DEVICE_SIZE   (sizeof(void *))
+
+#define nrf24l01_port_spi_transfer(device, tx, rx, length) \
+    nrf24l01_host_spi_transfer((device)->chip, (tx), (rx), (length))
+#define nrf24l01_port_spi_transmit(device, tx, length) \
+    nrf24l01_host_spi_transmit((device)->chip, (tx), (length))
+#define nrf24l01_port_csn_write(device, level)   ((device)->chip->csn = (level) != 0)
+#define nrf24l01_port_ce_write(device, level)    ((device)->chip->ce = (level) != 0)
+#define nrf24l01_port_ce_read(device)            ((device)->chip->ce)
+#define nrf24l01_port_irq_read(device)           nrf24l01_host_irq((device)->chip)
+#define nrf24l01_port_micros(device)             ((uint16_t)nrf24l01_host_clock_us++)
+#define nrf24l01_port_millis(device)             (nrf24l01_host_clock_us / 1000)
+#define nrf24l01_port_delay_ms(device, ms)       (nrf24l01_host_clock_us += (uint32_t)(ms) * 1000)
+#define nrf24l01_port_timer_start(device)        ((void)0)
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_HOST_H
@@ -0,0 +1,66 @@
+/**
+ * @file nrf24l01_port_runtime.h
+ * @brief Runtime port: one table of functions per device
+ *
+ * Each device points at a nrf24l01_port_ops table and an opaque context
+ * handed back to every call, so radios on different buses (HAL SPI, a
+ * bit-banged bus, an SPI expander...) can be driven by the same build.
+ * Costs one indirect call per operation.
+ *
+ * @par Example Usage:
+ * @code
+ * static uint8_t board_spi(void * context, const uint8_t * tx, uint8_t * rx, uint16_t length){ ... }
+ * // ... other functions
+ * static const nrf24l01_port_ops board_ops = {
+ *     .spi_transfer = board_spi, .csn_write = board_csn, .ce_write = board_ce_write,
+ *     .ce_read = board_ce_read, .irq_read = board_irq, .micros = board_micros,
+ *     .millis = board_millis, .delay_ms = board_delay_ms, .timer_start = NULL,
+ * };
+ *
+ * nrf24l01_device nrf = nrf24l01_get_default_config();
+ * nrf.port = &board_ops;
+ * nrf.port_context = &board_radio_1;
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_RUNTIME_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_RUNTIME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Board operations, every function receives the device's port_context
+ */
+typedef struct{
+    uint8_t (*spi_transfer)(void * context, const uint8_t * tx, uint8_t * rx, uint16_t length); /**< 0 on success */
+    void (*csn_write)(void * context, uint8_t level);    /**< Drive CSN */
+    void (*ce_write)(void * context, uint8_t level);     /**< Drive CE */
+    uint8_t (*ce_read)(void * context);                  /**< CE level */
+    uint8_t (*irq_read)(void * context);                 /**< IRQ level, may be NULL */
+    uint16_t (*micros)(void * context);                  /**< Free running µs counter */
+    uint32_t (*millis)(void * context);                  /**< Millisecond tick */
+    void (*delay_ms)(void * context, uint32_t ms);       /**< Blocking delay */
+    void (*timer_start)(void * context);                 /**< Start the µs counter, may be NULL */
+} nrf24l01_port_ops;
+
+#define NRF24L01_PORT_DEVICE_FIELDS \
+    const nrf24l01_port_ops * port;                  /**< Board operations */ \
+    void * port_context;                             /**< Passed to every operation */
+
+#define NRF24L01_PORT_DEVICE_SIZE   (2 * sizeof(void *))
+
+#define nrf24l01_port_spi_transfer(device, tx, rx, length) \
+    (device)->port->spi_transfer((device)->port_context, (tx), (rx), (length))
+#define nrf24l01_port_csn_write(device, level)   (device)->port->csn_write((device)->port_context, (level))
+#define nrf24l01_port_ce_write(device, level)    (device)->port->ce_write((device)->port_context, (level))
+#define nrf24l01_port_ce_read(device)            (device)->port->ce_read((device)->port_context)
+#define nrf24l01_port_irq_read(device) \
+    ((device)->port->irq_read != NULL ? (device)->port->irq_read((device)->port_context) : 1)
+#define nrf24l01_port_micros(device)             (device)->port->micros((device)->port_context)
+#define nrf24l01_port_millis(device)             (device)->port->millis((device)->port_context)
+#define nrf24l01_port_delay_ms(device, ms)       (device)->port->delay_ms((device)->port_context, (ms))
+#define nrf24l01_port_timer_start(device) \
+    ((device)->port->timer_start != NULL ? (device)->port->timer_start((device)->port_context) : (void)0)
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_RUNTIME_H
@@ -0,0 +1,59 @@
+/**
+ * @file nrf24l01_port_stm32_hal.h
+ * @brief STM32Cube HAL port (default)
+ *
+ * Works with every STM32 family; the family header defaults to the F1 one
+ * and is changed with NRF24L01_STM32_HAL_HEADER. Pins are HAL pin masks
+ * (GPIO_PIN_x). The microsecond counter is a timer running at 1 MHz.
+ *
+ * @par Example Usage:
+ * @code
+ * nrf24l01_device nrf = nrf24l01_get_default_config();
+ * nrf.spi = &hspi1;
+ * nrf.ce_port = GPIOA;
+ * nrf.ce_pin = GPIO_PIN_8;
+ * nrf.csn_port = GPIOA;
+ * nrf.csn_pin = GPIO_PIN_9;
+ * nrf.timer = &htim2;      // prescaler set for a 1 MHz count
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_STM32_HAL_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_STM32_HAL_H
+
+#ifndef NRF24L01_STM32_HAL_HEADER
+#define NRF24L01_STM32_HAL_HEADER   "stm32f1xx_hal.h"
+#endif
+#include NRF24L01_STM32_HAL_HEADER
+
+/** @brief SPI timeout in ms */
+#ifndef NRF24L01_STM32_HAL_SPI_TIMEOUT
+#define NRF24L01_STM32_HAL_SPI_TIMEOUT   100
+#endif
+
+#define NRF24L01_PORT_DEVICE_FIELDS \
+    SPI_HandleTypeDef * spi;                         /**< SPI handle for communication */ \
+    GPIO_TypeDef *irq_port, *ce_port, *csn_port;    /**< GPIO ports for control pins */ \
+    TIM_HandleTypeDef * timer;                       /**< Timer handle for microsecond delays */ \
+    uint16_t irq_pin, ce_pin, csn_pin;              /**< GPIO pin masks (GPIO_PIN_x) */
+
+#define NRF24L01_PORT_DEVICE_SIZE   (5 * sizeof(void *) + 3 * sizeof(uint16_t))
+
+#define nrf24l01_port_spi_transfer(device, tx, rx, length) \
+    HAL_SPI_TransmitReceive((device)->spi, (uint8_t *)(tx), (rx), (length), NRF24L01_STM32_HAL_SPI_TIMEOUT)
+#define nrf24l01_port_spi_transmit(device, tx, length) \
+    HAL_SPI_Transmit((device)->spi, (uint8_t *)(tx), (length), NRF24L01_STM32_HAL_SPI_TIMEOUT)
+#define nrf24l01_port_csn_write(device, level) \
+    HAL_GPIO_WritePin((device)->csn_port, (device)->csn_pin, (level) ? GPIO_PIN_SET : GPIO_PIN_RESET)
+#define nrf24l01_port_ce_write(device, level) \
+    HAL_GPIO_WritePin((device)->ce_port, (device)->ce_pin, (level) ? GPIO_PIN_SET : GPIO_PIN_RESET)
+#define nrf24l01_port_ce_read(device) \
+    (HAL_GPIO_ReadPin((device)->ce_port, (device)->ce_pin) == GPIO_PIN_SET)
+#define nrf24l01_port_irq_read(device) \
+    (HAL_GPIO_ReadPin((device)->irq_port, (device)->irq_pin) == GPIO_PIN_SET)
+#define nrf24l01_port_micros(device)          ((uint16_t)__HAL_TIM_GET_COUNTER((device)->timer))
+#define nrf24l01_port_millis(device)          HAL_GetTick()
+#define nrf24l01_port_delay_ms(device, ms)    HAL_Delay(ms)
+#define nrf24l01_port_timer_start(device)     HAL_TIM_Base_Start((device)->timer)
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_STM32_HAL_H
@@ -0,0 +1,102 @@
+/**
+ * @file nrf24l01_port_stm32_ll.h
+ * @brief STM32Cube LL port
+ *
+ * Polled 8-bit SPI transfer on the peripheral registers through the LL
+ * inline functions, pins through BSRR. The SPI must be configured (8-bit,
+ * mode 0, software NSS) and enabled by the application. The family headers
+ * default to the F1 ones and are changed with NRF24L01_STM32_LL_*_HEADER.
+ *
+ * LL has no millisecond tick: the application provides
+ * nrf24l01_ll_millis(), usually a counter incremented in SysTick_Handler.
+ *
+ * @par Example Usage:
+ * @code
+ * volatile uint32_t ticks;
+ * void SysTick_Handler(void) { ticks++; }
+ * uint32_t nrf24l01_ll_millis(void) { return ticks; }
+ *
+ * nrf24l01_device nrf = nrf24l01_get_default_config();
+ * nrf.spi = SPI1;
+ * nrf.ce_port = GPIOA;
+ * nrf.ce_pin = LL_GPIO_PIN_8;
+ * nrf.csn_port = GPIOA;
+ * nrf.csn_pin = LL_GPIO_PIN_9;
+ * nrf.timer = TIM2;        // prescaler set for a 1 MHz count
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_STM32_LL_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_STM32_LL_H
+
+#include <stdint.h>
+
+#ifndef NRF24L01_STM32_LL_SPI_HEADER
+#define NRF24L01_STM32_LL_SPI_HEADER     "stm32f1xx_ll_spi.h"
+#endif
+#ifndef NRF24L01_STM32_LL_GPIO_HEADER
+#define NRF24L01_STM32_LL_GPIO_HEADER    "stm32f1xx_ll_gpio.h"
+#endif
+#ifndef NRF24L01_STM32_LL_TIM_HEADER
+#define NRF24L01_STM32_LL_TIM_HEADER     "stm32f1xx_ll_tim.h"
+#endif
+#ifndef NRF24L01_STM32_LL_UTILS_HEADER
+#define NRF24L01_STM32_LL_UTILS_HEADER   "stm32f1xx_ll_utils.h"
+#endif
+#include NRF24L01_STM32_LL_SPI_HEADER
+#include NRF24L01_STM32_LL_GPIO_HEADER
+#include NRF24L01_STM32_LL_TIM_HEADER
+#include NRF24L01_STM32_LL_UTILS_HEADER
+
+#define NRF24L01_PORT_DEVICE_FIELDS \
+    SPI_TypeDef * spi;                               /**< SPI peripheral */ \
+    GPIO_TypeDef *irq_port, *ce_port, *csn_port;    /**< GPIO ports for control pins */ \
+    TIM_TypeDef * timer;                             /**< Timer counting microseconds */ \
+    uint32_t irq_pin, ce_pin, csn_pin;              /**< GPIO pin masks (LL_GPIO_PIN_x) */
+
+#define NRF24L01_PORT_DEVICE_SIZE   (5 * sizeof(void *) + 3 * sizeof(uint32_t))
+
+/** @brief Millisecond tick, provided by the application */
+uint32_t nrf24l01_ll_millis(void);
+
+static inline uint8_t nrf24l01_ll_spi_transfer(SPI_TypeDef * spi, const uint8_t * tx, uint8_t * rx, uint16_t length){
+  for (uint16_t i = 0; i < length; i++){
+    while (!LL_SPI_IsActiveFlag_TXE(spi));
+    LL_SPI_TransmitData8(spi, tx[i]);
+    while (!LL_SPI_IsActiveFlag_RXNE(spi));
+    rx[i] = LL_SPI_ReceiveData8(spi);
+  }
+  while (LL_SPI_IsActiveFlag_BSY(spi));
+  return 0;
+}
+
+static inline uint8_t nrf24l01_ll_spi_transmit(SPI_TypeDef * spi, const uint8_t * tx, uint16_t length){
+  for (uint16_t i = 0; i < length; i++){
+    while (!LL_SPI_IsActiveFlag_TXE(spi));
+    LL_SPI_TransmitData8(spi, tx[i]);
+  }
+  while (LL_SPI_IsActiveFlag_BSY(spi));
+  // drop what was shifted in, and the overrun it caused
+  while (LL_SPI_IsActiveFlag_RXNE(spi)) LL_SPI_ReceiveData8(spi);
+  LL_SPI_ClearFlag_OVR(spi);
+  return 0;
+}
+
+#define nrf24l01_port_spi_transfer(device, tx, rx, length) \
+    nrf24l01_ll_spi_transfer((device)->spi, (tx), (rx), (length))
+#define nrf24l01_port_spi_transmit(device, tx, length) \
+    nrf24l01_ll_spi_transmit((device)->spi, (tx), (length))
+#define nrf24l01_port_csn_write(device, level) \
+    ((level) ? LL_GPIO_SetOutputPin((device)->csn_port, (device)->csn_pin) \
+             : LL_GPIO_ResetOutputPin((device)->csn_port, (device)->csn_pin))
+#define nrf24l01_port_ce_write(device, level) \
+    ((level) ? LL_GPIO_SetOutputPin((device)->ce_port, (device)->ce_pin) \
+             : LL_GPIO_ResetOutputPin((device)->ce_port, (device)->ce_pin))
+#define nrf24l01_port_ce_read(device)         (LL_GPIO_IsOutputPinSet((device)->ce_port, (device)->ce_pin) != 0)
+#define nrf24l01_port_irq_read(device)        (LL_GPIO_IsInputPinSet((device)->irq_port, (device)->irq_pin) != 0)
+#define nrf24l01_port_micros(device)          ((uint16_t)LL_TIM_GetCounter((device)->timer))
+#define nrf24l01_port_millis(device)          nrf24l01_ll_millis()
+#define nrf24l01_port_delay_ms(device, ms)    LL_mDelay(ms)
+#define nrf24l01_port_timer_start(device)     LL_TIM_EnableCounter((device)->timer)
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_STM32_LL_H
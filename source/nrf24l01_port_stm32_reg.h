@@ -0,0 +1,128 @@
+/**
+ * @file nrf24l01_port_stm32_reg.h
+ * @brief STM32 register port: BSRR pins and a polled SPI data register loop
+ *
+ * For the ISR path, where a NOP or a one-byte register access is shorter
+ * than the HAL bookkeeping around it. CSN and CE are single BSRR stores,
+ * and the SPI loop keeps the transmit buffer one byte ahead of the receive
+ * side, so the bus never idles between the bytes of a 1-33 byte frame. No
+ * timeout, no state machine, no function call: everything inlines into
+ * the driver.
+ *
+ * Needs only the CMSIS device header (NRF24L01_STM32_DEVICE_HEADER, the F1
+ * one by default). The SPI must be configured (master, 8-bit, mode 0,
+ * software NSS) and enabled by the application. Data register accesses
+ * are 8-bit, so families with an SPI FIFO (F0, F3, F7, L4, G4...) move
+ * one byte per access as well.
+ *
+ * The pipelined loop reads each byte while the next one is shifting. An
+ * interrupt longer than one byte time between the two can overrun the
+ * receive register; define NRF24L01_STM32_REG_PIPELINED to 0 to wait for
+ * every byte instead, or keep the transfer in a context that is not
+ * preempted for that long.
+ *
+ * The application provides the millisecond tick, nrf24l01_reg_millis(),
+ * usually a counter incremented in SysTick_Handler.
+ *
+ * @par Example Usage:
+ * @code
+ * // -DNRF24L01_PORT=NRF24L01_PORT_STM32_REG -DNRF24L01_STM32_DEVICE_HEADER=\"stm32g4xx.h\"
+ * nrf24l01_device nrf = nrf24l01_get_default_config();
+ * nrf.spi = SPI1;
+ * nrf.ce_port = GPIOA;
+ * nrf.ce_pin = 1 << 8;
+ * nrf.csn_port = GPIOA;
+ * nrf.csn_pin = 1 << 9;
+ * nrf.timer = TIM2;        // prescaler set for a 1 MHz count
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PORT_STM32_REG_H
+#define NRF24L01_DRIVER_NRF24L01_PORT_STM32_REG_H
+
+#include <stdint.h>
+
+#ifndef NRF24L01_STM32_DEVICE_HEADER
+#define NRF24L01_STM32_DEVICE_HEADER   "stm32f1xx.h"
+#endif
+#include NRF24L01_STM32_DEVICE_HEADER
+
+/** @brief 1: next byte written before the previous one is read */
+#ifndef NRF24L01_STM32_REG_PIPELINED
+#define NRF24L01_STM32_REG_PIPELINED   1
+#endif
+
+#define NRF24L01_PORT_DEVICE_FIELDS \
+    SPI_TypeDef * spi;                               /**< SPI peripheral */ \
+    GPIO_TypeDef *irq_port, *ce_port, *csn_port;    /**< GPIO ports for control pins */ \
+    TIM_TypeDef * timer;                             /**< Timer counting microseconds */ \
+    uint16_t irq_pin, ce_pin, csn_pin;              /**< GPIO pin masks (1 << n) */
+
+#define NRF24L01_PORT_DEVICE_SIZE   (5 * sizeof(void *) + 3 * sizeof(uint16_t))
+
+/** @brief Millisecond tick, provided by the application */
+uint32_t nrf24l01_reg_millis(void);
+
+/** @brief 8-bit access to the SPI data register; a register model may supply its own */
+#ifndef NRF24L01_STM32_REG_DR8
+#define NRF24L01_STM32_REG_DR8(spi)   (*(volatile uint8_t *)&(spi)->DR)
+#endif
+
+static inline uint8_t nrf24l01_reg_spi_transfer(SPI_TypeDef * spi, const uint8_t * tx, uint8_t * rx, uint16_t length){
+#if NRF24L01_STM32_REG_PIPELINED
+  // TXE is set right after enabling the SPI, the first byte goes out at once
+  NRF24L01_STM32_REG_DR8(spi) = tx[0];
+  for (uint16_t i = 1; i < length; i++){
+    while (!(spi->SR & SPI_SR_TXE));
+    NRF24L01_STM32_REG_DR8(spi) = tx[i];
+    while (!(spi->SR & SPI_SR_RXNE));
+    rx[i - 1] = NRF24L01_STM32_REG_DR8(spi);
+  }
+  while (!(spi->SR & SPI_SR_RXNE));
+  rx[length - 1] = NRF24L01_STM32_REG_DR8(spi);
+#else
+  for (uint16_t i = 0; i < length; i++){
+    NRF24L01_STM32_REG_DR8(spi) = tx[i];
+    while (!(spi->SR & SPI_SR_RXNE));
+    rx[i] = NRF24L01_STM32_REG_DR8(spi);
+  }
+#endif
+  // CSN must not rise before the last clock edge
+  while (spi->SR & SPI_SR_BSY);
+  return 0;
+}
+
+static inline uint8_t nrf24l01_reg_spi_transmit(SPI_TypeDef * spi, const uint8_t * tx, uint16_t length){
+  for (uint16_t i = 0; i < length; i++){
+    while (!(spi->SR & SPI_SR_TXE));
+    NRF24L01_STM32_REG_DR8(spi) = tx[i];
+  }
+  while (spi->SR & SPI_SR_BSY);
+  // drop what was shifted in; reading DR then SR also clears the overrun
+  while (spi->SR & SPI_SR_RXNE) (void)NRF24L01_STM32_REG_DR8(spi);
+  (void)spi->SR;
+  return 0;
+}
+
+static inline void nrf24l01_reg_delay_ms(uint32_t ms){
+  uint32_t start = nrf24l01_reg_millis();
+  // +1: the current tick may be about to end
+  while (nrf24l01_reg_millis() - start < ms + 1);
+}
+
+#define nrf24l01_port_spi_transfer(device, tx, rx, length) \
+    nrf24l01_reg_spi_transfer((device)->spi, (tx), (rx), (length))
+#define nrf24l01_port_spi_transmit(device, tx, length) \
+    nrf24l01_reg_spi_transmit((device)->spi, (tx), (length))
+#define nrf24l01_port_csn_write(device, level) \
+    ((device)->csn_port->BSRR = (level) ? (uint32_t)(device)->csn_pin : (uint32_t)(device)->csn_pin << 16)
+#define nrf24l01_port_ce_write(device, level) \
+    ((device)->ce_port->BSRR = (level) ? (uint32_t)(device)->ce_pin : (uint32_t)(device)->ce_pin << 16)
+#define nrf24l01_port_ce_read(device)         (((device)->ce_port->ODR & (device)->ce_pin) != 0)
+#define nrf24l01_port_irq_read(device)        (((device)->irq_port->IDR & (device)->irq_pin) != 0)
+#define nrf24l01_port_micros(device)          ((uint16_t)(device)->timer->CNT)
+#define nrf24l01_port_millis(device)          nrf24l01_reg_millis()
+#define nrf24l01_port_delay_ms(device, ms)    nrf24l01_reg_delay_ms(ms)
+#define nrf24l01_port_timer_start(device)     ((device)->timer->CR1 |= TIM_CR1_CEN)
+
+#endif //NRF24L01_DRIVER_NRF24L01_PORT_STM32_REG_H
@@ -0,0 +1,182 @@
+#include "nrf24l01_power.h"
+
+// CE is low
+static void nrf24l01_power_pwr_up(nrf24l01_device * device, uint8_t enable){
+  uint8_t config_register = 0;
+  nrf24l01_read_register(device, CONFIG, &config_register, 1);
+  if (enable)
+    config_register |= PWR_UP;
+  else
+    config_register &= ~PWR_UP;
+  nrf24l01_write_register(device, CONFIG, &config_register, 1);
+  device->power_up = enable != 0;
+}
+
+static void nrf24l01_power_start_tx(nrf24l01_power * power){
+  nrf24l01_chip_enable(power->device);
+  power->state = nrf24l01_power_state_tx;
+  power->stats.transmissions++;
+}
+
+uint8_t nrf24l01_power_init(nrf24l01_power * power, nrf24l01_device * device, uint32_t idle_timeout){
+  uint8_t config_register = 0;
+  if (power == NULL || device == NULL) return -1;
+  memset(power, 0, sizeof(nrf24l01_power));
+  power->device = device;
+  power->idle_timeout = idle_timeout;
+  power->last_activity = nrf24l01_port_millis(device);
+
+  nrf24l01_read_register(device, CONFIG, &config_register, 1);
+  if (!(config_register & PWR_UP))
+    power->state = nrf24l01_power_state_power_down;
+  else if (!nrf24l01_port_ce_read(device))
+    power->state = nrf24l01_power_state_standby_1;
+  else if (config_register & PRIM_RX){
+    power->state = nrf24l01_power_state_rx;
+    power->listen_requested = 1;
+  }
+  else {
+    // the next service call finds out whether the TX FIFO still holds anything
+    power->state = nrf24l01_power_state_tx;
+    power->tx_pending = 1;
+  }
+  return 0;
+}
+
+uint8_t nrf24l01_power_wake(nrf24l01_power * power){
+  if (power == NULL) return -1;
+  if (power->state != nrf24l01_power_state_power_down) return 0;
+
+  nrf24l01_chip_disable(power->device);
+  nrf24l01_power_pwr_up(power->device, 1);
+  power->wake_started = nrf24l01_port_micros(power->device);
+  power->wake_started_ms = nrf24l01_port_millis(power->device);
+  power->state = nrf24l01_power_state_waking;
+  return 0;
+}
+
+uint8_t nrf24l01_power_sleep(nrf24l01_power * power){
+  if (power == NULL) return -1;
+  power->listen_requested = 0;
+  if (power->state == nrf24l01_power_state_power_down) return 0;
+
+  nrf24l01_chip_disable(power->device);
+  nrf24l01_power_pwr_up(power->device, 0);
+  power->state = nrf24l01_power_state_power_down;
+  power->stats.power_downs++;
+  return 0;
+}
+
+uint8_t nrf24l01_power_send(nrf24l01_power * power, uint8_t * data, uint8_t length){
+  if (power == NULL || data == NULL) return -1;
+  if (length < 1 || length > 32) return -1; // invalid payload length
+  nrf24l01_device * device = power->device;
+  if (device->primary_rx) return -1; // invalid mode
+
+  // STATUS of the write is from before it, a payload written into a full FIFO is lost
+  if (nrf24l01_nop(device) & TX_FULL) return -1; // TX FIFO full
+  nrf24l01_write_tx_payload(device, data, length);
+  power->tx_pending = 1;
+
+  switch (power->state) {
+    case nrf24l01_power_state_power_down:
+      nrf24l01_power_wake(power);
+      power->stats.deferred_sends++;
+      break;
+    case nrf24l01_power_state_waking:
+      power->stats.deferred_sends++;
+      break;
+    case nrf24l01_power_state_standby_1:
+      nrf24l01_power_start_tx(power);
+      break;
+    case nrf24l01_power_state_standby_2:
+      // CE is still high, the payload goes out on its own
+      power->state = nrf24l01_power_state_tx;
+      power->stats.transmissions++;
+      break;
+    default:
+      break;
+  }
+  return 0;
+}
+
+uint8_t nrf24l01_power_listen(nrf24l01_power * power){
+  if (power == NULL) return -1;
+  if (!power->device->primary_rx) return -1; // invalid mode
+  power->listen_requested = 1;
+
+  if (power->state == nrf24l01_power_state_power_down)
+    nrf24l01_power_wake(power);
+  else if (power->state == nrf24l01_power_state_standby_1){
+    nrf24l01_chip_enable(power->device);
+    power->state = nrf24l01_power_state_rx;
+  }
+  return 0;
+}
+
+uint8_t nrf24l01_power_stop_listening(nrf24l01_power * power){
+  if (power == NULL) return -1;
+  power->listen_requested = 0;
+  if (power->state != nrf24l01_power_state_rx) return 0;
+
+  nrf24l01_chip_disable(power->device);
+  power->state = nrf24l01_power_state_standby_1;
+  power->last_activity = nrf24l01_port_millis(power->device);
+  return 0;
+}
+
+nrf24l01_power_state nrf24l01_power_service(nrf24l01_power * power){
+  if (power == NULL) return nrf24l01_power_state_count;
+  nrf24l01_device * device = power->device;
+  uint8_t status_register = 0, fifo_status_register = 0;
+
+  switch (power->state) {
+    case nrf24l01_power_state_waking: {
+      uint16_t elapsed = nrf24l01_port_micros(device) - power->wake_started;
+      // the ms tick takes over once the 16-bit µs counter may have wrapped
+      uint32_t elapsed_ms = nrf24l01_port_millis(device) - power->wake_started_ms;
+      if (elapsed < NRF24L01_POWER_TPD2STBY && elapsed_ms <= NRF24L01_POWER_TPD2STBY / 1000 + 1) break;
+      power->state = nrf24l01_power_state_standby_1;
+      power->stats.wakeups++;
+      power->last_activity = nrf24l01_port_millis(device);
+    }
+      // fall through
+    case nrf24l01_power_state_standby_1:
+      if (power->tx_pending)
+        nrf24l01_power_start_tx(power);
+      else if (power->listen_requested){
+        nrf24l01_chip_enable(device);
+        power->state = nrf24l01_power_state_rx;
+      }
+      else if (power->idle_timeout && nrf24l01_port_millis(device) - power->last_activity >= power->idle_timeout)
+        nrf24l01_power_sleep(power);
+      break;
+
+    case nrf24l01_power_state_tx:
+    case nrf24l01_power_state_standby_2:
+      status_register = nrf24l01_nop(device);
+      nrf24l01_read_register(device, FIFO_STATUS, &fifo_status_register, 1);
+      if (status_register & MAX_RT || (fifo_status_register & TX_EMPTY && power->state == nrf24l01_power_state_standby_2)){
+        // a MAX_RT payload waits in the FIFO for the application
+        nrf24l01_chip_disable(device);
+        power->state = nrf24l01_power_state_standby_1;
+        power->tx_pending = 0;
+        power->last_activity = nrf24l01_port_millis(device);
+      }
+      else if (fifo_status_register & TX_EMPTY){
+        // CE stays high one more call, a send until then goes out without a CE edge
+        power->state = nrf24l01_power_state_standby_2;
+        power->tx_pending = 0;
+        power->last_activity = nrf24l01_port_millis(device);
+      }
+      break;
+
+    case nrf24l01_power_state_rx:
+      if (!power->listen_requested) nrf24l01_power_stop_listening(power);
+      break;
+
+    default:
+      break;
+  }
+  return power->state;
+}
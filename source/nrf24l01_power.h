@@ -0,0 +1,161 @@
+/**
+ * @file nrf24l01_power.h
+ * @brief Power state machine: automatic power down when idle, asynchronous wake up
+ *
+ * Follows the radio through Power Down, Standby-I, Standby-II, RX and TX
+ * and makes the transitions itself. After idle_timeout ms in Standby-I
+ * with nothing to send the radio is powered down. Waking up sets PWR_UP
+ * and returns at once; nrf24l01_power_service() lets the crystal start
+ * for NRF24L01_POWER_TPD2STBY µs on the port timer (nrf24l01_port_micros)
+ * instead of the 2 ms delay of nrf24l01_power_up(), so the caller keeps
+ * running in the meantime.
+ *
+ * The TX FIFO is the queue for sends made while the radio is down or
+ * still waking: SPI works in Power Down, so nrf24l01_power_send() writes
+ * the payload immediately and the transmission starts as soon as the
+ * radio reaches Standby-I. A send refused with TX_FULL can be retried
+ * after the next service call.
+ *
+ * The manager owns CE and PWR_UP of its device. It does not clear
+ * interrupt flags; a MAX_RT transmission stops with CE dropped and the
+ * payload left in the TX FIFO until the application flushes it, or
+ * clears MAX_RT and it goes out with the next send. A device is used either as PTX
+ * (nrf24l01_power_send) or as PRX (nrf24l01_power_listen).
+ *
+ * Once the TX FIFO runs empty the radio is left in Standby-II, CE high,
+ * until the following service call: a send in between starts without a
+ * CE edge. That call drops CE to Standby-I, where the idle time counts.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_power power;
+ * nrf24l01_power_init(&power, &nrf, 50);   // power down after 50 ms idle
+ *
+ * nrf24l01_power_send(&power, sample, sizeof(sample));   // wakes the radio if needed
+ * for (;;){
+ *   nrf24l01_power_service(&power);
+ *   ...
+ * }
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_POWER_H
+#define NRF24L01_DRIVER_NRF24L01_POWER_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_POWER Power Management
+ * @brief Chip state tracking, idle power down and timer-driven wake up
+ * @{
+ */
+
+#ifndef NRF24L01_POWER_TPD2STBY
+/** @brief Power Down to Standby-I start up time in µs (Tpd2stby, crystal oscillator) */
+#define NRF24L01_POWER_TPD2STBY   1500
+#endif
+
+/**
+ * @brief Chip states
+ */
+typedef enum {
+    nrf24l01_power_state_power_down = 0,   /**< PWR_UP clear, registers kept */
+    nrf24l01_power_state_waking,           /**< PWR_UP set, crystal starting */
+    nrf24l01_power_state_standby_1,        /**< Powered, CE low */
+    nrf24l01_power_state_standby_2,        /**< PTX, CE high, TX FIFO empty */
+    nrf24l01_power_state_rx,               /**< PRX, CE high */
+    nrf24l01_power_state_tx,               /**< PTX, CE high, sending the TX FIFO */
+    nrf24l01_power_state_count             /**< Number of states */
+} nrf24l01_power_state;
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    uint32_t wakeups;                      /**< Power Down to Standby-I transitions */
+    uint32_t power_downs;                  /**< Automatic and requested power downs */
+    uint32_t deferred_sends;               /**< Sends made while the radio was down or waking */
+    uint32_t transmissions;                /**< TX FIFO bursts started */
+} nrf24l01_power_stats;
+
+/**
+ * @brief Power manager of one device
+ */
+typedef struct {
+    nrf24l01_device * device;              /**< Managed radio */
+    nrf24l01_power_state state;            /**< Current state */
+    uint32_t idle_timeout;                 /**< Standby-I time in ms before powering down, 0 never */
+    uint32_t last_activity;                /**< Time the radio last sent or stopped listening, ms */
+    uint32_t wake_started_ms;              /**< PWR_UP time, ms; covers waits longer than the µs counter */
+    uint16_t wake_started;                 /**< PWR_UP time, µs */
+    uint8_t tx_pending : 1;                /**< Payloads waiting in the TX FIFO */
+    uint8_t listen_requested : 1;          /**< Go to RX once powered */
+    nrf24l01_power_stats stats;            /**< Counters */
+} nrf24l01_power;
+
+/**
+ * @brief Take over the power state of a device
+ * @param power Pointer to power manager
+ * @param device Pointer to an initialized device
+ * @param idle_timeout Standby-I time in ms before powering down, 0 to stay up
+ * @return 0 on success, non-zero on error
+ *
+ * The starting state is read from CONFIG and CE; a device that was just
+ * powered up by nrf24l01_init() counts as being in Standby-I.
+ */
+uint8_t nrf24l01_power_init(nrf24l01_power * power, nrf24l01_device * device, uint32_t idle_timeout);
+
+/**
+ * @brief Start powering up, without waiting
+ * @param power Pointer to power manager
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_power_wake(nrf24l01_power * power);
+
+/**
+ * @brief Power down now, whatever the idle time
+ * @param power Pointer to power manager
+ * @return 0 on success, non-zero on error
+ *
+ * Stops listening. Payloads still in the TX FIFO are kept and sent on
+ * the next wake up.
+ */
+uint8_t nrf24l01_power_sleep(nrf24l01_power * power);
+
+/**
+ * @brief Queue a payload and have it sent as soon as the radio is ready
+ * @param power Pointer to power manager
+ * @param data Pointer to payload data
+ * @param length Payload length (1-32)
+ * @return 0 on success, non-zero when the TX FIFO is full or on error
+ */
+uint8_t nrf24l01_power_send(nrf24l01_power * power, uint8_t * data, uint8_t length);
+
+/**
+ * @brief Listen, waking the radio if needed
+ * @param power Pointer to power manager
+ * @return 0 on success, non-zero on error
+ *
+ * The radio is not powered down while listening.
+ */
+uint8_t nrf24l01_power_listen(nrf24l01_power * power);
+
+/**
+ * @brief Stop listening; the idle time starts
+ * @param power Pointer to power manager
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_power_stop_listening(nrf24l01_power * power);
+
+/**
+ * @brief Advance the state machine
+ * @param power Pointer to power manager
+ * @return Current state
+ *
+ * Call from the main loop; never waits.
+ */
+nrf24l01_power_state nrf24l01_power_service(nrf24l01_power * power);
+
+/** @} */ // End of NRF24L01_POWER group
+
+#endif //NRF24L01_DRIVER_NRF24L01_POWER_H
@@ -0,0 +1,96 @@
+#include <stddef.h>
+#include "nrf24l01_profile.h"
+
+/* write order: SETUP_AW before the addresses, CONFIG last; length 0 means full address width */
+static const struct {
+  uint8_t reg;
+  uint8_t offset;
+  uint8_t length;
+} nrf24l01_profile_registers[] = {
+  {SETUP_AW,   offsetof(nrf24l01_register_image, setup_aw),   1},
+  {EN_AA,      offsetof(nrf24l01_register_image, en_aa),      1},
+  {EN_RXADDR,  offsetof(nrf24l01_register_image, en_rxaddr),  1},
+  {SETUP_RETR, offsetof(nrf24l01_register_image, setup_retr), 1},
+  {RF_CH,      offsetof(nrf24l01_register_image, rf_ch),      1},
+  {RF_SETUP,   offsetof(nrf24l01_register_image, rf_setup),   1},
+  {RX_ADDR_P0, offsetof(nrf24l01_register_image, rx_addr_p0), 0},
+  {RX_ADDR_P1, offsetof(nrf24l01_register_image, rx_addr_p1), 0},
+  {RX_ADDR_P2, offsetof(nrf24l01_register_image, rx_addr_p2_p5) + 0, 1},
+  {RX_ADDR_P3, offsetof(nrf24l01_register_image, rx_addr_p2_p5) + 1, 1},
+  {RX_ADDR_P4, offsetof(nrf24l01_register_image, rx_addr_p2_p5) + 2, 1},
+  {RX_ADDR_P5, offsetof(nrf24l01_register_image, rx_addr_p2_p5) + 3, 1},
+  {TX_ADDR,    offsetof(nrf24l01_register_image, tx_addr),    0},
+  {RX_PW_P0,   offsetof(nrf24l01_register_image, rx_pw) + 0,  1},
+  {RX_PW_P1,   offsetof(nrf24l01_register_image, rx_pw) + 1,  1},
+  {RX_PW_P2,   offsetof(nrf24l01_register_image, rx_pw) + 2,  1},
+  {RX_PW_P3,   offsetof(nrf24l01_register_image, rx_pw) + 3,  1},
+  {RX_PW_P4,   offsetof(nrf24l01_register_image, rx_pw) + 4,  1},
+  {RX_PW_P5,   offsetof(nrf24l01_register_image, rx_pw) + 5,  1},
+  {FEATURE,    offsetof(nrf24l01_register_image, feature),    1},
+  {DYNPD,      offsetof(nrf24l01_register_image, dynpd),      1},
+  {CONFIG,     offsetof(nrf24l01_register_image, config),     1},
+};
+
+// with a device the differing registers of "to" are written, without they are only counted
+static uint8_t nrf24l01_profile_apply_diff(nrf24l01_device * device, const nrf24l01_register_image * from,
+                                           const nrf24l01_register_image * to){
+  uint8_t writes = 0;
+  uint8_t address_width = NRF24L01_FIELD_GET(AW, to->setup_aw) + 2;
+  // a different width changes the meaning of every multi-byte address
+  uint8_t width_changed = from->setup_aw != to->setup_aw;
+
+  for (uint8_t i = 0; i < sizeof(nrf24l01_profile_registers) / sizeof(nrf24l01_profile_registers[0]); i++){
+    const uint8_t * old_value = (const uint8_t *)from + nrf24l01_profile_registers[i].offset;
+    const uint8_t * new_value = (const uint8_t *)to + nrf24l01_profile_registers[i].offset;
+    uint8_t length = nrf24l01_profile_registers[i].length;
+
+    if (length == 0){
+      // full-width address
+      length = address_width;
+      if (!width_changed && memcmp(old_value, new_value, length) == 0) continue;
+    }
+    else if (*old_value == *new_value) continue;
+
+    if (device != NULL){
+      // the register API takes a mutable buffer, the profile stays untouched
+      uint8_t value[5];
+      memcpy(value, new_value, length);
+      nrf24l01_write_register(device, nrf24l01_profile_registers[i].reg, value, length);
+    }
+    writes++;
+  }
+
+  return writes;
+}
+
+uint8_t nrf24l01_profile_from_device(nrf24l01_profile * profile, const char * name, nrf24l01_device * device){
+  if (profile == NULL || device == NULL) return -1;
+  profile->name = name;
+  return nrf24l01_build_register_image(device, &profile->image);
+}
+
+uint8_t nrf24l01_profile_diff(const nrf24l01_profile * from, const nrf24l01_profile * to){
+  if (from == NULL || to == NULL) return 0;
+  return nrf24l01_profile_apply_diff(NULL, &from->image, &to->image);
+}
+
+uint8_t nrf24l01_profile_switch(nrf24l01_device * device, const nrf24l01_profile * from, const nrf24l01_profile * to,
+                                uint16_t * elapsed){
+  if (device == NULL || from == NULL || to == NULL) return -1;
+  uint16_t start = nrf24l01_port_micros(device);
+
+  uint8_t chip_enabled = nrf24l01_port_ce_read(device);
+  if (chip_enabled) nrf24l01_chip_disable(device);
+
+  nrf24l01_profile_apply_diff(device, &from->image, &to->image);
+
+  // later read-modify-write helpers start from the cache, it must follow the chip
+  nrf24l01_load_register_image(device, &to->image);
+
+  if (chip_enabled) nrf24l01_chip_enable(device);
+
+  if (elapsed != NULL)
+    *elapsed = (uint16_t)(nrf24l01_port_micros(device) - start);
+
+  return 0;
+}
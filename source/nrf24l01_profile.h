@@ -0,0 +1,84 @@
+/**
+ * @file nrf24l01_profile.h
+ * @brief Named configuration profiles with minimal-diff switching
+ *
+ * A profile is a named register image, built once from a device structure.
+ * Switching from one profile to another compares the two images and writes
+ * only the registers that differ, inside a single CE-low window. Compared to
+ * changing the device structure and calling nrf24l01_init() again, there is
+ * no delay and no register read, and a switch that only changes the
+ * channel and output power costs two SPI transactions.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_profile bulk, low_latency;
+ *
+ * nrf.auto_retransmit_delay = nrf24l01_auto_retransmit_delay_1000us;
+ * nrf.auto_retransmit_count = nrf24l01_auto_retransmit_count_15;
+ * nrf24l01_profile_from_device(&bulk, "bulk", &nrf);
+ *
+ * nrf.auto_retransmit_delay = nrf24l01_auto_retransmit_delay_250us;
+ * nrf.auto_retransmit_count = nrf24l01_auto_retransmit_count_2;
+ * nrf24l01_profile_from_device(&low_latency, "low-latency", &nrf);
+ *
+ * uint16_t elapsed;
+ * nrf24l01_profile_switch(&nrf, &bulk, &low_latency, &elapsed);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_PROFILE_H
+#define NRF24L01_DRIVER_NRF24L01_PROFILE_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_PROFILE Configuration Profiles
+ * @brief Named register images and differential reconfiguration
+ * @{
+ */
+
+/**
+ * @brief Named configuration
+ */
+typedef struct {
+    const char * name;                 /**< Profile name, not copied */
+    nrf24l01_register_image image;     /**< Register values of the profile */
+} nrf24l01_profile;
+
+/**
+ * @brief Build a profile from a device configuration
+ * @param profile Pointer to profile to fill
+ * @param name Profile name, must outlive the profile
+ * @param device Pointer to device configuration structure
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_profile_from_device(nrf24l01_profile * profile, const char * name, nrf24l01_device * device);
+
+/**
+ * @brief Count the registers that differ between two profiles
+ * @param from Pointer to current profile
+ * @param to Pointer to next profile
+ * @return Number of register writes nrf24l01_profile_switch() will issue
+ */
+uint8_t nrf24l01_profile_diff(const nrf24l01_profile * from, const nrf24l01_profile * to);
+
+/**
+ * @brief Switch the chip from one profile to another
+ * @param device Pointer to device configuration structure
+ * @param from Profile currently loaded in the chip
+ * @param to Profile to load
+ * @param elapsed Set to the switch duration in µs (port microsecond counter), may be NULL
+ * @return 0 on success, non-zero on error
+ *
+ * Writes only the differing registers, with CE low, and restores CE
+ * afterwards. The cached configuration of the device structure follows
+ * the new profile (nrf24l01_load_register_image()).
+ *
+ * @note When the new profile sets PWR_UP, wait 1.5 ms before using the radio
+ */
+uint8_t nrf24l01_profile_switch(nrf24l01_device * device, const nrf24l01_profile * from, const nrf24l01_profile * to,
+                                uint16_t * elapsed);
+
+/** @} */ // End of NRF24L01_PROFILE group
+
+#endif //NRF24L01_DRIVER_NRF24L01_PROFILE_H
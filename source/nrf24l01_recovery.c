@@ -0,0 +1,161 @@
+#include "nrf24l01_recovery.h"
+
+static uint32_t nrf24l01_recovery_random(nrf24l01_recovery * recovery){
+  // xorshift32
+  uint32_t x = recovery->random_state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  recovery->random_state = x;
+  return x;
+}
+
+static void nrf24l01_recovery_set_channel(nrf24l01_recovery * recovery, uint8_t channel){
+  nrf24l01_write_register(recovery->device, RF_CH, &channel, 1);
+  recovery->device->frequency_channel = channel;
+  recovery->counters[recovery->rule[recovery->packet_class].policy].channel_switches++;
+}
+
+// head packet is finished, successfully or not
+static void nrf24l01_recovery_finish(nrf24l01_recovery * recovery){
+  if (recovery->on_alternate){
+    nrf24l01_recovery_set_channel(recovery, recovery->home_channel);
+    recovery->on_alternate = 0;
+  }
+  recovery->attempt = 0;
+  recovery->retry_pending = 0;
+}
+
+// payloads in the halted TX FIFO: FIFO_STATUS only tells empty and full
+// apart, so it is padded up to full with one-byte payloads written past
+// nrf24l01_write_tx_payload() (no observer event). CE is low since MAX_RT
+// was cleared, nothing is sent before the flush.
+static uint8_t nrf24l01_recovery_tx_count(nrf24l01_recovery * recovery){
+  uint8_t padding[2] = {W_TX_PAYLOAD, 0}, status[2];
+  uint8_t count = 3;
+  while (count > 0 && !(nrf24l01_nop(recovery->device) & TX_FULL)){
+    nrf24l01_chip_select(recovery->device);
+    nrf24l01_port_spi_transfer(recovery->device, padding, status, sizeof(padding));
+    nrf24l01_chip_deselect(recovery->device);
+    count--;
+  }
+  return count;
+}
+
+// FLUSH_TX cannot take the head alone, the payloads queued behind it go too
+static void nrf24l01_recovery_give_up(nrf24l01_recovery * recovery, uint8_t policy){
+  recovery->counters[policy].dropped += nrf24l01_recovery_tx_count(recovery);
+  nrf24l01_flush_tx(recovery->device);
+  nrf24l01_recovery_finish(recovery);
+}
+
+static void nrf24l01_recovery_retry(nrf24l01_recovery * recovery, uint8_t policy){
+  recovery->counters[policy].retries++;
+  recovery->retry_pending = 0;
+  nrf24l01_transmit(recovery->device);
+}
+
+uint8_t nrf24l01_recovery_init(nrf24l01_recovery * recovery, nrf24l01_device * device, uint32_t seed){
+  if (recovery == NULL || device == NULL) return -1;
+  memset(recovery, 0, sizeof(nrf24l01_recovery));
+  recovery->device = device;
+  recovery->random_state = seed ? seed : 0x2545F491; // xorshift must not start at 0
+  recovery->home_channel = device->frequency_channel;
+  return 0;
+}
+
+uint8_t nrf24l01_recovery_set_rule(nrf24l01_recovery * recovery, uint8_t packet_class, const nrf24l01_recovery_rule * rule){
+  if (recovery == NULL || rule == NULL) return -1;
+  if (packet_class >= NRF24L01_RECOVERY_CLASSES) return -1; // invalid class
+  if (rule->policy >= nrf24l01_recovery_policy_count) return -1; // invalid policy
+  if (rule->alternate_channel > 125) return -1; // invalid channel
+
+  recovery->rule[packet_class] = *rule;
+  return 0;
+}
+
+uint8_t nrf24l01_recovery_set_handler(nrf24l01_recovery * recovery, nrf24l01_recovery_handler handler, void * context){
+  if (recovery == NULL) return -1;
+  recovery->handler = handler;
+  recovery->context = context;
+  return 0;
+}
+
+uint8_t nrf24l01_recovery_handle_max_rt(nrf24l01_recovery * recovery, uint8_t packet_class){
+  uint8_t status_register = 0;
+  if (recovery == NULL) return -1;
+  if (packet_class >= NRF24L01_RECOVERY_CLASSES) packet_class = 0;
+
+  status_register = nrf24l01_clear_interrupt_flags(recovery->device, MAX_RT);
+
+  nrf24l01_recovery_rule * rule = &recovery->rule[packet_class];
+  recovery->packet_class = packet_class;
+  recovery->counters[rule->policy].max_rt++;
+
+  switch (rule->policy) {
+    case nrf24l01_recovery_backoff:
+      if (recovery->attempt >= rule->max_attempts){
+        nrf24l01_recovery_give_up(recovery, rule->policy);
+        break;
+      }
+      {
+        // random delay in [0, base * 2^attempt) ms; the window stops growing
+        // at 2^16 times the 16-bit base, so the shift stays within 32 bits
+        uint32_t window = (uint32_t)rule->backoff_base << (recovery->attempt < 16 ? recovery->attempt : 16);
+        recovery->attempt++;
+        recovery->retry_tick = nrf24l01_port_millis(recovery->device) + (window ? nrf24l01_recovery_random(recovery) % window : 0);
+        recovery->retry_pending = 1;
+      }
+      break;
+    case nrf24l01_recovery_alternate_channel:
+      if (recovery->attempt >= rule->max_attempts){
+        nrf24l01_recovery_give_up(recovery, rule->policy);
+        break;
+      }
+      recovery->attempt++;
+      // alternate between the home and the alternate channel on every attempt
+      if (recovery->on_alternate){
+        nrf24l01_recovery_set_channel(recovery, recovery->home_channel);
+        recovery->on_alternate = 0;
+      }
+      else {
+        recovery->home_channel = recovery->device->frequency_channel;
+        nrf24l01_recovery_set_channel(recovery, rule->alternate_channel);
+        recovery->on_alternate = 1;
+      }
+      nrf24l01_recovery_retry(recovery, rule->policy);
+      break;
+    case nrf24l01_recovery_callback:
+      if (recovery->handler != NULL &&
+          recovery->handler(recovery->device, packet_class, recovery->attempt, recovery->context) == nrf24l01_recovery_action_retry){
+        recovery->attempt++;
+        nrf24l01_recovery_retry(recovery, rule->policy);
+      }
+      else
+        nrf24l01_recovery_give_up(recovery, rule->policy);
+      break;
+    case nrf24l01_recovery_drop:
+    default:
+      nrf24l01_recovery_give_up(recovery, nrf24l01_recovery_drop);
+  }
+
+  return status_register;
+}
+
+uint8_t nrf24l01_recovery_tx_done(nrf24l01_recovery * recovery){
+  if (recovery == NULL) return -1;
+
+  if (recovery->attempt > 0)
+    recovery->counters[recovery->rule[recovery->packet_class].policy].recovered++;
+  nrf24l01_recovery_finish(recovery);
+
+  return 0;
+}
+
+uint8_t nrf24l01_recovery_service(nrf24l01_recovery * recovery){
+  if (recovery == NULL || !recovery->retry_pending) return 0;
+  if ((int32_t)(nrf24l01_port_millis(recovery->device) - recovery->retry_tick) < 0) return 0; // backoff not over
+
+  nrf24l01_recovery_retry(recovery, recovery->rule[recovery->packet_class].policy);
+  return 1;
+}
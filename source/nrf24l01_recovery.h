@@ -0,0 +1,175 @@
+/**
+ * @file nrf24l01_recovery.h
+ * @brief Automatic MAX_RT recovery policies for the nRF24L01 driver
+ *
+ * After MAX_RT the failed packet stays at the head of the TX FIFO and blocks
+ * every packet behind it until the application reacts. This module reacts
+ * automatically, with a policy chosen per packet class:
+ *
+ * - drop: flush the TX FIFO and continue with the packets written next;
+ *   FLUSH_TX cannot remove the failed packet alone, so up to two packets
+ *   queued behind it are discarded with it and counted as dropped
+ * - backoff: retry after a randomized, exponentially growing delay
+ * - alternate channel: retry on a second RF channel
+ * - callback: let the application decide
+ *
+ * Every policy keeps its own counters.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_recovery recovery;
+ * nrf24l01_recovery_rule telemetry = {nrf24l01_recovery_backoff, 4, 5, 0};
+ * nrf24l01_recovery_init(&recovery, &nrf, nrf24l01_port_millis(&nrf));
+ * nrf24l01_recovery_set_rule(&recovery, 1, &telemetry);
+ *
+ * uint8_t status = nrf24l01_nop(&nrf);
+ * if (status & MAX_RT)
+ *     nrf24l01_recovery_handle_max_rt(&recovery, 1);
+ * if (status & TX_DS)
+ *     nrf24l01_recovery_tx_done(&recovery);
+ * nrf24l01_recovery_service(&recovery);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_RECOVERY_H
+#define NRF24L01_DRIVER_NRF24L01_RECOVERY_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_RECOVERY MAX_RT Recovery
+ * @brief Per-class reaction to exhausted auto retransmits
+ * @{
+ */
+
+#ifndef NRF24L01_RECOVERY_CLASSES
+/** @brief Number of packet classes with their own recovery rule */
+#define NRF24L01_RECOVERY_CLASSES   4
+#endif
+
+/**
+ * @brief Recovery policies
+ */
+typedef enum {
+    nrf24l01_recovery_drop = 0,            /**< Flush the TX FIFO, failed packet included, and continue */
+    nrf24l01_recovery_backoff,             /**< Retry after a randomized backoff */
+    nrf24l01_recovery_alternate_channel,   /**< Retry on the alternate RF channel */
+    nrf24l01_recovery_callback,            /**< Ask the application */
+    nrf24l01_recovery_policy_count         /**< Number of policies */
+} nrf24l01_recovery_policy;
+
+/**
+ * @brief Decision returned by the escalation callback
+ */
+typedef enum {
+    nrf24l01_recovery_action_drop = 0,     /**< Flush the TX FIFO, failed packet included */
+    nrf24l01_recovery_action_retry,        /**< Retransmit it right away */
+} nrf24l01_recovery_action;
+
+/**
+ * @brief Escalation callback
+ * @param device Device that reported MAX_RT
+ * @param packet_class Class of the failed packet
+ * @param attempt Number of recovery attempts already made for this packet
+ * @param context User context
+ * @return Action to take
+ */
+typedef nrf24l01_recovery_action (*nrf24l01_recovery_handler)(nrf24l01_device * device, uint8_t packet_class,
+                                                              uint8_t attempt, void * context);
+
+/**
+ * @brief Recovery rule for one packet class
+ */
+typedef struct {
+    uint8_t policy;                /**< One of nrf24l01_recovery_policy */
+    uint8_t max_attempts;          /**< Recovery attempts before the packet is dropped */
+    uint16_t backoff_base;         /**< Backoff window in ms for the first retry, doubled each attempt up to 2^16 times */
+    uint8_t alternate_channel;     /**< RF channel (0-125) used by the alternate channel policy */
+} nrf24l01_recovery_rule;
+
+/**
+ * @brief Counters kept for each policy
+ */
+typedef struct {
+    uint32_t max_rt;               /**< MAX_RT events handled */
+    uint32_t retries;              /**< Retransmissions started */
+    uint32_t recovered;            /**< Packets delivered after at least one recovery attempt */
+    uint32_t dropped;              /**< Packets flushed from the TX FIFO, the failed one and those behind it */
+    uint32_t channel_switches;     /**< RF channel changes */
+} nrf24l01_recovery_counters;
+
+/**
+ * @brief Recovery instance, one per device
+ */
+typedef struct {
+    nrf24l01_device * device;                                  /**< Supervised radio */
+    nrf24l01_recovery_rule rule[NRF24L01_RECOVERY_CLASSES];    /**< Rule per packet class */
+    nrf24l01_recovery_counters counters[nrf24l01_recovery_policy_count]; /**< Counters per policy */
+    nrf24l01_recovery_handler handler;                         /**< Escalation callback */
+    void * context;                                            /**< Escalation callback context */
+    uint32_t random_state;                                     /**< Backoff PRNG state */
+    uint32_t retry_tick;                                       /**< Port tick (ms) of the pending retry */
+    uint8_t retry_pending;                                     /**< A retry is scheduled */
+    uint8_t packet_class;                                      /**< Class of the packet under recovery */
+    uint8_t attempt;                                           /**< Recovery attempts for the head packet */
+    uint8_t home_channel;                                      /**< Channel to return to after an alternate retry */
+    uint8_t on_alternate;                                      /**< Radio currently tuned to the alternate channel */
+} nrf24l01_recovery;
+
+/**
+ * @brief Initialize recovery with the drop policy for every class
+ * @param recovery Pointer to recovery instance
+ * @param device Pointer to an initialized PTX device
+ * @param seed Seed for the backoff randomization, must differ between nodes
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_recovery_init(nrf24l01_recovery * recovery, nrf24l01_device * device, uint32_t seed);
+
+/**
+ * @brief Set the rule of a packet class
+ * @param recovery Pointer to recovery instance
+ * @param packet_class Packet class (0 to NRF24L01_RECOVERY_CLASSES - 1)
+ * @param rule Pointer to rule, copied
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_recovery_set_rule(nrf24l01_recovery * recovery, uint8_t packet_class, const nrf24l01_recovery_rule * rule);
+
+/**
+ * @brief Set the escalation callback
+ * @param recovery Pointer to recovery instance
+ * @param handler Callback used by the callback policy
+ * @param context User context passed to the callback
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_recovery_set_handler(nrf24l01_recovery * recovery, nrf24l01_recovery_handler handler, void * context);
+
+/**
+ * @brief React to a MAX_RT event
+ * @param recovery Pointer to recovery instance
+ * @param packet_class Class of the packet at the head of the TX FIFO
+ * @return Status register value
+ *
+ * Clears MAX_RT and applies the rule of the class. Immediate retries are
+ * started from here, delayed ones from nrf24l01_recovery_service().
+ */
+uint8_t nrf24l01_recovery_handle_max_rt(nrf24l01_recovery * recovery, uint8_t packet_class);
+
+/**
+ * @brief Report a TX_DS event
+ * @param recovery Pointer to recovery instance
+ * @return 0 on success, non-zero on error
+ *
+ * Updates the recovered counter and returns to the home channel.
+ */
+uint8_t nrf24l01_recovery_tx_done(nrf24l01_recovery * recovery);
+
+/**
+ * @brief Start a scheduled retry once its backoff expired
+ * @param recovery Pointer to recovery instance
+ * @return 1 if a retransmission was started, 0 otherwise
+ */
+uint8_t nrf24l01_recovery_service(nrf24l01_recovery * recovery);
+
+/** @} */ // End of NRF24L01_RECOVERY group
+
+#endif //NRF24L01_DRIVER_NRF24L01_RECOVERY_H
@@ -0,0 +1,130 @@
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // sem_timedwait and clock_gettime under -std=c11
+#endif
+
+#include "nrf24l01_rtos.h"
+
+// called by the worker with the lock held
+static void nrf24l01_rtos_on_rx(uint8_t pipe, const uint8_t * data, uint8_t length, void * context){
+  nrf24l01_rtos * rtos = context;
+  if (rtos->rx_count == NRF24L01_RTOS_RX_QUEUE_DEPTH){
+    rtos->stats.rx_dropped++;
+    return;
+  }
+  nrf24l01_rtos_frame * frame = &rtos->rx_queue[(rtos->rx_head + rtos->rx_count) % NRF24L01_RTOS_RX_QUEUE_DEPTH];
+  memcpy(frame->data, data, length);
+  frame->length = length;
+  frame->pipe = pipe;
+  rtos->rx_count++;
+  rtos->stats.received++;
+  nrf24l01_rtos_semaphore_give(&rtos->rx_ready);
+}
+
+static void nrf24l01_rtos_on_tx_done(void * context){
+  nrf24l01_rtos * rtos = context;
+  rtos->tx_result = 0;
+  nrf24l01_rtos_semaphore_give(&rtos->tx_done);
+}
+
+static void nrf24l01_rtos_on_max_rt(void * context){
+  nrf24l01_rtos * rtos = context;
+  // drop the payload so the radio does not resend it when MAX_RT is cleared
+  nrf24l01_flush_tx(rtos->device);
+  rtos->tx_result = -1;
+  nrf24l01_rtos_semaphore_give(&rtos->tx_done);
+}
+
+uint8_t nrf24l01_rtos_init(nrf24l01_rtos * rtos, nrf24l01_device * device){
+  if (rtos == NULL || device == NULL) return -1;
+  memset(rtos, 0, sizeof(nrf24l01_rtos));
+  rtos->device = device;
+
+  if (nrf24l01_rtos_mutex_init(&rtos->lock)) return -1;
+  if (nrf24l01_rtos_mutex_init(&rtos->tx_lock)) return -1;
+  if (nrf24l01_rtos_semaphore_init(&rtos->irq)) return -1;
+  if (nrf24l01_rtos_semaphore_init(&rtos->tx_done)) return -1;
+  if (nrf24l01_rtos_semaphore_init(&rtos->rx_ready)) return -1;
+
+  nrf24l01_events_init(&rtos->events, device, rtos);
+  rtos->events.on_rx = nrf24l01_rtos_on_rx;
+  rtos->events.on_ack_payload = nrf24l01_rtos_on_rx;
+  rtos->events.on_tx_done = nrf24l01_rtos_on_tx_done;
+  rtos->events.on_max_rt = nrf24l01_rtos_on_max_rt;
+  return 0;
+}
+
+void nrf24l01_rtos_lock(nrf24l01_rtos * rtos){
+  if (rtos == NULL) return;
+  nrf24l01_rtos_mutex_lock(&rtos->lock);
+}
+
+void nrf24l01_rtos_unlock(nrf24l01_rtos * rtos){
+  if (rtos == NULL) return;
+  nrf24l01_rtos_mutex_unlock(&rtos->lock);
+}
+
+void nrf24l01_rtos_irq_from_isr(nrf24l01_rtos * rtos){
+  if (rtos == NULL) return;
+  rtos->stats.interrupts++;
+  nrf24l01_rtos_semaphore_give_from_isr(&rtos->irq);
+}
+
+uint8_t nrf24l01_rtos_worker(nrf24l01_rtos * rtos, uint32_t timeout_ms){
+  if (rtos == NULL) return -1;
+  nrf24l01_rtos_semaphore_take(&rtos->irq, timeout_ms);
+
+  nrf24l01_rtos_mutex_lock(&rtos->lock);
+  rtos->stats.wakeups++;
+  uint8_t status_register = nrf24l01_process(&rtos->events);
+  nrf24l01_rtos_mutex_unlock(&rtos->lock);
+  return status_register;
+}
+
+uint8_t nrf24l01_rtos_send(nrf24l01_rtos * rtos, const uint8_t * data, uint8_t length, uint32_t timeout_ms){
+  uint8_t payload[32], result = -1;
+  if (rtos == NULL || data == NULL) return -1;
+  if (length < 1 || length > 32) return -1; // invalid payload length
+  memcpy(payload, data, length);
+
+  nrf24l01_rtos_mutex_lock(&rtos->tx_lock);
+  // a result that came in after an earlier send timed out is stale
+  while (nrf24l01_rtos_semaphore_take(&rtos->tx_done, 0) == 0);
+
+  nrf24l01_rtos_mutex_lock(&rtos->lock);
+  nrf24l01_write_tx_payload(rtos->device, payload, length);
+  // CE stays high until the worker reports, no 130 µs busy pulse
+  nrf24l01_chip_enable(rtos->device);
+  nrf24l01_rtos_mutex_unlock(&rtos->lock);
+
+  if (nrf24l01_rtos_semaphore_take(&rtos->tx_done, timeout_ms) == 0) result = rtos->tx_result;
+
+  nrf24l01_rtos_mutex_lock(&rtos->lock);
+  nrf24l01_chip_disable(rtos->device);
+  if (result != 0){
+    nrf24l01_flush_tx(rtos->device);
+    rtos->stats.send_failed++;
+  }
+  else
+    rtos->stats.sent++;
+  nrf24l01_rtos_mutex_unlock(&rtos->lock);
+
+  nrf24l01_rtos_mutex_unlock(&rtos->tx_lock);
+  return result;
+}
+
+uint8_t nrf24l01_rtos_receive(nrf24l01_rtos * rtos, uint8_t * data, uint8_t * length, uint8_t * pipe,
+                              uint32_t timeout_ms){
+  if (rtos == NULL || data == NULL || length == NULL) return -1;
+  *length = 0;
+  if (nrf24l01_rtos_semaphore_take(&rtos->rx_ready, timeout_ms)) return -1; // timeout
+
+  nrf24l01_rtos_mutex_lock(&rtos->lock);
+  nrf24l01_rtos_frame * frame = &rtos->rx_queue[rtos->rx_head];
+  memcpy(data, frame->data, frame->length);
+  *length = frame->length;
+  if (pipe != NULL) *pipe = frame->pipe;
+  rtos->rx_head = (rtos->rx_head + 1) % NRF24L01_RTOS_RX_QUEUE_DEPTH;
+  rtos->rx_count--;
+  nrf24l01_rtos_mutex_unlock(&rtos->lock);
+  return 0;
+}
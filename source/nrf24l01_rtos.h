@@ -0,0 +1,186 @@
+/**
+ * @file nrf24l01_rtos.h
+ * @brief Thread-safe radio access for RTOS tasks, with ISR deferral
+ *
+ * Every SPI transaction of the device is made under one mutex, so tasks
+ * (and the worker below) never cut into each other's CSN frame. The IRQ
+ * handler is a top half that only gives a semaphore; a worker task, the
+ * bottom half, takes it, reads STATUS once through nrf24l01_process(),
+ * moves received payloads to a queue and wakes the sender. Senders and
+ * receivers block on semaphores with a timeout instead of spinning.
+ *
+ * The OS binding is chosen at compile time with NRF24L01_RTOS, like the
+ * port layer:
+ * | NRF24L01_RTOS                 | Header                      |
+ * |-------------------------------|-----------------------------|
+ * | NRF24L01_RTOS_FREERTOS        | nrf24l01_rtos_freertos.h    |
+ * | NRF24L01_RTOS_POSIX           | nrf24l01_rtos_posix.h       |
+ * | NRF24L01_RTOS_CUSTOM          | NRF24L01_RTOS_HEADER        |
+ * FreeRTOS is the default, POSIX with the host port. A binding provides
+ * nrf24l01_rtos_mutex and nrf24l01_rtos_semaphore with their _init, lock,
+ * unlock, give, give_from_isr and take(timeout_ms) operations.
+ *
+ * Other driver calls on the device go between nrf24l01_rtos_lock() and
+ * nrf24l01_rtos_unlock(). nrf24l01_init() still waits with the port delay.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_rtos radio;
+ * nrf24l01_rtos_init(&radio, &nrf);
+ *
+ * // EXTI callback of the IRQ pin
+ * nrf24l01_rtos_irq_from_isr(&radio);
+ *
+ * // worker task, highest priority of the radio users
+ * for (;;) nrf24l01_rtos_worker(&radio, 100);
+ *
+ * // any task
+ * if (nrf24l01_rtos_send(&radio, data, length, 20) != 0) { ... }       // not acknowledged
+ * if (nrf24l01_rtos_receive(&radio, buffer, &length, &pipe, 1000) == 0) { ... }
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_RTOS_H
+#define NRF24L01_DRIVER_NRF24L01_RTOS_H
+
+#include "nrf24l01_events.h"
+
+/**
+ * @defgroup NRF24L01_RTOS RTOS Layer
+ * @brief Mutex-protected device, deferred IRQ handling and blocking calls
+ * @{
+ */
+
+#define NRF24L01_RTOS_FREERTOS   1  /**< FreeRTOS, static allocation */
+#define NRF24L01_RTOS_POSIX      2  /**< POSIX threads and semaphores */
+#define NRF24L01_RTOS_CUSTOM     3  /**< Binding header named by NRF24L01_RTOS_HEADER */
+
+#ifndef NRF24L01_RTOS
+#if NRF24L01_PORT == NRF24L01_PORT_HOST
+#define NRF24L01_RTOS   NRF24L01_RTOS_POSIX
+#else
+#define NRF24L01_RTOS   NRF24L01_RTOS_FREERTOS
+#endif
+#endif
+
+/** @brief Timeout that never expires */
+#define NRF24L01_RTOS_FOREVER   0xFFFFFFFFUL
+
+#if NRF24L01_RTOS == NRF24L01_RTOS_FREERTOS
+#include "nrf24l01_rtos_freertos.h"
+#elif NRF24L01_RTOS == NRF24L01_RTOS_POSIX
+#include "nrf24l01_rtos_posix.h"
+#elif NRF24L01_RTOS == NRF24L01_RTOS_CUSTOM
+#include NRF24L01_RTOS_HEADER
+#else
+#error "unknown NRF24L01_RTOS"
+#endif
+
+#ifndef NRF24L01_RTOS_RX_QUEUE_DEPTH
+/** @brief Received payloads waiting for nrf24l01_rtos_receive() */
+#define NRF24L01_RTOS_RX_QUEUE_DEPTH   8
+#endif
+
+/**
+ * @brief One received payload
+ */
+typedef struct {
+    uint8_t data[32];                      /**< Payload */
+    uint8_t length;                        /**< Payload length */
+    uint8_t pipe;                          /**< Receiving pipe */
+} nrf24l01_rtos_frame;
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    uint32_t interrupts;                   /**< Top halves run */
+    uint32_t wakeups;                      /**< Worker passes */
+    uint32_t received;                     /**< Payloads queued */
+    uint32_t rx_dropped;                   /**< Payloads lost because the queue was full */
+    uint32_t sent;                         /**< Sends acknowledged */
+    uint32_t send_failed;                  /**< Sends ended by MAX_RT or timeout */
+} nrf24l01_rtos_stats;
+
+/**
+ * @brief RTOS wrapper of one device
+ */
+typedef struct {
+    nrf24l01_device * device;                                 /**< Wrapped radio */
+    nrf24l01_events events;                                   /**< Dispatcher run by the worker */
+    nrf24l01_rtos_mutex lock;                                 /**< Guards every SPI transaction */
+    nrf24l01_rtos_mutex tx_lock;                              /**< One sender at a time */
+    nrf24l01_rtos_semaphore irq;                              /**< Top half to worker */
+    nrf24l01_rtos_semaphore tx_done;                          /**< Worker to sender */
+    nrf24l01_rtos_semaphore rx_ready;                         /**< Worker to receivers, one count per payload */
+    nrf24l01_rtos_frame rx_queue[NRF24L01_RTOS_RX_QUEUE_DEPTH]; /**< Received payloads, ring */
+    uint8_t rx_head;                                          /**< Oldest payload */
+    uint8_t rx_count;                                         /**< Payloads in the ring */
+    uint8_t tx_result;                                        /**< 0 on TX_DS, non-zero on MAX_RT */
+    nrf24l01_rtos_stats stats;                                /**< Counters */
+} nrf24l01_rtos;
+
+/**
+ * @brief Create the OS objects
+ * @param rtos Pointer to instance
+ * @param device Pointer to an initialized device
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_rtos_init(nrf24l01_rtos * rtos, nrf24l01_device * device);
+
+/**
+ * @brief Take the device for direct driver calls
+ * @param rtos Pointer to instance
+ */
+void nrf24l01_rtos_lock(nrf24l01_rtos * rtos);
+
+/**
+ * @brief Release the device taken with nrf24l01_rtos_lock()
+ * @param rtos Pointer to instance
+ */
+void nrf24l01_rtos_unlock(nrf24l01_rtos * rtos);
+
+/**
+ * @brief IRQ top half: wake the worker, no SPI
+ * @param rtos Pointer to instance
+ */
+void nrf24l01_rtos_irq_from_isr(nrf24l01_rtos * rtos);
+
+/**
+ * @brief Worker bottom half: wait for the IRQ and service it
+ * @param rtos Pointer to instance
+ * @param timeout_ms Longest wait; the radio is checked on timeout too, so a missed edge is recovered
+ * @return STATUS register as read at the start, or -1 on error
+ *
+ * Call in a loop from a dedicated task.
+ */
+uint8_t nrf24l01_rtos_worker(nrf24l01_rtos * rtos, uint32_t timeout_ms);
+
+/**
+ * @brief Send one payload and wait for the acknowledgment
+ * @param rtos Pointer to instance
+ * @param data Pointer to payload data
+ * @param length Payload length (1-32)
+ * @param timeout_ms Longest wait for TX_DS or MAX_RT
+ * @return 0 when acknowledged, non-zero on MAX_RT, timeout or error
+ *
+ * Device must be PTX. Concurrent senders queue on a mutex; the payload
+ * is flushed when it was not acknowledged.
+ */
+uint8_t nrf24l01_rtos_send(nrf24l01_rtos * rtos, const uint8_t * data, uint8_t length, uint32_t timeout_ms);
+
+/**
+ * @brief Wait for a received payload
+ * @param rtos Pointer to instance
+ * @param data Buffer of 32 bytes
+ * @param length Receives the payload length
+ * @param pipe Receives the pipe number, may be NULL
+ * @param timeout_ms Longest wait
+ * @return 0 when a payload was returned, non-zero on timeout or error
+ */
+uint8_t nrf24l01_rtos_receive(nrf24l01_rtos * rtos, uint8_t * data, uint8_t * length, uint8_t * pipe,
+                              uint32_t timeout_ms);
+
+/** @} */ // End of NRF24L01_RTOS group
+
+#endif //NRF24L01_DRIVER_NRF24L01_RTOS_H
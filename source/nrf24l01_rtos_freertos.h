@@ -0,0 +1,63 @@
+/**
+ * @file nrf24l01_rtos_freertos.h
+ * @brief FreeRTOS binding of the RTOS layer
+ *
+ * Mutexes (with priority inheritance) and counting semaphores created from
+ * static storage inside nrf24l01_rtos, so nothing comes from the FreeRTOS
+ * heap. Needs configSUPPORT_STATIC_ALLOCATION and configUSE_MUTEXES and
+ * configUSE_COUNTING_SEMAPHORES set to 1. The IRQ top half must run at a
+ * priority at or below configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_RTOS_FREERTOS_H
+#define NRF24L01_DRIVER_NRF24L01_RTOS_FREERTOS_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+typedef struct {
+    SemaphoreHandle_t handle;              /**< Mutex handle */
+    StaticSemaphore_t storage;             /**< Mutex control block */
+} nrf24l01_rtos_mutex;
+
+typedef struct {
+    SemaphoreHandle_t handle;              /**< Semaphore handle */
+    StaticSemaphore_t storage;             /**< Semaphore control block */
+} nrf24l01_rtos_semaphore;
+
+static inline uint8_t nrf24l01_rtos_mutex_init(nrf24l01_rtos_mutex * mutex){
+  mutex->handle = xSemaphoreCreateMutexStatic(&mutex->storage);
+  return mutex->handle == NULL;
+}
+
+static inline void nrf24l01_rtos_mutex_lock(nrf24l01_rtos_mutex * mutex){
+  xSemaphoreTake(mutex->handle, portMAX_DELAY);
+}
+
+static inline void nrf24l01_rtos_mutex_unlock(nrf24l01_rtos_mutex * mutex){
+  xSemaphoreGive(mutex->handle);
+}
+
+static inline uint8_t nrf24l01_rtos_semaphore_init(nrf24l01_rtos_semaphore * semaphore){
+  semaphore->handle = xSemaphoreCreateCountingStatic(0xFF, 0, &semaphore->storage);
+  return semaphore->handle == NULL;
+}
+
+static inline void nrf24l01_rtos_semaphore_give(nrf24l01_rtos_semaphore * semaphore){
+  xSemaphoreGive(semaphore->handle);
+}
+
+static inline void nrf24l01_rtos_semaphore_give_from_isr(nrf24l01_rtos_semaphore * semaphore){
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(semaphore->handle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// 0 when taken, non-zero on timeout
+static inline uint8_t nrf24l01_rtos_semaphore_take(nrf24l01_rtos_semaphore * semaphore, uint32_t timeout_ms){
+  TickType_t ticks = timeout_ms == NRF24L01_RTOS_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  return xSemaphoreTake(semaphore->handle, ticks) != pdTRUE;
+}
+
+#endif //NRF24L01_DRIVER_NRF24L01_RTOS_FREERTOS_H
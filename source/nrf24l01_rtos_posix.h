@@ -0,0 +1,69 @@
+/**
+ * @file nrf24l01_rtos_posix.h
+ * @brief POSIX threads binding of the RTOS layer
+ *
+ * pthread mutexes and POSIX semaphores, for running the RTOS layer on
+ * Linux against the host port: one thread plays the IRQ (signal handler
+ * or air simulator) and calls nrf24l01_rtos_irq_from_isr(), sem_post() is
+ * async-signal-safe. Needs -pthread and, under -std=c11, a POSIX feature
+ * level (-D_POSIX_C_SOURCE=200809L) for sem_timedwait(); the timed wait
+ * uses CLOCK_REALTIME.
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_RTOS_POSIX_H
+#define NRF24L01_DRIVER_NRF24L01_RTOS_POSIX_H
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef pthread_mutex_t nrf24l01_rtos_mutex;
+typedef sem_t nrf24l01_rtos_semaphore;
+
+static inline uint8_t nrf24l01_rtos_mutex_init(nrf24l01_rtos_mutex * mutex){
+  return pthread_mutex_init(mutex, NULL) != 0;
+}
+
+static inline void nrf24l01_rtos_mutex_lock(nrf24l01_rtos_mutex * mutex){
+  pthread_mutex_lock(mutex);
+}
+
+static inline void nrf24l01_rtos_mutex_unlock(nrf24l01_rtos_mutex * mutex){
+  pthread_mutex_unlock(mutex);
+}
+
+static inline uint8_t nrf24l01_rtos_semaphore_init(nrf24l01_rtos_semaphore * semaphore){
+  return sem_init(semaphore, 0, 0) != 0;
+}
+
+static inline void nrf24l01_rtos_semaphore_give(nrf24l01_rtos_semaphore * semaphore){
+  sem_post(semaphore);
+}
+
+static inline void nrf24l01_rtos_semaphore_give_from_isr(nrf24l01_rtos_semaphore * semaphore){
+  sem_post(semaphore);
+}
+
+// 0 when taken, non-zero on timeout
+static inline uint8_t nrf24l01_rtos_semaphore_take(nrf24l01_rtos_semaphore * semaphore, uint32_t timeout_ms){
+  int result;
+  if (timeout_ms == NRF24L01_RTOS_FOREVER){
+    while ((result = sem_wait(semaphore)) != 0 && errno == EINTR);
+    return result != 0;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout_ms / 1000;
+  deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L){
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+  while ((result = sem_timedwait(semaphore, &deadline)) != 0 && errno == EINTR);
+  return result != 0;
+}
+
+#endif //NRF24L01_DRIVER_NRF24L01_RTOS_POSIX_H
@@ -0,0 +1,201 @@
+#include "nrf24l01_scheduler.h"
+
+static uint8_t nrf24l01_scheduler_expired(uint32_t deadline, uint32_t now){
+  // wrap-safe "now is past deadline"
+  return (int32_t)(now - deadline) > 0;
+}
+
+// returns 1 if packet a must be sent before packet b
+static uint8_t nrf24l01_scheduler_before(nrf24l01_scheduler_packet * a, nrf24l01_scheduler_packet * b){
+  if (a->priority != b->priority) return a->priority < b->priority;
+  return (int32_t)(a->deadline - b->deadline) < 0;
+}
+
+static int8_t nrf24l01_scheduler_free_slot(nrf24l01_scheduler * scheduler){
+  for (uint8_t i = 0; i < NRF24L01_SCHEDULER_QUEUE_DEPTH; i++){
+    if (scheduler->packet[i].state == nrf24l01_scheduler_slot_free) return i;
+  }
+  return -1;
+}
+
+// queued packet that is served last: lowest priority, latest deadline
+static int8_t nrf24l01_scheduler_victim(nrf24l01_scheduler * scheduler){
+  int8_t victim = -1;
+  for (uint8_t i = 0; i < NRF24L01_SCHEDULER_QUEUE_DEPTH; i++){
+    if (scheduler->packet[i].state != nrf24l01_scheduler_slot_queued) continue;
+    if (victim < 0 || nrf24l01_scheduler_before(&scheduler->packet[victim], &scheduler->packet[i]))
+      victim = i;
+  }
+  return victim;
+}
+
+static int8_t nrf24l01_scheduler_next(nrf24l01_scheduler * scheduler){
+  int8_t next = -1;
+  for (uint8_t i = 0; i < NRF24L01_SCHEDULER_QUEUE_DEPTH; i++){
+    if (scheduler->packet[i].state != nrf24l01_scheduler_slot_queued) continue;
+    if (next < 0 || nrf24l01_scheduler_before(&scheduler->packet[i], &scheduler->packet[next]))
+      next = i;
+  }
+  return next;
+}
+
+// STATUS is written with CE low, the transmitter keeps going afterwards
+static void nrf24l01_scheduler_clear(nrf24l01_scheduler * scheduler, uint8_t flags){
+  uint8_t chip_enabled = nrf24l01_port_ce_read(scheduler->device);
+  nrf24l01_clear_interrupt_flags(scheduler->device, flags);
+  if (chip_enabled) nrf24l01_chip_enable(scheduler->device);
+}
+
+static uint8_t nrf24l01_scheduler_tx_empty(nrf24l01_scheduler * scheduler){
+  uint8_t fifo_status_register = 0;
+  nrf24l01_read_register(scheduler->device, FIFO_STATUS, &fifo_status_register, 1);
+  return (fifo_status_register & TX_EMPTY) != 0;
+}
+
+// frames that left the TX FIFO without a nrf24l01_scheduler_tx_done() call,
+// returns STATUS. TX_DS set means at least one frame left since the last
+// call; with at most two frames in flight the fill level tells the rest
+static uint8_t nrf24l01_scheduler_account(nrf24l01_scheduler * scheduler){
+  uint8_t sent = 0;
+  uint8_t tx_empty = nrf24l01_scheduler_tx_empty(scheduler);
+  // read after the fill level, TX_DS covers a frame the level missed
+  uint8_t status_register = nrf24l01_nop(scheduler->device);
+
+  if (tx_empty) sent = scheduler->in_flight_count;
+  else if (scheduler->in_flight_count > 1 && (status_register & TX_DS)) sent = 1;
+
+  // every TX_DS up to here is accounted, the application must not report it again
+  if (status_register & TX_DS){
+    nrf24l01_scheduler_clear(scheduler, TX_DS);
+    // the last frame may have left after the reads, its TX_DS cleared with the others
+    if (sent < scheduler->in_flight_count && nrf24l01_scheduler_tx_empty(scheduler)){
+      sent = scheduler->in_flight_count;
+      nrf24l01_scheduler_clear(scheduler, TX_DS);
+    }
+  }
+
+  while (sent-- > 0)
+    nrf24l01_scheduler_tx_done(scheduler);
+  return status_register;
+}
+
+// flushed frames go back to the queue, where their deadlines apply again
+static void nrf24l01_scheduler_requeue(nrf24l01_scheduler * scheduler){
+  uint8_t status_register = nrf24l01_flush_tx(scheduler->device);
+  // the head frame left between the last check and the flush
+  if (status_register & TX_DS){
+    nrf24l01_scheduler_tx_done(scheduler);
+    nrf24l01_scheduler_clear(scheduler, TX_DS);
+  }
+  for (uint8_t i = 0; i < scheduler->in_flight_count; i++)
+    scheduler->packet[scheduler->in_flight[i]].state = nrf24l01_scheduler_slot_queued;
+  scheduler->in_flight_count = 0;
+}
+
+static void nrf24l01_scheduler_preempt(nrf24l01_scheduler * scheduler, uint8_t priority){
+  uint8_t preempt = 0;
+  // frames already acknowledged must not be sent twice
+  nrf24l01_scheduler_account(scheduler);
+  for (uint8_t i = 0; i < scheduler->in_flight_count; i++){
+    if (scheduler->packet[scheduler->in_flight[i]].priority > priority) preempt = 1;
+  }
+  if (!preempt) return;
+
+  // every flushed frame goes back to the queue, including higher priority ones
+  for (uint8_t i = 0; i < scheduler->in_flight_count; i++)
+    scheduler->stats[scheduler->packet[scheduler->in_flight[i]].priority].preempted++;
+  nrf24l01_scheduler_requeue(scheduler);
+}
+
+uint8_t nrf24l01_scheduler_init(nrf24l01_scheduler * scheduler, nrf24l01_device * device){
+  if (scheduler == NULL || device == NULL) return -1;
+  memset(scheduler, 0, sizeof(nrf24l01_scheduler));
+  scheduler->device = device;
+  return 0;
+}
+
+uint8_t nrf24l01_scheduler_submit(nrf24l01_scheduler * scheduler, nrf24l01_scheduler_class priority,
+                                  uint8_t * data, uint8_t length, uint32_t timeout){
+  if (scheduler == NULL || data == NULL) return -1;
+  if (priority >= nrf24l01_scheduler_class_count) return -1; // invalid class
+  if (length < 1 || length > 32) return -1; // invalid payload length
+
+  int8_t slot = nrf24l01_scheduler_free_slot(scheduler);
+  if (slot < 0){
+    // queue full: evict a packet that would be served after this one
+    int8_t victim = nrf24l01_scheduler_victim(scheduler);
+    if (victim < 0 || scheduler->packet[victim].priority <= priority){
+      scheduler->stats[priority].rejected++;
+      return -1;
+    }
+    scheduler->stats[scheduler->packet[victim].priority].rejected++;
+    slot = victim;
+  }
+
+  nrf24l01_scheduler_packet * packet = &scheduler->packet[slot];
+  memcpy(packet->payload, data, length);
+  packet->length = length;
+  packet->priority = priority;
+  packet->deadline = nrf24l01_port_millis(scheduler->device) + timeout;
+  packet->state = nrf24l01_scheduler_slot_queued;
+  scheduler->stats[priority].submitted++;
+
+  if (priority == nrf24l01_scheduler_class_control)
+    nrf24l01_scheduler_preempt(scheduler, priority);
+
+  return 0;
+}
+
+uint8_t nrf24l01_scheduler_service(nrf24l01_scheduler * scheduler){
+  if (scheduler == NULL) return 0;
+  uint32_t now = nrf24l01_port_millis(scheduler->device);
+  uint8_t loaded = 0;
+
+  uint8_t status_register = nrf24l01_scheduler_account(scheduler);
+
+  if (status_register & MAX_RT){
+    // the head frame ran out of retransmissions and the chip stopped
+    if (scheduler->in_flight_count > 0)
+      scheduler->stats[scheduler->packet[scheduler->in_flight[0]].priority].max_rt++;
+    nrf24l01_scheduler_requeue(scheduler);
+    nrf24l01_scheduler_clear(scheduler, MAX_RT);
+  }
+
+  // drop late packets
+  for (uint8_t i = 0; i < NRF24L01_SCHEDULER_QUEUE_DEPTH; i++){
+    nrf24l01_scheduler_packet * packet = &scheduler->packet[i];
+    if (packet->state != nrf24l01_scheduler_slot_queued) continue;
+    if (nrf24l01_scheduler_expired(packet->deadline, now)){
+      packet->state = nrf24l01_scheduler_slot_free;
+      scheduler->stats[packet->priority].deadline_missed++;
+    }
+  }
+
+  // refill the hardware FIFO in EDF order
+  while (scheduler->in_flight_count < NRF24L01_SCHEDULER_IN_FLIGHT){
+    int8_t next = nrf24l01_scheduler_next(scheduler);
+    if (next < 0) break;
+
+    nrf24l01_scheduler_packet * packet = &scheduler->packet[next];
+    nrf24l01_write_tx_payload(scheduler->device, packet->payload, packet->length);
+    packet->state = nrf24l01_scheduler_slot_in_flight;
+    scheduler->in_flight[scheduler->in_flight_count++] = next;
+    loaded++;
+  }
+
+  return loaded;
+}
+
+uint8_t nrf24l01_scheduler_tx_done(nrf24l01_scheduler * scheduler){
+  if (scheduler == NULL) return -1;
+  if (scheduler->in_flight_count == 0) return -1; // nothing in flight
+
+  nrf24l01_scheduler_packet * packet = &scheduler->packet[scheduler->in_flight[0]];
+  scheduler->stats[packet->priority].sent++;
+  packet->state = nrf24l01_scheduler_slot_free;
+
+  scheduler->in_flight_count--;
+  memmove(scheduler->in_flight, scheduler->in_flight + 1, scheduler->in_flight_count);
+
+  return 0;
+}
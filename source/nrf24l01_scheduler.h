@@ -0,0 +1,168 @@
+/**
+ * @file nrf24l01_scheduler.h
+ * @brief Deadline-aware priority TX scheduler for the nRF24L01 driver
+ *
+ * Sits in front of nrf24l01_write_tx_payload() and decides which packet is
+ * loaded into the hardware TX FIFO next. Packets are grouped in
+ * priority classes; inside a class the packet with the earliest deadline is
+ * sent first (EDF). Packets whose deadline has passed are dropped instead of
+ * being sent late.
+ *
+ * When a control packet is submitted while lower priority frames are sitting
+ * in the hardware FIFO, the FIFO is flushed with FLUSH_TX and the frames that
+ * were not yet acknowledged are requeued. The latency of control traffic is
+ * therefore bounded by one packet on air, no matter how much bulk traffic is
+ * queued.
+ *
+ * nrf24l01_scheduler_service() reads STATUS and accounts TX_DS itself,
+ * clearing the flag. Frames that reached the receiver are worked out from
+ * TX_DS and the FIFO fill level before every flush, so they are not sent
+ * twice. FIFO_STATUS only tells empty and full apart, so this is exact
+ * with at most NRF24L01_SCHEDULER_IN_FLIGHT (two) frames loaded, one left
+ * or two: TX_DS, cleared at every check, separates those. A frame
+ * acknowledged between that check and FLUSH_TX shows in the STATUS the
+ * flush returns; two frames cannot leave in that window, one packet time
+ * apart. After MAX_RT the TX FIFO is flushed and its frames requeued:
+ * they are retried until their deadline passes. The flags are written
+ * with CE low and CE is restored afterwards, so it can be held high.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_scheduler scheduler;
+ * nrf24l01_scheduler_init(&scheduler, &nrf);
+ *
+ * // emergency stop must leave within 5 ms, log chunk within 500 ms
+ * nrf24l01_scheduler_submit(&scheduler, nrf24l01_scheduler_class_control, stop, sizeof(stop), 5);
+ * nrf24l01_scheduler_submit(&scheduler, nrf24l01_scheduler_class_bulk, chunk, 32, 500);
+ *
+ * // main loop
+ * if (nrf24l01_scheduler_service(&scheduler) > 0)
+ *     nrf24l01_transmit(&nrf);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_SCHEDULER_H
+#define NRF24L01_DRIVER_NRF24L01_SCHEDULER_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_SCHEDULER TX Scheduler
+ * @brief Priority classes with per-packet deadlines in front of the TX FIFO
+ * @{
+ */
+
+#ifndef NRF24L01_SCHEDULER_QUEUE_DEPTH
+/** @brief Number of packets the scheduler can hold (queued and in flight) */
+#define NRF24L01_SCHEDULER_QUEUE_DEPTH   16
+#endif
+
+/** @brief Depth of the nRF24L01 hardware TX FIFO */
+#define NRF24L01_TX_FIFO_DEPTH           3
+
+/** @brief Frames the scheduler keeps in the TX FIFO, one less than its depth so sent frames can be counted */
+#define NRF24L01_SCHEDULER_IN_FLIGHT     (NRF24L01_TX_FIFO_DEPTH - 1)
+
+/**
+ * @brief Priority classes, lower value is served first
+ */
+typedef enum {
+    nrf24l01_scheduler_class_control = 0,  /**< Control traffic, preempts everything else */
+    nrf24l01_scheduler_class_normal,       /**< Regular application traffic */
+    nrf24l01_scheduler_class_bulk,         /**< Bulk transfers (logs, firmware chunks) */
+    nrf24l01_scheduler_class_count         /**< Number of priority classes */
+} nrf24l01_scheduler_class;
+
+/**
+ * @brief State of a scheduler slot
+ */
+typedef enum {
+    nrf24l01_scheduler_slot_free = 0,      /**< Slot is unused */
+    nrf24l01_scheduler_slot_queued,        /**< Packet waits in software */
+    nrf24l01_scheduler_slot_in_flight,     /**< Packet has been written to the TX FIFO */
+} nrf24l01_scheduler_slot_state;
+
+/**
+ * @brief One packet held by the scheduler
+ */
+typedef struct {
+    uint8_t payload[32];                   /**< Payload bytes */
+    uint8_t length;                        /**< Payload length (1-32) */
+    uint8_t state;                         /**< One of nrf24l01_scheduler_slot_state */
+    uint8_t priority;                      /**< One of nrf24l01_scheduler_class */
+    uint32_t deadline;                     /**< Absolute deadline in port ticks (ms) */
+} nrf24l01_scheduler_packet;
+
+/**
+ * @brief Per-class statistics
+ */
+typedef struct {
+    uint32_t submitted;                    /**< Packets accepted by nrf24l01_scheduler_submit() */
+    uint32_t sent;                         /**< Packets acknowledged by the hardware (TX_DS) */
+    uint32_t deadline_missed;              /**< Packets dropped because their deadline passed */
+    uint32_t preempted;                    /**< Frames flushed from the TX FIFO and requeued */
+    uint32_t rejected;                     /**< Packets refused or evicted because the queue was full */
+    uint32_t max_rt;                       /**< Frames that hit MAX_RT and were requeued */
+} nrf24l01_scheduler_stats;
+
+/**
+ * @brief Scheduler instance, one per device
+ */
+typedef struct {
+    nrf24l01_device * device;                                   /**< Radio served by this scheduler */
+    nrf24l01_scheduler_packet packet[NRF24L01_SCHEDULER_QUEUE_DEPTH]; /**< Packet slots */
+    uint8_t in_flight[NRF24L01_SCHEDULER_IN_FLIGHT];            /**< Slots loaded in the TX FIFO, oldest first */
+    uint8_t in_flight_count;                                    /**< Number of valid entries in in_flight */
+    nrf24l01_scheduler_stats stats[nrf24l01_scheduler_class_count]; /**< Statistics per class */
+} nrf24l01_scheduler;
+
+/**
+ * @brief Initialize a scheduler
+ * @param scheduler Pointer to scheduler instance
+ * @param device Pointer to an initialized PTX device
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_scheduler_init(nrf24l01_scheduler * scheduler, nrf24l01_device * device);
+
+/**
+ * @brief Queue a packet for transmission
+ * @param scheduler Pointer to scheduler instance
+ * @param priority Priority class of the packet
+ * @param data Pointer to payload data
+ * @param length Payload length (1-32)
+ * @param timeout Time in ms from now after which the packet is dropped
+ * @return 0 on success, non-zero on error
+ *
+ * When the queue is full, the queued packet with the lowest priority and the
+ * latest deadline is evicted if it has a lower priority than the new one.
+ * Submitting a control packet flushes lower priority frames from the TX FIFO
+ * and requeues them.
+ */
+uint8_t nrf24l01_scheduler_submit(nrf24l01_scheduler * scheduler, nrf24l01_scheduler_class priority,
+                                  uint8_t * data, uint8_t length, uint32_t timeout);
+
+/**
+ * @brief Drop expired packets and refill the TX FIFO
+ * @param scheduler Pointer to scheduler instance
+ * @return Number of packets written to the TX FIFO
+ *
+ * Call from the main loop. Accounts TX_DS and recovers from MAX_RT
+ * (flush, flag cleared, frames requeued). Transmission itself is still
+ * started by the application (nrf24l01_transmit() or CE held high).
+ */
+uint8_t nrf24l01_scheduler_service(nrf24l01_scheduler * scheduler);
+
+/**
+ * @brief Report that the oldest in-flight packet was sent
+ * @param scheduler Pointer to scheduler instance
+ * @return 0 on success, non-zero if nothing was in flight
+ *
+ * For interrupt handlers: call once for every TX_DS event and clear the
+ * flag in the same handler. TX_DS still set when
+ * nrf24l01_scheduler_service() runs is accounted there.
+ */
+uint8_t nrf24l01_scheduler_tx_done(nrf24l01_scheduler * scheduler);
+
+/** @} */ // End of NRF24L01_SCHEDULER group
+
+#endif //NRF24L01_DRIVER_NRF24L01_SCHEDULER_H
@@ -0,0 +1,209 @@
+/**
+ * @file nrf24l01_static_config.h
+ * @brief Compile-time checked configuration stored as a constant register image
+ *
+ * When the radio configuration is known at build time there is no need to
+ * run nrf24l01_get_default_config() and nrf24l01_init() at boot (switches
+ * over the enums, read-modify-write cycles and range checks). The macros below encode
+ * each register from plain numbers, reject invalid values at compile time
+ * and produce a const nrf24l01_register_image that the linker places in
+ * flash. nrf24l01_init_from_image() streams it to the chip.
+ *
+ * Header only, nothing to compile besides nrf24l01.c.
+ *
+ * NRF24L01_SC_REGISTERS() takes every setting once and derives all
+ * registers but the addresses from it, so the checks across registers
+ * hold for the image as written. Invalid values and combinations are
+ * build errors, for example:
+ * - ACK payload without dynamic payload length, or an ARD too short for
+ *   it at the chosen data rate
+ * - dynamic payload length on a pipe without auto-acknowledgment
+ * - auto-acknowledgment with the CRC off (the chip would force it on)
+ * - a PTX with retransmits or ACK payloads but no auto-acknowledgment on
+ *   pipe 0, or with pipe 0 not enabled to receive the ACK
+ * - an enabled pipe with neither a payload width nor DPL
+ * - channel above 125, address width outside 3-5, unknown output power
+ *
+ * The encoders of single registers remain for images assembled by hand;
+ * they only check their own register.
+ *
+ * The check is an array with negative size, so the compiler points at the
+ * offending line with a message like "size of unnamed array is negative".
+ *
+ * @par Example Usage:
+ * @code
+ * static const nrf24l01_register_image radio_image = {
+ *     NRF24L01_SC_REGISTERS(2, 1, 0,       // 2-byte CRC, power up, PTX
+ *                           5, 2, 0, 1,    // 5-byte addresses, 2 Mbps, 0 dBm, LNA gain
+ *                           76, 500, 5,    // channel 76, ARD 500 µs, 5 retries
+ *                           0x03, 0x03,    // pipes 0 and 1 enabled and auto-acknowledged
+ *                           0x03, 0,       // DPL on both, so no static payload width
+ *                           32, 0),        // ACK payloads up to 32 bytes, no dynamic ACK
+ *     .rx_addr_p0 = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+ *     .rx_addr_p1 = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2},
+ *     .rx_addr_p2_p5 = {0xC3, 0xC4, 0xC5, 0xC6},
+ *     .tx_addr    = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7},
+ * };
+ *
+ * nrf24l01_init_from_image(&nrf, &radio_image);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_STATIC_CONFIG_H
+#define NRF24L01_DRIVER_NRF24L01_STATIC_CONFIG_H
+
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_STATIC_CONFIG Compile-Time Configuration
+ * @brief Register encoders that fail the build on invalid settings
+ * @{
+ */
+
+/** @brief Evaluates to 0, or breaks the build when cond is false */
+#define NRF24L01_SC_CHECK(cond)     (0 * sizeof(char[(cond) ? 1 : -1]))
+
+/**
+ * @brief CONFIG register
+ * @param crc_bytes CRC length in bytes (0, 1 or 2)
+ * @param power_up 1 to set PWR_UP
+ * @param primary_rx 1 for PRX, 0 for PTX
+ */
+#define NRF24L01_SC_CONFIG(crc_bytes, power_up, primary_rx) \
+    ((uint8_t)(NRF24L01_SC_CHECK((crc_bytes) <= 2 && (power_up) <= 1 && (primary_rx) <= 1) \
+    + ((crc_bytes) ? EN_CRC : 0) + ((crc_bytes) == 2 ? CRCO : 0) \
+    + ((power_up) ? PWR_UP : 0) + ((primary_rx) ? PRIM_RX : 0)))
+
+/**
+ * @brief SETUP_AW register
+ * @param width Address width in bytes (3-5)
+ */
+#define NRF24L01_SC_SETUP_AW(width) \
+    ((uint8_t)(NRF24L01_SC_CHECK((width) >= 3 && (width) <= 5) + (width) - 2))
+
+/**
+ * @brief Shortest ARD in µs for an ACK payload size (nRF24L01+ datasheet, 7.4.2)
+ * @param rate_mbps Air data rate in Mbps (1 or 2)
+ * @param ack_payload Largest ACK payload in bytes (0 if unused)
+ */
+#define NRF24L01_SC_MIN_ARD(rate_mbps, ack_payload) \
+    (((rate_mbps) == 1 && (ack_payload) > 5) || ((rate_mbps) == 2 && (ack_payload) > 15) ? 500 : 250)
+
+/**
+ * @brief SETUP_RETR register
+ * @param ard_us Auto retransmit delay in µs (250-4000, multiple of 250)
+ * @param arc Auto retransmit count (0-15)
+ * @param rate_mbps Air data rate in Mbps (1 or 2)
+ * @param ack_payload Largest ACK payload in bytes (0 if unused)
+ */
+#define NRF24L01_SC_SETUP_RETR(ard_us, arc, rate_mbps, ack_payload) \
+    ((uint8_t)(NRF24L01_SC_CHECK((ard_us) >= 250 && (ard_us) <= 4000 && (ard_us) % 250 == 0) \
+    + NRF24L01_SC_CHECK((arc) <= 15) \
+    + NRF24L01_SC_CHECK((ard_us) >= NRF24L01_SC_MIN_ARD(rate_mbps, ack_payload)) \
+    + (NRF24L01_FIELD_PREP(ARD, (ard_us) / 250 - 1) | NRF24L01_FIELD_PREP(ARC, arc))))
+
+/**
+ * @brief RF_CH register
+ * @param channel RF channel (0-125)
+ */
+#define NRF24L01_SC_RF_CH(channel) \
+    ((uint8_t)(NRF24L01_SC_CHECK((channel) <= 125) + (channel)))
+
+/**
+ * @brief RF_SETUP register
+ * @param rate_mbps Air data rate in Mbps (1 or 2)
+ * @param power_dbm Output power in dBm (-18, -12, -6 or 0)
+ * @param lna_gain 1 to set LNA_HCURR
+ */
+#define NRF24L01_SC_RF_SETUP(rate_mbps, power_dbm, lna_gain) \
+    ((uint8_t)(NRF24L01_SC_CHECK((rate_mbps) == 1 || (rate_mbps) == 2) \
+    + NRF24L01_SC_CHECK((power_dbm) == -18 || (power_dbm) == -12 || (power_dbm) == -6 || (power_dbm) == 0) \
+    + NRF24L01_SC_CHECK((lna_gain) <= 1) \
+    + ((rate_mbps) == 2 ? RF_DR : 0) + NRF24L01_FIELD_PREP(RF_PWR, ((power_dbm) + 18) / 6) + ((lna_gain) ? LNA_HCURR : 0)))
+
+/**
+ * @brief FEATURE register
+ * @param dpl 1 to set EN_DPL
+ * @param ack_payload 1 to set EN_ACK_PAY, requires dpl
+ * @param dynamic_ack 1 to set EN_DYN_ACK
+ */
+#define NRF24L01_SC_FEATURE(dpl, ack_payload, dynamic_ack) \
+    ((uint8_t)(NRF24L01_SC_CHECK((dpl) <= 1 && (ack_payload) <= 1 && (dynamic_ack) <= 1) \
+    + NRF24L01_SC_CHECK(!(ack_payload) || (dpl)) \
+    + ((dpl) ? EN_DPL : 0) + ((ack_payload) ? EN_ACK_PAY : 0) + ((dynamic_ack) ? EN_DYN_ACK : 0)))
+
+/**
+ * @brief DYNPD register
+ * @param pipes Pipe bit mask with dynamic payload length
+ * @param en_aa Value of EN_AA, every DPL pipe needs auto-acknowledgment
+ * @param dpl Value passed as dpl to NRF24L01_SC_FEATURE()
+ */
+#define NRF24L01_SC_DYNPD(pipes, en_aa, dpl) \
+    ((uint8_t)(NRF24L01_SC_CHECK((pipes) <= 0x3F && ((pipes) & ~(en_aa)) == 0) \
+    + NRF24L01_SC_CHECK((pipes) == 0 || (dpl)) \
+    + (pipes)))
+
+/**
+ * @brief RX_PW_Px register of one pipe: payload_width when enabled without DPL, 0 otherwise
+ * @param pipe Pipe number (0-5)
+ * @param rx_pipes Value of EN_RXADDR
+ * @param dpl_pipes Value of DYNPD
+ * @param payload_width Static payload width in bytes (0-32)
+ */
+#define NRF24L01_SC_RX_PW(pipe, rx_pipes, dpl_pipes, payload_width) \
+    ((uint8_t)(((((rx_pipes) & ~(dpl_pipes)) >> (pipe)) & 1) ? (payload_width) : 0))
+
+/**
+ * @brief Initializers of every register of an image but the addresses, each setting given once
+ * @param crc_bytes CRC length in bytes (0, 1 or 2)
+ * @param power_up 1 to set PWR_UP
+ * @param primary_rx 1 for PRX, 0 for PTX
+ * @param width Address width in bytes (3-5)
+ * @param rate_mbps Air data rate in Mbps (1 or 2)
+ * @param power_dbm Output power in dBm (-18, -12, -6 or 0)
+ * @param lna_gain 1 to set LNA_HCURR
+ * @param channel RF channel (0-125)
+ * @param ard_us Auto retransmit delay in µs (250-4000, multiple of 250)
+ * @param arc Auto retransmit count (0-15)
+ * @param rx_pipes Pipe bit mask of enabled pipes (EN_RXADDR)
+ * @param aa_pipes Pipe bit mask with auto-acknowledgment (EN_AA)
+ * @param dpl_pipes Pipe bit mask with dynamic payload length (DYNPD), EN_DPL follows
+ * @param payload_width Payload width of the enabled pipes without DPL (1-32, 0 if there are none)
+ * @param ack_payload Largest ACK payload in bytes (0-32, 0 if unused), EN_ACK_PAY follows
+ * @param dynamic_ack 1 to set EN_DYN_ACK
+ *
+ * Expands to designated initializers; the addresses follow it in the
+ * same initializer.
+ */
+#define NRF24L01_SC_REGISTERS(crc_bytes, power_up, primary_rx, width, rate_mbps, power_dbm, lna_gain, channel, \
+                              ard_us, arc, rx_pipes, aa_pipes, dpl_pipes, payload_width, ack_payload, dynamic_ack) \
+    .config     = (uint8_t)(NRF24L01_SC_CHECK(!(aa_pipes) || (crc_bytes)) \
+                + NRF24L01_SC_CONFIG(crc_bytes, power_up, primary_rx)), \
+    .en_aa      = (uint8_t)(NRF24L01_SC_CHECK((aa_pipes) <= 0x3F) \
+                + NRF24L01_SC_CHECK((primary_rx) || !((arc) || (ack_payload)) || ((aa_pipes) & 1)) \
+                + (aa_pipes)), \
+    .en_rxaddr  = (uint8_t)(NRF24L01_SC_CHECK((rx_pipes) <= 0x3F) \
+                + NRF24L01_SC_CHECK((primary_rx) || !((aa_pipes) & 1) || ((rx_pipes) & 1)) \
+                + (rx_pipes)), \
+    .setup_aw   = NRF24L01_SC_SETUP_AW(width), \
+    .setup_retr = (uint8_t)(NRF24L01_SC_CHECK((ack_payload) <= 32) \
+                + NRF24L01_SC_SETUP_RETR(ard_us, arc, rate_mbps, ack_payload)), \
+    .rf_ch      = NRF24L01_SC_RF_CH(channel), \
+    .rf_setup   = NRF24L01_SC_RF_SETUP(rate_mbps, power_dbm, lna_gain), \
+    .rx_pw      = { \
+        (uint8_t)(NRF24L01_SC_CHECK((payload_width) <= 32) \
+        + NRF24L01_SC_CHECK(((rx_pipes) & ~(dpl_pipes)) == 0 || (payload_width) >= 1) \
+        + NRF24L01_SC_RX_PW(0, rx_pipes, dpl_pipes, payload_width)), \
+        NRF24L01_SC_RX_PW(1, rx_pipes, dpl_pipes, payload_width), \
+        NRF24L01_SC_RX_PW(2, rx_pipes, dpl_pipes, payload_width), \
+        NRF24L01_SC_RX_PW(3, rx_pipes, dpl_pipes, payload_width), \
+        NRF24L01_SC_RX_PW(4, rx_pipes, dpl_pipes, payload_width), \
+        NRF24L01_SC_RX_PW(5, rx_pipes, dpl_pipes, payload_width), \
+    }, \
+    .dynpd      = NRF24L01_SC_DYNPD(dpl_pipes, aa_pipes, (dpl_pipes) != 0), \
+    .feature    = (uint8_t)(NRF24L01_SC_CHECK((primary_rx) || !(ack_payload) || ((dpl_pipes) & 1)) \
+                + NRF24L01_SC_FEATURE((dpl_pipes) != 0, (ack_payload) != 0, dynamic_ack))
+
+/** @} */ // End of NRF24L01_STATIC_CONFIG group
+
+#endif //NRF24L01_DRIVER_NRF24L01_STATIC_CONFIG_H
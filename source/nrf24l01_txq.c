@@ -0,0 +1,67 @@
+#include "nrf24l01_txq.h"
+
+_Static_assert((NRF24L01_TXQ_DEPTH & (NRF24L01_TXQ_DEPTH - 1)) == 0, "NRF24L01_TXQ_DEPTH must be a power of two");
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "nrf24l01_txq needs lock-free atomics");
+
+uint8_t nrf24l01_txq_init(nrf24l01_txq * txq, nrf24l01_device * device){
+  if (txq == NULL || device == NULL) return -1;
+  memset(txq, 0, sizeof(nrf24l01_txq));
+  txq->device = device;
+  for (uint8_t i = 0; i < NRF24L01_TXQ_DEPTH; i++) atomic_init(&txq->slot[i].ready, 0);
+  atomic_init(&txq->count, 0);
+  atomic_init(&txq->tail, 0);
+  atomic_init(&txq->stats.rejected, 0);
+  return 0;
+}
+
+uint8_t nrf24l01_txq_enqueue(nrf24l01_txq * txq, const uint8_t * data, uint8_t length){
+  if (txq == NULL || data == NULL) return -1;
+  if (length < 1 || length > 32) return -1; // invalid payload length
+
+  // reserve room first: once count is below the depth the slot of our ticket is free
+  if (atomic_fetch_add_explicit(&txq->count, 1, memory_order_acquire) >= NRF24L01_TXQ_DEPTH){
+    atomic_fetch_sub_explicit(&txq->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&txq->stats.rejected, 1, memory_order_relaxed);
+    return -1;
+  }
+
+  // a reservation made before the slot was freed can still draw the ticket of
+  // that slot; the ticket then has to carry over what the reservation missed
+  uint32_t ticket = atomic_fetch_add_explicit(&txq->tail, 1, memory_order_acq_rel);
+  nrf24l01_txq_slot * slot = &txq->slot[ticket & (NRF24L01_TXQ_DEPTH - 1)];
+  memcpy(slot->data, data, length);
+  slot->length = length;
+  atomic_store_explicit(&slot->ready, 1, memory_order_release);
+  return 0;
+}
+
+uint8_t nrf24l01_txq_service(nrf24l01_txq * txq){
+  uint8_t written = 0;
+  if (txq == NULL) return 0;
+
+  uint32_t in_use = atomic_load_explicit(&txq->count, memory_order_relaxed);
+  if (in_use > NRF24L01_TXQ_DEPTH) in_use = NRF24L01_TXQ_DEPTH; // producers backing out
+  if (in_use > txq->stats.high_water) txq->stats.high_water = in_use;
+
+  uint8_t status_register = nrf24l01_nop(txq->device);
+  while (!(status_register & TX_FULL)){
+    nrf24l01_txq_slot * slot = &txq->slot[txq->head & (NRF24L01_TXQ_DEPTH - 1)];
+    if (!atomic_load_explicit(&slot->ready, memory_order_acquire)){
+      // empty, or its producer has not finished writing it
+      if (txq->head != atomic_load_explicit(&txq->tail, memory_order_relaxed)) txq->stats.stalls++;
+      break;
+    }
+
+    nrf24l01_write_tx_payload(txq->device, slot->data, slot->length);
+    atomic_store_explicit(&slot->ready, 0, memory_order_relaxed);
+    txq->head++;
+    // hands the slot back to the producers, after its data was read
+    atomic_fetch_sub_explicit(&txq->count, 1, memory_order_release);
+    txq->stats.sent++;
+    written++;
+
+    // STATUS of the write is from before it, ask again whether the FIFO filled up
+    status_register = nrf24l01_nop(txq->device);
+  }
+  return written;
+}
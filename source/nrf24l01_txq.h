@@ -0,0 +1,110 @@
+/**
+ * @file nrf24l01_txq.h
+ * @brief Lock-free multi-producer TX queue in front of one radio
+ *
+ * Any number of tasks and interrupt handlers enqueue payloads; one
+ * consumer, usually the main loop or the radio task, moves them into the
+ * hardware TX FIFO with nrf24l01_write_tx_payload(). Producers never take
+ * a lock and never wait for each other: an enqueue is two atomic
+ * increments and a copy into a preallocated slot, so a low priority task
+ * preempted in the middle of an enqueue does not block a higher priority
+ * producer (no priority inversion). Its own slot is simply not handed to
+ * the radio until it is complete.
+ *
+ * The queue holds NRF24L01_TXQ_DEPTH slots. An enqueue fails when they are
+ * all taken; during concurrent enqueues it may also fail with one slot
+ * left, while another producer is backing out of a full queue.
+ *
+ * Built on C11 atomics, which must be lock-free for int: Cortex-M3 and
+ * up (LDREX/STREX), not Cortex-M0.
+ *
+ * @par Example Usage:
+ * @code
+ * static nrf24l01_txq txq;
+ * nrf24l01_txq_init(&txq, &nrf);
+ *
+ * // any task or ISR
+ * if (nrf24l01_txq_enqueue(&txq, sample, sizeof(sample)) != 0) overruns++;
+ *
+ * // radio task, PTX with CE high
+ * nrf24l01_txq_service(&txq);
+ * @endcode
+ */
+
+#ifndef NRF24L01_DRIVER_NRF24L01_TXQ_H
+#define NRF24L01_DRIVER_NRF24L01_TXQ_H
+
+#include <stdatomic.h>
+#include "nrf24l01.h"
+
+/**
+ * @defgroup NRF24L01_TXQ Multi-Producer TX Queue
+ * @brief Wait-free enqueue from any context, single consumer into the TX FIFO
+ * @{
+ */
+
+#ifndef NRF24L01_TXQ_DEPTH
+/** @brief Slots in the queue, power of two */
+#define NRF24L01_TXQ_DEPTH   16
+#endif
+
+/**
+ * @brief One preallocated packet slot
+ */
+typedef struct {
+    uint8_t data[32];                      /**< Payload */
+    uint8_t length;                        /**< Payload length */
+    atomic_uint_fast8_t ready;             /**< Set by the producer once data and length are written */
+} nrf24l01_txq_slot;
+
+/**
+ * @brief Counters
+ */
+typedef struct {
+    atomic_uint_fast32_t rejected;         /**< Enqueues refused because the queue was full */
+    uint32_t sent;                         /**< Payloads written to the TX FIFO */
+    uint32_t stalls;                       /**< Services stopped at a slot still being written */
+    uint32_t high_water;                   /**< Most slots in use seen by the consumer */
+} nrf24l01_txq_stats;
+
+/**
+ * @brief Queue instance, one per radio
+ */
+typedef struct {
+    nrf24l01_device * device;                            /**< Radio fed by the consumer */
+    nrf24l01_txq_slot slot[NRF24L01_TXQ_DEPTH];         /**< Packet slots */
+    atomic_uint_fast32_t count;                          /**< Slots reserved or in use */
+    atomic_uint_fast32_t tail;                           /**< Ticket of the next producer */
+    uint32_t head;                                       /**< Ticket of the next slot to send, consumer only */
+    nrf24l01_txq_stats stats;                            /**< Counters */
+} nrf24l01_txq;
+
+/**
+ * @brief Initialize an empty queue
+ * @param txq Pointer to queue instance
+ * @param device Pointer to an initialized PTX device
+ * @return 0 on success, non-zero on error
+ */
+uint8_t nrf24l01_txq_init(nrf24l01_txq * txq, nrf24l01_device * device);
+
+/**
+ * @brief Queue one payload, from any task or interrupt handler
+ * @param txq Pointer to queue instance
+ * @param data Pointer to payload data
+ * @param length Payload length (1-32)
+ * @return 0 on success, non-zero when the queue is full or on error
+ */
+uint8_t nrf24l01_txq_enqueue(nrf24l01_txq * txq, const uint8_t * data, uint8_t length);
+
+/**
+ * @brief Move queued payloads into the TX FIFO until it is full
+ * @param txq Pointer to queue instance
+ * @return Number of payloads written
+ *
+ * Single consumer: call from one context only.
+ */
+uint8_t nrf24l01_txq_service(nrf24l01_txq * txq);
+
+/** @} */ // End of NRF24L01_TXQ group
+
+#endif //NRF24L01_DRIVER_NRF24L01_TXQ_H